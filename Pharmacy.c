@@ -2,15 +2,63 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
+#include <stddef.h>
+#include <ctype.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sched.h>
+#include <errno.h>
+#include <limits.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 #define BATCH_SIZE 50
 #define NAME_SIZE 100
 #define CONTACT_SIZE 12
 
+// Fixed-size slot allocator: slots are carved from geometrically growing
+// slabs and recycled through an intrusive free list.
+typedef struct MemorySlab {
+    struct MemorySlab *next;                   // Previously allocated slab
+} MemorySlab;
+
+typedef struct MemoryPool {
+    size_t slotSize;                           // Bytes per slot (16-byte aligned)
+    int nextSlabSlots;                         // Slots in the next slab to allocate
+    MemorySlab *slabs;                         // All slabs, newest first
+    char *cursor;                              // Next unused slot in the newest slab
+    int remaining;                             // Unused slots left in the newest slab
+    void *freeList;                            // Recycled slots, linked through their first word
+    long liveSlots;                            // Slots currently handed out
+} MemoryPool;
+
+// Version word on tree nodes for optimistic readers: bit 0 is a writer's lock,
+// bit 1 marks a node that has left its tree, and the rest counts changes.
+typedef unsigned long NodeVersion;
+#define OLC_LOCKED 1UL
+#define OLC_OBSOLETE 2UL
+#define OLC_STEP 4UL
+
 typedef struct ExpiryDate {
     int day;
     int month;
     int year;
+    int dayNumber;                             // Days since 1 Jan 0001 (daysFromCivil)
 } ExpiryDate;
 
 typedef struct SupplierData {
@@ -40,6 +88,7 @@ typedef struct SupplierLeafNode {
 
 typedef struct SupplierNode {
     bool isLeaf;                               // Flag to identify leaf vs internal node
+    NodeVersion version;                       // Optimistic lock word (after the pool's free-list link)
     union {
         SupplierInternalNode internal;
         SupplierLeafNode leaf;
@@ -48,8 +97,13 @@ typedef struct SupplierNode {
 
 typedef struct SupplierBPlusTree {
     SupplierNode *root;                        // Root node
+    NodeVersion version;                       // Guards root for optimistic readers
     int order;                                 // Order of the tree
     SupplierLeafNode *leftmost_leaf;           // Pointer to leftmost leaf for range queries
+    MemoryPool *leafNodes;                     // Node pools shared by all supplier trees of one medication tree
+    MemoryPool *internalNodes;
+    struct SupplierPostings *postings;         // Owner's supplier index while the medication is in the tree, else NULL
+    struct MedicationData *medication;         // Medication these suppliers belong to, set with postings
 } SupplierBPlusTree;
 
 typedef struct MedicationData {
@@ -77,8 +131,8 @@ typedef struct MedicationInternalNode {
 } MedicationInternalNode;
 
 typedef struct MedicationLeafNode {
-    unsigned long *keys;                       // Array of medication IDs
-    MedicationData *values;                    // Array of medication data
+    unsigned long *keys;                       // Array of medication IDs (start of the key/value block)
+    MedicationData **values;                   // Handles into the tree's record arena
     int order;                                 // Maximum number of keys
     int cursize;                               // Current number of keys
     struct MedicationLeafNode *next;           // Pointer to next leaf node for sequential access
@@ -88,16 +142,123 @@ typedef struct MedicationLeafNode {
 
 typedef struct MedicationNode {
     bool isLeaf;                               // Flag to identify leaf vs internal node
+    NodeVersion version;                       // Optimistic lock word (after the pool's free-list link)
     union {
         MedicationInternalNode internal;
         MedicationLeafNode leaf;
     };
 } MedicationNode;
 
+// Name index nodes: leaves hold record handles ordered by (lower-cased name, ID);
+// internal nodes keep copies of their separators so deletes never leave them dangling.
+typedef struct NameKey {
+    char name[NAME_SIZE];                      // Lower-cased medicine name
+    unsigned long id;                          // Medication ID, breaks ties between equal names
+} NameKey;
+
+typedef struct NameIndexInternalNode {
+    NameKey *keys;                             // Separator keys
+    int order;                                 // Maximum number of keys
+    int cursize;                               // Current number of keys
+    struct NameIndexNode **children;           // Pointers to children nodes
+    struct NameIndexInternalNode *parent;      // Pointer to parent
+} NameIndexInternalNode;
+
+typedef struct NameIndexLeafNode {
+    MedicationData **values;                   // Records, also the keys
+    int order;                                 // Maximum number of entries
+    int cursize;                               // Current number of entries
+    struct NameIndexLeafNode *next;            // Pointer to next leaf node
+    struct NameIndexLeafNode *prev;            // Pointer to previous leaf node
+    struct NameIndexInternalNode *parent;      // Pointer to parent
+} NameIndexLeafNode;
+
+typedef struct NameIndexNode {
+    bool isLeaf;                               // Flag to identify leaf vs internal node
+    union {
+        NameIndexInternalNode internal;
+        NameIndexLeafNode leaf;
+    };
+} NameIndexNode;
+
+typedef struct NameIndex {
+    NameIndexNode *root;                       // Root node
+    int order;                                 // Order of the tree
+    NameIndexLeafNode *leftmost_leaf;          // Pointer to leftmost leaf
+    MemoryPool leafNodes;                      // Node pools, one size class each
+    MemoryPool internalNodes;
+} NameIndex;
+
+typedef enum NameMatch {
+    NAME_MATCH_EXACT,                          // Same name, same case
+    NAME_MATCH_IGNORE_CASE,
+    NAME_MATCH_PREFIX                          // Names starting with the query, ignoring case
+} NameMatch;
+
+// Supplier postings: one entry per (supplier, medication) pair, ordered by
+// supplier and then medication ID, so a supplier's medications form one run.
+typedef struct SupplierPosting {
+    unsigned long supplierID;
+    unsigned long medicationID;
+    MedicationData *medication;                // Record handle (unused in separators)
+} SupplierPosting;
+
+typedef struct SupplierPostingInternalNode {
+    SupplierPosting *keys;                     // Separator keys
+    int order;                                 // Maximum number of keys
+    int cursize;                               // Current number of keys
+    struct SupplierPostingNode **children;     // Pointers to children nodes
+    struct SupplierPostingInternalNode *parent; // Pointer to parent
+} SupplierPostingInternalNode;
+
+typedef struct SupplierPostingLeafNode {
+    SupplierPosting *entries;                  // Postings, also the keys
+    int order;                                 // Maximum number of entries
+    int cursize;                               // Current number of entries
+    struct SupplierPostingLeafNode *next;      // Pointer to next leaf node
+    struct SupplierPostingLeafNode *prev;      // Pointer to previous leaf node
+    struct SupplierPostingInternalNode *parent; // Pointer to parent
+} SupplierPostingLeafNode;
+
+typedef struct SupplierPostingNode {
+    bool isLeaf;                               // Flag to identify leaf vs internal node
+    union {
+        SupplierPostingInternalNode internal;
+        SupplierPostingLeafNode leaf;
+    };
+} SupplierPostingNode;
+
+typedef struct SupplierPostings {
+    SupplierPostingNode *root;                 // Root node
+    int order;                                 // Order of the tree
+    SupplierPostingLeafNode *leftmost_leaf;    // Pointer to leftmost leaf
+    MemoryPool leafNodes;                      // Node pools, one size class each
+    MemoryPool internalNodes;
+} SupplierPostings;
+
+// Medications at or below their reorder level, sorted by ID so alerts come out
+// in catalogue order. Low stock is rare, so a sorted array of handles is enough.
+typedef struct LowStockSet {
+    MedicationData **records;
+    int count;                                 // Also the "at or below reorder level" gauge
+    int capacity;
+} LowStockSet;
+
 typedef struct MedicationBPlusTree {
     MedicationNode *root;                      // Root node
     int order;                                 // Order of the tree
     MedicationLeafNode *leftmost_leaf;         // Pointer to leftmost leaf for range queries
+    MemoryPool records;                        // Arena owning every MedicationData in the tree
+    MemoryPool leafNodes;                      // Node pools, one size class each
+    MemoryPool internalNodes;
+    MemoryPool supplierTrees;                  // Per-medication supplier trees and their nodes
+    MemoryPool supplierLeafNodes;
+    MemoryPool supplierInternalNodes;
+    NameIndex names;                           // Secondary index on Medicine_Name
+    SupplierPostings postings;                 // Supplier ID -> medications, kept by the supplier trees
+    LowStockSet lowStock;                      // Records with Quantity_in_stock <= Reorderlevel
+    NodeVersion rootVersion;                   // Stands in for the root's parent while crabbing
+    pthread_mutex_t writer;                    // Serializes the lock-coupled writers
 } MedicationBPlusTree;
 
 typedef struct UniqueSupplierData {
@@ -133,25 +294,64 @@ typedef struct UniqueSupplierNode {
     };
 } UniqueSupplierNode;
 
+// Supplier ranking nodes: leaves hold (total, supplier ID) keys, largest total first
+typedef struct RankKey {
+    unsigned long total;                       // Turnover or medicine count
+    unsigned long id;                          // Supplier ID, breaks ties
+} RankKey;
+
+typedef struct RankingInternalNode {
+    RankKey *keys;                             // Separator keys
+    int order;                                 // Maximum number of keys
+    int cursize;                               // Current number of keys
+    struct RankingNode **children;             // Pointers to children nodes
+    struct RankingInternalNode *parent;        // Pointer to parent
+} RankingInternalNode;
+
+typedef struct RankingLeafNode {
+    RankKey *keys;                             // Ranked entries
+    int order;                                 // Maximum number of entries
+    int cursize;                               // Current number of entries
+    struct RankingLeafNode *next;              // Pointer to next leaf node
+    struct RankingLeafNode *prev;              // Pointer to previous leaf node
+    struct RankingInternalNode *parent;        // Pointer to parent
+} RankingLeafNode;
+
+typedef struct RankingNode {
+    bool isLeaf;                               // Flag to identify leaf vs internal node
+    union {
+        RankingInternalNode internal;
+        RankingLeafNode leaf;
+    };
+} RankingNode;
+
+typedef struct SupplierRanking {
+    RankingNode *root;                         // Root node
+    int order;                                 // Order of the tree
+    RankingLeafNode *leftmost_leaf;            // Highest-ranked entries
+    MemoryPool leafNodes;                      // Node pools, one size class each
+    MemoryPool internalNodes;
+} SupplierRanking;
+
 typedef struct UniqueSupplierBPlusTree {
     UniqueSupplierNode *root;                  // Root node
     int order;                                 // Order of the tree
     UniqueSupplierLeafNode *leftmost_leaf;     // Pointer to leftmost leaf
+    MemoryPool leafNodes;                      // Node pools, one size class each
+    MemoryPool internalNodes;
+    SupplierRanking byTurnover;                // Suppliers by turnoverProduced
+    SupplierRanking byMedicines;               // Suppliers by noOfUniqueMedicines
 } UniqueSupplierBPlusTree;
 
-typedef struct HeapNode {
-    UniqueSupplierData data; 
-} HeapNode;
-
 typedef struct ExpirationIndexData {
-    unsigned long long int expirationKey; // Expiration date in YYYYMMDD format
+    unsigned long long int expirationKey; // Expiry day number, then medication ID (makeExpirationKey)
     unsigned long medicationID; // Medication ID
     char medicineName[NAME_SIZE]; // Medication name
 } ExpirationIndexData;
 
 typedef struct ExpirationLeafNode {
     unsigned long long int* keys; // Array of expiration keys
-    ExpirationIndexData* values; // Array of pointers to medication records
+    ExpirationIndexData* values; // Array of medication entries
     int order; // Maximum number of keys
     int cursize; // Current number of keys
     struct ExpirationLeafNode* next; // Pointer to the next leaf node
@@ -179,63 +379,643 @@ typedef struct ExpirationBPlusTree {
     ExpirationNode* root; // Root node
     int order; // Order of the tree
     ExpirationLeafNode* leftmost_leaf; // Pointer to the leftmost leaf node
+    MemoryPool leafNodes; // Node pools, one size class each
+    MemoryPool internalNodes;
 } ExpirationBPlusTree;
 
+// Height and occupancy figures for one tree, or summed over a set of trees
+typedef struct TreeShape {
+    int trees;                                 // Non-empty trees walked
+    int height;                                // Levels including the leaves (tallest tree)
+    long leaves;
+    long internalNodes;
+    long keys;                                 // Entries held in leaves
+    long leafSlots;                            // Leaf capacity, order - 1 per leaf
+    long underfull;                            // Non-root nodes below the minimum of (order - 1) / 2 keys
+} TreeShape;
+
+// Whole-catalog totals, from summarizeMedications
+typedef struct CatalogSummary {
+    long medications;
+    unsigned long stockUnits;
+    unsigned long stockValue;                  // Stock times unit price
+    long unitsSold;
+    long revenue;                              // Sales times unit price
+    long lowStock;                             // At or below the reorder level
+    long outOfStock;
+    long expired;                              // Before the date asked about
+} CatalogSummary;
+
+// Scans one run of the medication leaf chain, [first, end), into partial
+typedef void (*MedicationRunScan)(MedicationLeafNode *first, MedicationLeafNode *end, void *partial, void *context);
+
+// Mutations recorded in the write-ahead log
+typedef enum WalRecordType {
+    WAL_INSERT_MEDICATION = 1,
+    WAL_UPDATE_MEDICATION,
+    WAL_DELETE_MEDICATION,
+    WAL_SALE,
+    WAL_SUPPLIER_CHANGE,
+    WAL_UNIQUE_SUPPLIER,
+    WAL_SALE_BASKET                            // Every line of one basket, applied together
+} WalRecordType;
+
+typedef enum WalDurability {
+    WAL_SYNC_EACH,                             // fdatasync after every record
+    WAL_SYNC_GROUP,                            // fdatasync once per batch of records or time window
+    WAL_SYNC_NONE                              // Leave flushing to the OS
+} WalDurability;
+
+// One line of a sales basket
+typedef struct SaleItem {
+    unsigned long id;                          // Medication ID
+    int quantity;                              // Units sold
+} SaleItem;
+
+// One row of a supplier feed
+typedef struct SupplierFeedRow {
+    unsigned long medicationID;
+    int line;                                  // Line in the feed file, so later rows win
+    SupplierData supplier;
+} SupplierFeedRow;
+
 //=====================================================================================================================
 
 
 
 MedicationNode* findLeafNode(MedicationBPlusTree *tree, unsigned long key);
-MedicationNode* splitLeafNode(MedicationLeafNode *leaf, unsigned long *midKey);
-MedicationNode* splitInternalNode(MedicationInternalNode *node, unsigned long *midKey);
-bool insertIntoLeaf(MedicationLeafNode *leaf, unsigned long key, MedicationData data);
+MedicationData* findMedication(MedicationBPlusTree *tree, unsigned long id);
+bool lookupMedication(MedicationBPlusTree *tree, unsigned long id, MedicationData *copy);
+bool lookupSupplier(MedicationBPlusTree *tree, unsigned long medicationID, unsigned long supplierID, SupplierData *copy);
+MedicationNode* splitLeafNode(MedicationBPlusTree *tree, MedicationLeafNode *leaf, unsigned long *midKey);
+MedicationNode* splitInternalNode(MedicationBPlusTree *tree, MedicationInternalNode *node, unsigned long *midKey);
+bool insertIntoLeaf(MedicationLeafNode *leaf, unsigned long key, MedicationData *record);
 void insertIntoInternalNode(MedicationInternalNode *node, unsigned long key, MedicationNode *left, MedicationNode *right);
 bool insertMedication(MedicationBPlusTree *tree, MedicationData data) ;
 bool CheckMedicIdExist(unsigned long newID, MedicationBPlusTree *tree) ;
-MedicationData createMedicationData(int order, MedicationBPlusTree *tree) ;
-MedicationNode* createMedicationNode(int order, bool isLeaf) ;
+bool deleteMedicationByID(MedicationBPlusTree *tree, unsigned long id);
+bool deleteSupplierByID(SupplierBPlusTree *tree, unsigned long id);
+MedicationData createMedicationData(MedicationBPlusTree *tree) ;
+MedicationNode* createMedicationNode(MedicationBPlusTree *tree, bool isLeaf) ;
 MedicationBPlusTree* createMedicationBPlusTree(int order);
+void destroyMedicationBPlusTree(MedicationBPlusTree *tree);
+bool bulkLoadMedications(MedicationBPlusTree *tree, MedicationData **records, int count, double fillFactor);
+int insertMedicationBatch(MedicationBPlusTree *tree, MedicationData *items, int count);
+void nameIndexInit(NameIndex *index, int order);
+void nameIndexDestroy(NameIndex *index);
+void nameIndexInsert(NameIndex *index, MedicationData *record);
+void nameIndexRemove(NameIndex *index, const MedicationData *record);
+bool nameIndexBuild(NameIndex *index, MedicationData **records, int count, double fillFactor);
+void replaceMedicationRecord(MedicationBPlusTree *tree, MedicationData *record, const MedicationData *data);
+bool renameMedication(MedicationBPlusTree *tree, unsigned long id, const char *newName);
+void supplierPostingsInit(SupplierPostings *postings, int order);
+void supplierPostingsDestroy(SupplierPostings *postings);
+void supplierPostingsInsert(SupplierPostings *postings, unsigned long supplierID, MedicationData *medication);
+void supplierPostingsRemove(SupplierPostings *postings, unsigned long supplierID, unsigned long medicationID);
+bool supplierPostingsBuild(MedicationBPlusTree *tree, MedicationData **records, int count, double fillFactor);
+void attachSupplierTree(MedicationBPlusTree *tree, MedicationData *record);
+void detachSupplierTree(SupplierBPlusTree *suppliers);
+int findMedicationsBySupplier(MedicationBPlusTree *tree, unsigned long supplierID,
+                              void (*visit)(MedicationData *medication, void *context), void *context);
+void lowStockUpdate(LowStockSet *set, MedicationData *record);
+void lowStockRemove(LowStockSet *set, const MedicationData *record);
+bool lowStockBuild(LowStockSet *set, MedicationData **records, int count);
+int lowStockCount(const MedicationBPlusTree *tree);
+int scanMedicationsParallel(MedicationBPlusTree *tree, MedicationRunScan scan, void *context, size_t partialSize, void **partials);
+bool summarizeMedications(MedicationBPlusTree *tree, int today, CatalogSummary *summary);
 
 
 void printTreeStructure(MedicationNode *node, int level);
+void printTreeShapeReport(MedicationBPlusTree *pharmacy);
 void printBPlusTree(MedicationBPlusTree* tree);
 
 SupplierData initSupplier(SupplierBPlusTree *supplierTree, MedicationData *medicine);
 bool checkSuppID(unsigned long id, SupplierBPlusTree *tree);
-SupplierNode* splitSupplierLeafNode(SupplierLeafNode *leaf,unsigned long *midKey) ;
-SupplierNode* splitSupplierInternalNode( SupplierInternalNode *node,unsigned long *midKey) ;
-SupplierNode* createSupplierNode(int order, bool isLeaf);
-SupplierBPlusTree* createSupplierBPlusTree(int order);
+SupplierNode* splitSupplierLeafNode(SupplierBPlusTree *tree, SupplierLeafNode *leaf,unsigned long *midKey) ;
+SupplierNode* splitSupplierInternalNode(SupplierBPlusTree *tree, SupplierInternalNode *node,unsigned long *midKey) ;
+SupplierNode* createSupplierNode(SupplierBPlusTree *tree, bool isLeaf);
+SupplierBPlusTree* createSupplierBPlusTree(MedicationBPlusTree *owner);
+void releaseSupplierBPlusTree(MedicationBPlusTree *owner, SupplierBPlusTree *tree);
 bool insertSupplier(SupplierBPlusTree *tree, SupplierData data) ;
+int insertSupplierBatch(SupplierBPlusTree *tree, SupplierData *items, int count);
 SupplierNode* findSupplierLeafNode(SupplierBPlusTree *tree, unsigned long key); 
 
 
-ExpirationNode* createExpirationNode(int order, bool isLeaf);
+ExpirationNode* createExpirationNode(ExpirationBPlusTree* tree, bool isLeaf);
 ExpirationBPlusTree* createExpirationBPlusTree(int order);
-ExpirationNode* splitInternalNodeForExpiry(ExpirationInternalNode* node, int* midKey);
-void insertIntoInternalNodeForExpiry(ExpirationInternalNode* node, int key, ExpirationNode* left, ExpirationNode* right);
-void insertIntoLeafForExpiry(ExpirationLeafNode* leaf, int expirationKey, unsigned long medicationID, const char* medicineName);
-ExpirationNode* findLeafNodeForExpiry(ExpirationBPlusTree* tree, int expirationKey);
-ExpirationNode* splitLeafNodeForExpiry(ExpirationLeafNode* leaf, int* midKey);
-void insertIntoParentForExpiry(ExpirationBPlusTree* tree, ExpirationNode* leftNode, int midKey, ExpirationNode* rightNode);
+void destroyExpirationBPlusTree(ExpirationBPlusTree* tree);
+bool bulkLoadExpirationTree(ExpirationBPlusTree *tree, ExpirationIndexData *items, int count, double fillFactor);
+ExpirationNode* splitInternalNodeForExpiry(ExpirationBPlusTree* tree, ExpirationInternalNode* node, unsigned long long int* midKey);
+void insertIntoInternalNodeForExpiry(ExpirationInternalNode* node, unsigned long long int key, ExpirationNode* left, ExpirationNode* right);
+void insertIntoLeafForExpiry(ExpirationLeafNode* leaf, unsigned long long int expirationKey, unsigned long medicationID, const char* medicineName);
+ExpirationNode* findLeafNodeForExpiry(ExpirationBPlusTree* tree, unsigned long long int expirationKey);
+ExpirationNode* splitLeafNodeForExpiry(ExpirationBPlusTree* tree, ExpirationLeafNode* leaf, unsigned long long int* midKey);
+void insertIntoParentForExpiry(ExpirationBPlusTree* tree, ExpirationNode* leftNode, unsigned long long int midKey, ExpirationNode* rightNode);
 void insertIntoExpirationTree(ExpirationBPlusTree* tree, unsigned long long int expirationKey, unsigned long medicationID, const char* medicineName);
+void deleteFromExpirationTree(ExpirationBPlusTree* tree, unsigned long long int expirationKey);
+void renameExpirationEntry(ExpirationBPlusTree* tree, unsigned long long int expirationKey, const char* medicineName);
 
 
 bool checkUniqueSupplierID(unsigned long id, UniqueSupplierBPlusTree* tree);
+void destroyUniqueSupplierBPlusTree(UniqueSupplierBPlusTree* tree);
 UniqueSupplierNode* findUniqueSupplierLeafNode(UniqueSupplierBPlusTree* tree, unsigned long supplierID);
 void deleteUniqueSupplier(UniqueSupplierBPlusTree* tree, unsigned long supplierID);
 void updateUniqueSupplierTreeAfterInsert(unsigned long supplierID, const char *supplierName, unsigned int quantity, unsigned long turnover);
 void updateUniqueSupplierTreeAfterDelete(unsigned long supplierID, unsigned int quantity, unsigned long turnover);
 bool checkUniqueSupplier(unsigned long id);
 void printUniqueSuppliers(UniqueSupplierBPlusTree* tree);
+bool insertUniqueSupplier(UniqueSupplierBPlusTree* tree, unsigned long supplierID, const char* supplierName, unsigned int noOfUniqueMedicines, unsigned long turnover);
+UniqueSupplierData* findUniqueSupplier(UniqueSupplierBPlusTree *tree, unsigned long supplierID);
+void setUniqueSupplierTotals(UniqueSupplierBPlusTree *tree, UniqueSupplierData *data, unsigned int medicines, unsigned long turnover);
+int topUniqueSuppliers(UniqueSupplierBPlusTree *tree, bool byTurnover, int k,
+                       void (*visit)(const UniqueSupplierData *supplier, void *context), void *context);
+
+unsigned long long medicationExpirationKey(const MedicationData *medication);
+bool sellMedication(MedicationBPlusTree *tree, unsigned long id, int quantity);
+bool sellBasket(MedicationBPlusTree *tree, const SaleItem *items, int count, int *failedItem);
+bool replayPosFile(MedicationBPlusTree *tree, const char *filename);
+long applySupplierFeed(MedicationBPlusTree *tree, const SupplierFeedRow *rows, long count, long *unknown);
+bool importSupplierFeed(MedicationBPlusTree *tree, const char *filename);
+bool runBatch(MedicationBPlusTree *tree, const char *filename, FILE *output, const char *snapshotPath);
+bool runServer(MedicationBPlusTree *tree, const char *address, const char *snapshotPath);
+bool runLoadGenerator(const char *address, int connectionCount, long requests, unsigned long idRange);
+
+void walLogMedication(WalRecordType type, const MedicationData *record);
+void walLogDelete(unsigned long id);
+void walLogSale(unsigned long id, int quantity);
+void walLogBasket(const SaleItem *items, int count);
+void walLogUniqueSupplier(unsigned long supplierID);
+void walBeginBatch(void);
+void walEndBatch(void);
+static double nowSeconds(void);
+static unsigned long benchRandom(unsigned long *state);
+int runBenchmarkSuite(int argc, char *argv[]);
 
 
 
 UniqueSupplierBPlusTree *uniqueSupplierTree = NULL;
 ExpirationBPlusTree* expirationTree = NULL;
-int days_in_month[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+// Split and parent insertion only see the internal/leaf member of a node;
+// this recovers the enclosing node (both members share the union offset).
+#define NODE_FROM_MEMBER(ptr, type) ((type *)((char *)(ptr) - offsetof(type, internal)))
+
+//==============================================================================
+// Slab memory pool
+
+#define POOL_MAX_SLAB_BYTES (1 << 20)
+
+void poolInit(MemoryPool *pool, size_t slotSize) {
+    if (slotSize < sizeof(void*)) slotSize = sizeof(void*);
+    pool->slotSize = (slotSize + 15) & ~(size_t)15;
+    pool->nextSlabSlots = 1;
+    pool->slabs = NULL;
+    pool->cursor = NULL;
+    pool->remaining = 0;
+    pool->freeList = NULL;
+    pool->liveSlots = 0;
+}
+
+void* poolAlloc(MemoryPool *pool) {
+    void *slot;
+
+    if (pool->freeList) {
+        slot = pool->freeList;
+        pool->freeList = *(void**)slot;
+    } else {
+        if (pool->remaining == 0) {
+            // Slabs double until they reach POOL_MAX_SLAB_BYTES, so small trees stay small
+            int slots = pool->nextSlabSlots;
+            size_t header = (sizeof(MemorySlab) + 15) & ~(size_t)15;
+            MemorySlab *slab = (MemorySlab*)malloc(header + pool->slotSize * slots);
+            if (!slab) return NULL;
+
+            slab->next = pool->slabs;
+            pool->slabs = slab;
+            pool->cursor = (char*)slab + header;
+            pool->remaining = slots;
+
+            if (pool->slotSize * slots * 2 <= POOL_MAX_SLAB_BYTES) {
+                pool->nextSlabSlots = slots * 2;
+            }
+        }
+        slot = pool->cursor;
+        pool->cursor += pool->slotSize;
+        pool->remaining--;
+    }
+
+    pool->liveSlots++;
+    return slot;
+}
+
+void poolFree(MemoryPool *pool, void *slot) {
+    if (!slot) return;
+    *(void**)slot = pool->freeList;
+    pool->freeList = slot;
+    pool->liveSlots--;
+}
+
+// Releases every slot at once; the pool can be reused afterwards.
+void poolDestroy(MemoryPool *pool) {
+    MemorySlab *slab = pool->slabs;
+    while (slab) {
+        MemorySlab *next = slab->next;
+        free(slab);
+        slab = next;
+    }
+    poolInit(pool, pool->slotSize);
+}
+
+//==============================================================================
+// Optimistic lock coupling on tree nodes
+//
+// A reader notes a node's version, reads what it needs and checks that the
+// version has not moved; if it has, a writer got there first and the reader
+// starts over from the root. Readers never store to shared memory, so lookups
+// of hot records do not drag cache lines between cores. Pointers read from a
+// node are only followed once that node has validated. Freed nodes stay in
+// their pool's memory and are marked obsolete first, so a reader that loses a
+// race reads stale bytes, never unmapped ones, and always fails validation.
+
+// Readers spin this many times on a locked node before yielding the CPU
+#define OLC_SPINS_BEFORE_YIELD 64
+
+static inline NodeVersion olcReadBegin(const NodeVersion *version) {
+    NodeVersion seen;
+    int spins = 0;
+    while ((seen = __atomic_load_n(version, __ATOMIC_ACQUIRE)) & OLC_LOCKED) {
+        if (++spins == OLC_SPINS_BEFORE_YIELD) {
+            spins = 0;
+            sched_yield();
+        }
+    }
+    return seen;
+}
+
+// True if nothing has changed the node since olcReadBegin returned seen.
+static inline bool olcReadValidate(const NodeVersion *version, NodeVersion seen) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return !(seen & OLC_OBSOLETE) && __atomic_load_n(version, __ATOMIC_RELAXED) == seen;
+}
+
+static inline void olcWriteLock(NodeVersion *version) {
+    for (;;) {
+        NodeVersion current = __atomic_load_n(version, __ATOMIC_RELAXED);
+        if (!(current & OLC_LOCKED) &&
+            __atomic_compare_exchange_n(version, &current, current | OLC_LOCKED, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            break;
+        }
+        sched_yield();
+    }
+    // The lock bit must be visible before any of the changes it covers
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+static inline void olcWriteUnlock(NodeVersion *version) {
+    __atomic_store_n(version, (*version & ~OLC_LOCKED) + OLC_STEP, __ATOMIC_RELEASE);
+}
+
+// Marks a node that has left its tree, locked or not; its slot may be freed after.
+static inline void olcMarkObsolete(NodeVersion *version) {
+    __atomic_store_n(version, (*version + OLC_STEP) | OLC_OBSOLETE, __ATOMIC_RELEASE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+// Gives a node fresh from its pool a version above any its slot had before,
+// so a reader still holding the old node's version cannot validate against it.
+static inline void olcInit(NodeVersion *version) {
+    __atomic_store_n(version, (*version | (OLC_STEP - 1)) + 1, __ATOMIC_RELAXED);
+}
+
+//==============================================================================
+// Instrumentation (built with -DPHARMACY_STATS)
+//
+// Counters for the medication tree's hot paths and latency histograms for its
+// main operations, printed by menu option 17, the batch command "stats" and
+// SIGUSR1. Without the flag the STAT_ macros expand to nothing and only a
+// note saying so is left to print.
+
+typedef enum StatCounter {
+    STAT_NODE_VISITS,                          // Nodes descended through, leaves included
+    STAT_SPLITS,
+    STAT_MERGES,
+    STAT_BORROWS,
+    STAT_KEY_SHIFTS,                           // Keys moved within or between nodes
+    STAT_BYTES_MOVED,                          // Bytes of keys, values and children moved
+    STAT_COUNTER_COUNT
+} StatCounter;
+
+typedef enum StatTimer {
+    STAT_INSERT,
+    STAT_FIND_LEAF,
+    STAT_DELETE,
+    STAT_SELL,
+    STAT_SELL_BASKET,
+    STAT_LOAD,
+    STAT_SAVE,
+    STAT_TIMER_COUNT
+} StatTimer;
+
+static const char *statCounterNames[] = { "node_visits", "splits", "merges", "borrows", "key_shifts", "bytes_moved" };
+static const char *statTimerNames[] = { "insertMedication", "findLeafNode", "deleteMedicationByID",
+                                        "sellMedication", "sellBasket", "ReadFileAndStoreData", "SaveDataToFile" };
+
+#ifdef PHARMACY_STATS
+
+// HDR-style buckets: exact below 16 ns, then 16 per power of two, so a
+// recorded latency is within 1/16 of the value reported for it.
+#define STAT_SUB_BUCKET_BITS 4
+#define STAT_SUB_BUCKETS (1 << STAT_SUB_BUCKET_BITS)
+#define STAT_BUCKETS ((64 - STAT_SUB_BUCKET_BITS + 1) * STAT_SUB_BUCKETS)
+
+typedef struct StatHistogram {
+    unsigned long buckets[STAT_BUCKETS];
+    unsigned long totalNanoseconds;
+    unsigned long maxNanoseconds;
+} StatHistogram;
+
+static unsigned long statCounters[STAT_COUNTER_COUNT];
+static StatHistogram statHistograms[STAT_TIMER_COUNT];
+
+static inline unsigned long statNanoseconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long)ts.tv_sec * 1000000000UL + ts.tv_nsec;
+}
+
+static inline int statBucket(unsigned long value) {
+    if (value < STAT_SUB_BUCKETS) return (int)value;
+    int magnitude = 63 - __builtin_clzl(value);
+    return (magnitude - STAT_SUB_BUCKET_BITS + 1) * STAT_SUB_BUCKETS
+         + (int)((value >> (magnitude - STAT_SUB_BUCKET_BITS)) & (STAT_SUB_BUCKETS - 1));
+}
+
+// Largest value that lands in bucket.
+static unsigned long statBucketValue(int bucket) {
+    if (bucket < STAT_SUB_BUCKETS) return bucket;
+    int shift = bucket / STAT_SUB_BUCKETS - 1;
+    unsigned long low = (unsigned long)(STAT_SUB_BUCKETS + bucket % STAT_SUB_BUCKETS) << shift;
+    return low + ((1UL << shift) - 1);
+}
+
+static void statRecord(StatTimer timer, unsigned long start) {
+    unsigned long elapsed = statNanoseconds() - start;
+    StatHistogram *histogram = &statHistograms[timer];
+    __atomic_fetch_add(&histogram->buckets[statBucket(elapsed)], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&histogram->totalNanoseconds, elapsed, __ATOMIC_RELAXED);
+    unsigned long max = __atomic_load_n(&histogram->maxNanoseconds, __ATOMIC_RELAXED);
+    while (elapsed > max && !__atomic_compare_exchange_n(&histogram->maxNanoseconds, &max, elapsed, true,
+                                                         __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+#define STAT_ADD(counter, n) __atomic_fetch_add(&statCounters[counter], (unsigned long)(n), __ATOMIC_RELAXED)
+#define STAT_MOVE(keys, bytes) (STAT_ADD(STAT_KEY_SHIFTS, keys), STAT_ADD(STAT_BYTES_MOVED, bytes))
+#define STAT_TIMER_START(name) unsigned long statStart_##name = statNanoseconds()
+#define STAT_TIMER_STOP(name, timer) statRecord(timer, statStart_##name)
+
+#else
+
+#define STAT_ADD(counter, n) ((void)0)
+#define STAT_MOVE(keys, bytes) ((void)0)
+#define STAT_TIMER_START(name)
+#define STAT_TIMER_STOP(name, timer) ((void)0)
+
+#endif
+
+// One histogram reduced to its count and percentiles, in nanoseconds.
+typedef struct StatLatency {
+    unsigned long count;
+    unsigned long mean, p50, p90, p99, p999, max;
+} StatLatency;
+
+// Fills counters and latencies (STAT_COUNTER_COUNT and STAT_TIMER_COUNT
+// entries); false when statistics are compiled out. Counts taken while
+// operations run may be a few updates apart from each other.
+bool readStats(unsigned long *counters, StatLatency *latencies) {
+#ifdef PHARMACY_STATS
+    for (int i = 0; i < STAT_COUNTER_COUNT; i++) counters[i] = __atomic_load_n(&statCounters[i], __ATOMIC_RELAXED);
+    for (int t = 0; t < STAT_TIMER_COUNT; t++) {
+        StatHistogram *histogram = &statHistograms[t];
+        StatLatency *latency = &latencies[t];
+        memset(latency, 0, sizeof(*latency));
+        unsigned long total = 0;
+        for (int b = 0; b < STAT_BUCKETS; b++) total += __atomic_load_n(&histogram->buckets[b], __ATOMIC_RELAXED);
+        latency->count = total;
+        if (total == 0) continue;
+        latency->mean = __atomic_load_n(&histogram->totalNanoseconds, __ATOMIC_RELAXED) / total;
+        latency->max = __atomic_load_n(&histogram->maxNanoseconds, __ATOMIC_RELAXED);
+
+        double quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+        unsigned long *values[] = { &latency->p50, &latency->p90, &latency->p99, &latency->p999 };
+        unsigned long seen = 0;
+        int q = 0;
+        for (int b = 0; b < STAT_BUCKETS && q < 4; b++) {
+            seen += __atomic_load_n(&histogram->buckets[b], __ATOMIC_RELAXED);
+            while (q < 4 && seen >= quantiles[q] * total) {
+                *values[q] = statBucketValue(b);
+                if (*values[q] > latency->max) *values[q] = latency->max;
+                q++;
+            }
+        }
+    }
+    return true;
+#else
+    (void)counters;
+    (void)latencies;
+    return false;
+#endif
+}
+
+void resetStats(void) {
+#ifdef PHARMACY_STATS
+    for (int i = 0; i < STAT_COUNTER_COUNT; i++) __atomic_store_n(&statCounters[i], 0, __ATOMIC_RELAXED);
+    for (int t = 0; t < STAT_TIMER_COUNT; t++) {
+        StatHistogram *histogram = &statHistograms[t];
+        for (int b = 0; b < STAT_BUCKETS; b++) __atomic_store_n(&histogram->buckets[b], 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&histogram->totalNanoseconds, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&histogram->maxNanoseconds, 0, __ATOMIC_RELAXED);
+    }
+#endif
+}
+
+void printStats(FILE *out) {
+    unsigned long counters[STAT_COUNTER_COUNT];
+    StatLatency latencies[STAT_TIMER_COUNT];
+    if (!readStats(counters, latencies)) {
+        fprintf(out, "Statistics are not compiled in; build with -DPHARMACY_STATS.\n");
+        return;
+    }
+    fprintf(out, "\n=== MEDICATION TREE COUNTERS ===\n");
+    for (int i = 0; i < STAT_COUNTER_COUNT; i++) fprintf(out, "%-22s %lu\n", statCounterNames[i], counters[i]);
+    fprintf(out, "\n=== LATENCY (microseconds) ===\n");
+    fprintf(out, "%-22s %10s %10s %10s %10s %10s %10s %10s\n", "operation", "count", "mean", "p50", "p90", "p99", "p99.9", "max");
+    for (int t = 0; t < STAT_TIMER_COUNT; t++) {
+        StatLatency *l = &latencies[t];
+        fprintf(out, "%-22s %10lu %10.2f %10.2f %10.2f %10.2f %10.2f %10.2f\n", statTimerNames[t], l->count,
+                l->mean / 1000.0, l->p50 / 1000.0, l->p90 / 1000.0, l->p99 / 1000.0, l->p999 / 1000.0, l->max / 1000.0);
+    }
+    fflush(out);
+}
+
+// Prints the statistics to stderr each time SIGUSR1 arrives, or the note that
+// they are not built in, so the signal never takes its default action of
+// ending the process. The signal is blocked here, before any other thread
+// starts, so only this thread takes it.
+static void* statsSignalMain(void *arg) {
+    sigset_t *signals = (sigset_t*)arg;
+    for (;;) {
+        int signal;
+        if (sigwait(signals, &signal) == 0) printStats(stderr);
+    }
+    return NULL;
+}
+
+void startStatsSignalThread(void) {
+    static sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, statsSignalMain, &signals) == 0) pthread_detach(thread);
+}
+
+//==============================================================================
+// In-node key search shared by all tree families
+
+// Below this many keys the remaining window is counted directly (SIMD when available).
+#define KEY_SEARCH_WINDOW 16
+
+static inline int countKeysBelow(const unsigned long *keys, int n, unsigned long key) {
+    int count = 0;
+    int i = 0;
+#if defined(__AVX2__)
+    // Flip the sign bit so the signed 64-bit compare orders unsigned keys correctly
+    const __m256i bias = _mm256_set1_epi64x((long long)0x8000000000000000ULL);
+    const __m256i needle = _mm256_xor_si256(_mm256_set1_epi64x((long long)key), bias);
+    for (; i + 4 <= n; i += 4) {
+        __m256i block = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(keys + i)), bias);
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(needle, block)));
+        count += __builtin_popcount(mask);
+    }
+#endif
+    for (; i < n; i++) {
+        count += keys[i] < key;
+    }
+    return count;
+}
+
+// Index of the first key >= key (the insert position in a leaf).
+static inline int lowerBoundKey(const unsigned long *keys, int n, unsigned long key) {
+    const unsigned long *base = keys;
+    int len = n;
+
+    // Branchless narrowing: the compare feeds a conditional move, not a jump
+    while (len > KEY_SEARCH_WINDOW) {
+        int half = len / 2;
+        base = (base[half] < key) ? base + half : base;
+        len -= half;
+    }
+    return (int)(base - keys) + countKeysBelow(base, len, key);
+}
+
+// Index of the first key > key (the child to descend into from an internal node).
+static inline int upperBoundKey(const unsigned long *keys, int n, unsigned long key) {
+    if (key == (unsigned long)-1) return n;
+    return lowerBoundKey(keys, n, key + 1);
+}
+
+// Position of key in a sorted key array, or -1 if absent.
+static inline int findKeyIndex(const unsigned long *keys, int n, unsigned long key) {
+    int pos = lowerBoundKey(keys, n, key);
+    return (pos < n && keys[pos] == key) ? pos : -1;
+}
+
+static inline int lowerBoundExpiryKey(const unsigned long long *keys, int n, unsigned long long key) {
+    const unsigned long long *base = keys;
+    int len = n;
+
+    while (len > 1) {
+        int half = len / 2;
+        base = (base[half] < key) ? base + half : base;
+        len -= half;
+    }
+    return (int)(base - keys) + (len == 1 && *base < key);
+}
+
+static inline int upperBoundExpiryKey(const unsigned long long *keys, int n, unsigned long long key) {
+    if (key == (unsigned long long)-1) return n;
+    return lowerBoundExpiryKey(keys, n, key + 1);
+}
+
+//==============================================================================
+// Calendar dates as day numbers: days since 1 January 0001 in the proleptic
+// Gregorian calendar. Conversions are closed-form (400-year eras of 146097
+// days, years counted from March so the leap day comes last), so comparing or
+// subtracting two dates is plain integer arithmetic with no shared state.
+
+int Check_leap_year(int year) {
+    return (year % 4 == 0 && year % 100 != 0) || (year % 400 == 0);
+}
+
+int daysInMonth(int month, int year) {
+    static const int days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    if (month < 1 || month > 12) return 0;
+    return days[month - 1] + (month == 2 && Check_leap_year(year));
+}
+
+int daysFromCivil(int day, int month, int year) {
+    int y = year - (month <= 2);
+    int era = (y >= 0 ? y : y - 399) / 400;
+    int yearOfEra = y - era * 400;                                       // [0, 399]
+    int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1; // From 1 March
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 306;                                // 306: 1 Mar 0000 to 1 Jan 0001
+}
+
+void civilFromDays(int dayNumber, int *day, int *month, int *year) {
+    int z = dayNumber + 306;
+    int era = (z >= 0 ? z : z - 146096) / 146097;
+    int dayOfEra = z - era * 146097;
+    int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int shiftedMonth = (5 * dayOfYear + 2) / 153;                        // 0 is March
+    *day = dayOfYear - (153 * shiftedMonth + 2) / 5 + 1;
+    *month = shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9;
+    *year = yearOfEra + era * 400 + (*month <= 2);
+}
+
+void setExpiryDate(ExpiryDate *date, int day, int month, int year) {
+    date->day = day;
+    date->month = month;
+    date->year = year;
+    date->dayNumber = daysFromCivil(day, month, year);
+}
 
 //==============================================================================
+// Expiration keys order entries by date and then by medication ID, so every
+// medication gets its own entry and a date range is one run of leaves. The
+// day number sits above the low EXPIRATION_KEY_ID_BITS bits of the ID; dates
+// before year 1 are clamped to day 0.
+
+#define EXPIRATION_KEY_ID_BITS 36
+
+static inline unsigned long long makeExpirationKey(int dayNumber, unsigned long medicationID) {
+    unsigned long long date = dayNumber > 0 ? (unsigned long long)dayNumber : 0;
+    return (date << EXPIRATION_KEY_ID_BITS) | (medicationID & ((1ULL << EXPIRATION_KEY_ID_BITS) - 1));
+}
+
+// The day number of a key.
+static inline int expirationKeyDay(unsigned long long key) {
+    return (int)(key >> EXPIRATION_KEY_ID_BITS);
+}
+
+// The date of a key as YYYYMMDD, for display.
+static inline int expirationKeyDate(unsigned long long key) {
+    int day, month, year;
+    civilFromDays(expirationKeyDay(key), &day, &month, &year);
+    return year * 10000 + month * 100 + day;
+}
 
 void printExpirationTreeStructure(ExpirationNode *node, int level) {
     if (!node) return;
@@ -244,13 +1024,13 @@ void printExpirationTreeStructure(ExpirationNode *node, int level) {
     if (node->isLeaf) {
         printf("Leaf Node (Level %d): ", level);
         for (int i = 0; i < node->leaf.cursize; i++) {
-            printf("%d ", node->leaf.keys[i]);
+            printf("%d/%lu ", expirationKeyDate(node->leaf.keys[i]), node->leaf.values[i].medicationID);
         }
         printf("\n");
     } else {
         printf("Internal Node (Level %d): ", level);
         for (int i = 0; i < node->internal.cursize; i++) {
-            printf("%d ", node->internal.keys[i]);
+            printf("%d ", expirationKeyDate(node->internal.keys[i]));
         }
         printf("\n");
         for (int i = 0; i <= node->internal.cursize; i++) {
@@ -275,7 +1055,8 @@ void printExpirationBPlusTree(ExpirationBPlusTree* tree) {
     // Traverse all leaf nodes
     while (current != NULL) {
         for (int i = 0; i < current->cursize; i++) {
-            printf("\nExpiration Key: %d\n", current->keys[i]);
+            int date = expirationKeyDate(current->keys[i]);
+            printf("\nExpiration Date: %02d/%02d/%04d\n", date % 100, date / 100 % 100, date / 10000);
             printf("Medication ID: %lu\n", current->values[i].medicationID);
             printf("Name: %s\n", current->values[i].medicineName);
             printf("----------------------------------------\n");
@@ -288,11 +1069,11 @@ void printExpirationBPlusTree(ExpirationBPlusTree* tree) {
 
 //--====================================================================================================================================================
 
-ExpirationNode* splitInternalNodeForExpiry(ExpirationInternalNode* node, int* midKey) {
+ExpirationNode* splitInternalNodeForExpiry(ExpirationBPlusTree* tree, ExpirationInternalNode* node, unsigned long long int* midKey) {
     int median = node->order / 2;
     *midKey = node->keys[median];
 
-    ExpirationNode* newNode = createExpirationNode(node->order, false);
+    ExpirationNode* newNode = createExpirationNode(tree, false);
     ExpirationInternalNode* newInternal = &(newNode->internal);
 
     // Copy the second half of keys and children to the new node
@@ -326,12 +1107,9 @@ ExpirationNode* splitInternalNodeForExpiry(ExpirationInternalNode* node, int* mi
     return newNode;
 }
 
-void insertIntoInternalNodeForExpiry(ExpirationInternalNode* node, int key, ExpirationNode* left, ExpirationNode* right) {
+void insertIntoInternalNodeForExpiry(ExpirationInternalNode* node, unsigned long long int key, ExpirationNode* left, ExpirationNode* right) {
     // Find the position to insert
-    int pos = 0;
-    while (pos < node->cursize && node->keys[pos] < key) {
-        pos++;
-    }
+    int pos = lowerBoundExpiryKey(node->keys, node->cursize, key);
 
     // Shift existing keys and children
     for (int i = node->cursize; i > pos; i--) {
@@ -359,12 +1137,9 @@ void insertIntoInternalNodeForExpiry(ExpirationInternalNode* node, int key, Expi
 
 }
 
-void insertIntoLeafForExpiry(ExpirationLeafNode* leaf, int expirationKey, unsigned long medicationID, const char* medicineName) {
+void insertIntoLeafForExpiry(ExpirationLeafNode* leaf, unsigned long long int expirationKey, unsigned long medicationID, const char* medicineName) {
     // Find the position to insert
-    int pos = 0;
-    while (pos < leaf->cursize && leaf->keys[pos] < expirationKey) {
-        pos++;
-    }
+    int pos = lowerBoundExpiryKey(leaf->keys, leaf->cursize, expirationKey);
 
     // Shift existing keys and values
     for (int i = leaf->cursize; i > pos; i--) {
@@ -380,7 +1155,7 @@ void insertIntoLeafForExpiry(ExpirationLeafNode* leaf, int expirationKey, unsign
     leaf->cursize++;
 }
 
-ExpirationNode* findLeafNodeForExpiry(ExpirationBPlusTree* tree, int expirationKey) {
+ExpirationNode* findLeafNodeForExpiry(ExpirationBPlusTree* tree, unsigned long long int expirationKey) {
     if (!tree || !tree->root) {
         return NULL; // Tree is empty
     }
@@ -390,14 +1165,9 @@ ExpirationNode* findLeafNodeForExpiry(ExpirationBPlusTree* tree, int expirationK
     // Traverse down to the leaf node
     while (!current->isLeaf) {
         ExpirationInternalNode* internal = &(current->internal);
-        int i;
 
         // Find the child to traverse
-        for (i = 0; i < internal->cursize; i++) {
-            if (expirationKey < internal->keys[i]) {
-                break;
-            }
-        }
+        int i = upperBoundExpiryKey(internal->keys, internal->cursize, expirationKey);
 
         current = internal->children[i];
     }
@@ -406,24 +1176,26 @@ ExpirationNode* findLeafNodeForExpiry(ExpirationBPlusTree* tree, int expirationK
     return current;
 }
 
-ExpirationNode* createExpirationNode(int order, bool isLeaf) {
+ExpirationNode* createExpirationNode(ExpirationBPlusTree* tree, bool isLeaf) {
+    int order = tree->order;
 
-    ExpirationNode* node = (ExpirationNode*)malloc(sizeof(ExpirationNode));
+    // Header, keys and values/children come from one pooled slot
+    ExpirationNode* node = (ExpirationNode*)poolAlloc(isLeaf ? &tree->leafNodes : &tree->internalNodes);
     if (!node) return NULL;
 
     node->isLeaf = isLeaf;
 
     if (isLeaf) {
-        node->leaf.keys = (unsigned long long int*)calloc(order ,sizeof(unsigned long long int));
-        node->leaf.values = (ExpirationIndexData*)calloc(order,sizeof(ExpirationIndexData));
+        node->leaf.keys = (unsigned long long int*)(node + 1);
+        node->leaf.values = (ExpirationIndexData*)(node->leaf.keys + order);
         node->leaf.order = order;
         node->leaf.cursize = 0;
         node->leaf.next = NULL;
         node->leaf.prev = NULL;
         node->leaf.parent = NULL;
     } else {
-        node->internal.keys = (unsigned long long int*)calloc(order ,sizeof(unsigned long long int));
-        node->internal.children = (ExpirationNode**)calloc(order+1 , sizeof(ExpirationNode*));
+        node->internal.keys = (unsigned long long int*)(node + 1);
+        node->internal.children = (ExpirationNode**)(node->internal.keys + order);
         node->internal.order = order;
         node->internal.cursize = 0;
         node->internal.parent = NULL;
@@ -432,11 +1204,11 @@ ExpirationNode* createExpirationNode(int order, bool isLeaf) {
     return node;
 }
 
-ExpirationNode* splitLeafNodeForExpiry(ExpirationLeafNode* leaf, int* midKey) {
+ExpirationNode* splitLeafNodeForExpiry(ExpirationBPlusTree* tree, ExpirationLeafNode* leaf, unsigned long long int* midKey) {
     int median = leaf->order / 2;
 
     // Create a new leaf node
-    ExpirationNode* newNode = createExpirationNode(leaf->order, true);
+    ExpirationNode* newNode = createExpirationNode(tree, true);
     ExpirationLeafNode* newLeaf = &(newNode->leaf);
 
     // Copy the second half of keys and values to the new leaf
@@ -461,11 +1233,11 @@ ExpirationNode* splitLeafNodeForExpiry(ExpirationLeafNode* leaf, int* midKey) {
     return newNode;
 }
 
-void insertIntoParentForExpiry(ExpirationBPlusTree* tree, ExpirationNode* leftNode, int midKey, ExpirationNode* rightNode) {
+void insertIntoParentForExpiry(ExpirationBPlusTree* tree, ExpirationNode* leftNode, unsigned long long int midKey, ExpirationNode* rightNode) {
     // Case 1: leaf is the root (has no parent)
     if ((leftNode->isLeaf && !leftNode->leaf.parent) || (!leftNode->isLeaf && !leftNode->internal.parent)) {
         // Create a new root
-        ExpirationNode* newRoot = createExpirationNode(tree->order, false);
+        ExpirationNode* newRoot = createExpirationNode(tree, false);
         if (!newRoot) return;
 
         tree->root = newRoot;
@@ -488,7 +1260,6 @@ void insertIntoParentForExpiry(ExpirationBPlusTree* tree, ExpirationNode* leftNo
             rightNode->internal.parent = &(newRoot->internal);
         }
 
-        printf("Created new root with key: %d\n", midKey);
         return;
     }
 
@@ -500,85 +1271,31 @@ void insertIntoParentForExpiry(ExpirationBPlusTree* tree, ExpirationNode* leftNo
         parent = leftNode->internal.parent;
     }
 
-    // Create a container node for the parent (for easier handling)
-    ExpirationNode parentContainer;
-    parentContainer.isLeaf = false;
-    parentContainer.internal = *parent;
-
-    // Check if parent has space for a new key
-    if (parent->cursize < parent->order - 1) {
-        // Insert the new key and child into parent
-        int i = parent->cursize - 1;
-        while (i >= 0 && parent->keys[i] > midKey) {
-            parent->keys[i + 1] = parent->keys[i];
-            parent->children[i + 2] = parent->children[i + 1];
-            i--;
-        }
-
-        parent->keys[i + 1] = midKey;
-        parent->children[i + 2] = rightNode;
-        parent->cursize++;
-
-        // Update parent pointer of the right child
-        if (rightNode->isLeaf) {
-            rightNode->leaf.parent = parent;
-        } else {
-            rightNode->internal.parent = parent;
-        }
-        printf("Inserted key %d into existing parent\n", midKey);
-        return;
+    // Insert the new key and child into parent, then split it if that overflowed
+    int i = parent->cursize - 1;
+    while (i >= 0 && parent->keys[i] > midKey) {
+        parent->keys[i + 1] = parent->keys[i];
+        parent->children[i + 2] = parent->children[i + 1];
+        i--;
     }
 
-    // Parent is full, need to split
-    int newMidKey;
-    ExpirationNode* newParentNode = splitInternalNodeForExpiry(parent, &newMidKey);
+    parent->keys[i + 1] = midKey;
+    parent->children[i + 2] = rightNode;
+    parent->cursize++;
 
-    // Decide which parent node should contain our key
-    if (midKey > newMidKey) {
-        // Insert into right parent
-        ExpirationInternalNode* rightParent = &(newParentNode->internal);
-        int i = rightParent->cursize - 1;
-        while (i >= 0 && rightParent->keys[i] > midKey) {
-            rightParent->keys[i + 1] = rightParent->keys[i];
-            rightParent->children[i + 2] = rightParent->children[i + 1];
-            i--;
-        }
-
-        rightParent->keys[i + 1] = midKey;
-        rightParent->children[i + 2] = rightNode;
-        rightParent->cursize++;
-
-        // Update parent pointer
-        if (rightNode->isLeaf) {
-            rightNode->leaf.parent = rightParent;
-        } else {
-            rightNode->internal.parent = rightParent;
-        }
+    if (rightNode->isLeaf) {
+        rightNode->leaf.parent = parent;
     } else {
-        // Insert into original parent
-        int i = parent->cursize - 1;
-        while (i >= 0 && parent->keys[i] > midKey) {
-            parent->keys[i + 1] = parent->keys[i];
-            parent->children[i + 2] = parent->children[i + 1];
-            i--;
-        }
-
-        parent->keys[i + 1] = midKey;
-        parent->children[i + 2] = rightNode;
-        parent->cursize++;
+        rightNode->internal.parent = parent;
+    }
 
-        // Update parent pointer
-        if (rightNode->isLeaf) {
-            rightNode->leaf.parent = parent;
-        } else {
-            rightNode->internal.parent = parent;
-        }
+    if (parent->cursize < parent->order) {
+        return;
     }
-    ExpirationNode* parentContainer2 = (ExpirationNode*)malloc(sizeof(ExpirationNode));
-    
-    parentContainer2->isLeaf = false;
-    parentContainer2->internal = *parent;
-    insertIntoParentForExpiry(tree, parentContainer2, newMidKey, newParentNode);
+
+    unsigned long long int newMidKey;
+    ExpirationNode *newParentNode = splitInternalNodeForExpiry(tree, parent, &newMidKey);
+    insertIntoParentForExpiry(tree, NODE_FROM_MEMBER(parent, ExpirationNode), newMidKey, newParentNode);
 
 }
     
@@ -590,7 +1307,7 @@ void insertIntoExpirationTree(ExpirationBPlusTree* tree, unsigned long long int
 
     // If the tree is empty, create the first leaf node
     if (!tree->root) {
-        ExpirationNode* firstNode = createExpirationNode(tree->order, true);
+        ExpirationNode* firstNode = createExpirationNode(tree, true);
         firstNode->leaf.keys[0] = expirationKey;
         firstNode->leaf.values[0].expirationKey = expirationKey;
         firstNode->leaf.values[0].medicationID = medicationID;
@@ -606,14 +1323,12 @@ void insertIntoExpirationTree(ExpirationBPlusTree* tree, unsigned long long int
     ExpirationNode* leaf2 = findLeafNodeForExpiry(tree, expirationKey);
     ExpirationLeafNode* leaf = &(leaf2->leaf);
 
-    for (int i = 0; i < leaf->cursize; i++) {
-        if (leaf->keys[i] == expirationKey) {
-            // Update the existing value
-            leaf->values[i].medicationID = medicationID;
-            strcpy(leaf->values[i].medicineName, medicineName);
-            printf("Updated existing key: %lu\n", expirationKey);
-            return;
-        }
+    int existing = lowerBoundExpiryKey(leaf->keys, leaf->cursize, expirationKey);
+    if (existing < leaf->cursize && leaf->keys[existing] == expirationKey) {
+        // Update the existing value
+        leaf->values[existing].medicationID = medicationID;
+        strcpy(leaf->values[existing].medicineName, medicineName);
+        return;
     }
 
     if (leaf->cursize < leaf->order - 1) {
@@ -622,8 +1337,8 @@ void insertIntoExpirationTree(ExpirationBPlusTree* tree, unsigned long long int
     }
 
     // If the leaf is full, split it
-    int midKey;
-    ExpirationNode* newLeaf = splitLeafNodeForExpiry(leaf, &midKey);
+    unsigned long long int midKey;
+    ExpirationNode* newLeaf = splitLeafNodeForExpiry(tree, leaf, &midKey);
 
     // Determine which leaf to insert into
     if (expirationKey >= midKey) {
@@ -646,9 +1361,183 @@ ExpirationBPlusTree* createExpirationBPlusTree(int order) {
     tree->order = order;
     tree->root = NULL;
     tree->leftmost_leaf = NULL;
+    poolInit(&tree->leafNodes, sizeof(ExpirationNode) + order * (sizeof(unsigned long long int) + sizeof(ExpirationIndexData)));
+    poolInit(&tree->internalNodes, sizeof(ExpirationNode) + order * sizeof(unsigned long long int) + (order + 1) * sizeof(ExpirationNode*));
     return tree;
 }
 
+// Releases every node of the tree in one pass over the pool slabs.
+void destroyExpirationBPlusTree(ExpirationBPlusTree* tree) {
+    if (!tree) return;
+    poolDestroy(&tree->leafNodes);
+    poolDestroy(&tree->internalNodes);
+    free(tree);
+}
+
+static inline void setExpirationParent(ExpirationNode *node, ExpirationInternalNode *parent) {
+    if (node->isLeaf) node->leaf.parent = parent;
+    else node->internal.parent = parent;
+}
+
+// Borrow-or-merge walk up the delete path, as in rebalanceMedicationTree.
+static void rebalanceExpirationTree(ExpirationBPlusTree *tree, ExpirationInternalNode **path, int *pathIndices, int pathLen) {
+    int minKeys = (tree->order - 1) / 2;
+
+    while (pathLen > 0) {
+        ExpirationInternalNode *parent = path[pathLen - 1];
+        int childIndex = pathIndices[pathLen - 1];
+        ExpirationNode *node = parent->children[childIndex];
+        ExpirationNode *left = childIndex > 0 ? parent->children[childIndex - 1] : NULL;
+        ExpirationNode *right = childIndex < parent->cursize ? parent->children[childIndex + 1] : NULL;
+
+        // The pair that merges is always (left, node) or (node, right);
+        // the right one of the two is folded into the left one and freed
+        int separator = left ? childIndex - 1 : childIndex;
+        ExpirationNode *into = left ? left : node;
+        ExpirationNode *gone = left ? node : right;
+
+        if (node->isLeaf) {
+            ExpirationLeafNode *leaf = &(node->leaf);
+            if (leaf->cursize >= minKeys) return;
+
+            if (left && left->leaf.cursize > minKeys) {
+                ExpirationLeafNode *from = &(left->leaf);
+                from->cursize--;
+                memmove(&leaf->keys[1], &leaf->keys[0], leaf->cursize * sizeof(unsigned long long int));
+                memmove(&leaf->values[1], &leaf->values[0], leaf->cursize * sizeof(ExpirationIndexData));
+                leaf->keys[0] = from->keys[from->cursize];
+                leaf->values[0] = from->values[from->cursize];
+                leaf->cursize++;
+                parent->keys[childIndex - 1] = leaf->keys[0];
+                return;
+            }
+            if (right && right->leaf.cursize > minKeys) {
+                ExpirationLeafNode *from = &(right->leaf);
+                leaf->keys[leaf->cursize] = from->keys[0];
+                leaf->values[leaf->cursize] = from->values[0];
+                leaf->cursize++;
+                from->cursize--;
+                memmove(&from->keys[0], &from->keys[1], from->cursize * sizeof(unsigned long long int));
+                memmove(&from->values[0], &from->values[1], from->cursize * sizeof(ExpirationIndexData));
+                parent->keys[childIndex] = from->keys[0];
+                return;
+            }
+
+            ExpirationLeafNode *to = &(into->leaf);
+            ExpirationLeafNode *from = &(gone->leaf);
+            memcpy(&to->keys[to->cursize], from->keys, from->cursize * sizeof(unsigned long long int));
+            memcpy(&to->values[to->cursize], from->values, from->cursize * sizeof(ExpirationIndexData));
+            to->cursize += from->cursize;
+            to->next = from->next;
+            if (from->next) from->next->prev = to;
+            poolFree(&tree->leafNodes, gone);
+        } else {
+            ExpirationInternalNode *internal = &(node->internal);
+            if (internal->cursize >= minKeys) return;
+
+            // Borrowing rotates a key through the parent and moves one child across
+            if (left && left->internal.cursize > minKeys) {
+                ExpirationInternalNode *from = &(left->internal);
+                memmove(&internal->keys[1], &internal->keys[0], internal->cursize * sizeof(unsigned long long int));
+                memmove(&internal->children[1], &internal->children[0], (internal->cursize + 1) * sizeof(ExpirationNode*));
+                internal->keys[0] = parent->keys[childIndex - 1];
+                internal->children[0] = from->children[from->cursize];
+                setExpirationParent(internal->children[0], internal);
+                internal->cursize++;
+                parent->keys[childIndex - 1] = from->keys[from->cursize - 1];
+                from->cursize--;
+                return;
+            }
+            if (right && right->internal.cursize > minKeys) {
+                ExpirationInternalNode *from = &(right->internal);
+                internal->keys[internal->cursize] = parent->keys[childIndex];
+                internal->children[internal->cursize + 1] = from->children[0];
+                setExpirationParent(from->children[0], internal);
+                internal->cursize++;
+                parent->keys[childIndex] = from->keys[0];
+                memmove(&from->keys[0], &from->keys[1], (from->cursize - 1) * sizeof(unsigned long long int));
+                memmove(&from->children[0], &from->children[1], from->cursize * sizeof(ExpirationNode*));
+                from->cursize--;
+                return;
+            }
+
+            // Merging pulls the separator down between the two halves
+            ExpirationInternalNode *to = &(into->internal);
+            ExpirationInternalNode *from = &(gone->internal);
+            to->keys[to->cursize] = parent->keys[separator];
+            memcpy(&to->keys[to->cursize + 1], from->keys, from->cursize * sizeof(unsigned long long int));
+            memcpy(&to->children[to->cursize + 1], from->children, (from->cursize + 1) * sizeof(ExpirationNode*));
+            for (int i = 0; i <= from->cursize; i++) {
+                setExpirationParent(from->children[i], to);
+            }
+            to->cursize += from->cursize + 1;
+            poolFree(&tree->internalNodes, gone);
+        }
+
+        // Drop the separator and the freed child from the parent
+        int tail = parent->cursize - separator - 1;
+        memmove(&parent->keys[separator], &parent->keys[separator + 1], tail * sizeof(unsigned long long int));
+        memmove(&parent->children[separator + 1], &parent->children[separator + 2], tail * sizeof(ExpirationNode*));
+        parent->cursize--;
+        pathLen--;
+
+        // A root left with one child hands the tree to that child
+        if (pathLen == 0 && parent->cursize == 0) {
+            tree->root = parent->children[0];
+            setExpirationParent(tree->root, NULL);
+            poolFree(&tree->internalNodes, NODE_FROM_MEMBER(parent, ExpirationNode));
+        }
+    }
+}
+
+// Removes one medication's entry.
+void deleteFromExpirationTree(ExpirationBPlusTree* tree, unsigned long long int expirationKey) {
+    if (!tree || !tree->root) return;
+
+    ExpirationInternalNode* path[256]; // Assumes tree height < 256
+    int pathIndices[256];
+    int pathLen = 0;
+
+    ExpirationNode* current = tree->root;
+    while (!current->isLeaf) {
+        ExpirationInternalNode* internal = &(current->internal);
+        int i = upperBoundExpiryKey(internal->keys, internal->cursize, expirationKey);
+        path[pathLen] = internal;
+        pathIndices[pathLen] = i;
+        pathLen++;
+        current = internal->children[i];
+    }
+
+    ExpirationLeafNode* leaf = &(current->leaf);
+    int pos = lowerBoundExpiryKey(leaf->keys, leaf->cursize, expirationKey);
+    if (pos == leaf->cursize || leaf->keys[pos] != expirationKey) return;
+
+    memmove(&leaf->keys[pos], &leaf->keys[pos + 1], (leaf->cursize - pos - 1) * sizeof(unsigned long long int));
+    memmove(&leaf->values[pos], &leaf->values[pos + 1], (leaf->cursize - pos - 1) * sizeof(ExpirationIndexData));
+    leaf->cursize--;
+
+    if (pathLen == 0) {
+        if (leaf->cursize == 0) {
+            poolFree(&tree->leafNodes, tree->root);
+            tree->root = NULL;
+            tree->leftmost_leaf = NULL;
+        }
+        return;
+    }
+    rebalanceExpirationTree(tree, path, pathIndices, pathLen);
+}
+
+// Updates the medicine name stored with a medication's expiration entry.
+void renameExpirationEntry(ExpirationBPlusTree* tree, unsigned long long int expirationKey, const char* medicineName) {
+    if (!tree || !tree->root) return;
+
+    ExpirationLeafNode* leaf = &(findLeafNodeForExpiry(tree, expirationKey)->leaf);
+    int pos = lowerBoundExpiryKey(leaf->keys, leaf->cursize, expirationKey);
+    if (pos < leaf->cursize && leaf->keys[pos] == expirationKey) {
+        strcpy(leaf->values[pos].medicineName, medicineName);
+    }
+}
+
 //=========================================================================================
 
 void printUniqueSuppliers(UniqueSupplierBPlusTree* tree) {
@@ -691,79 +1580,349 @@ bool checkUniqueSupplier(unsigned long id) {
     
     UniqueSupplierLeafNode* leaf = &(leaf2->leaf);
 
-    for (int i = 0; i < leaf->cursize; i++) {
-        if (leaf->keys[i] == id) {
-            return false; 
-        }
-    }
-    return true; 
+    return findKeyIndex(leaf->keys, leaf->cursize, id) == -1;
 }
 
-UniqueSupplierBPlusTree* createUniqueSupplierBPlusTree(int order) {
-    UniqueSupplierBPlusTree* tree = (UniqueSupplierBPlusTree*)malloc(sizeof(UniqueSupplierBPlusTree));
-    if (!tree) return NULL;
+//==============================================================================
+// Supplier rankings: (total, supplier ID) pairs ordered by total, largest
+// first, ties to the lower ID. The unique supplier tree keeps one ranking by
+// turnover and one by medicine count, moving a supplier in both whenever its
+// totals change, so the top k suppliers are the first k entries of the chain.
+
+static int compareRankKey(const RankKey *a, const RankKey *b) {
+    if (a->total != b->total) return (a->total < b->total) - (a->total > b->total);
+    return (a->id > b->id) - (a->id < b->id);
+}
 
-    tree->order = order;
-    tree->root = NULL;
-    tree->leftmost_leaf = NULL;
-    return tree;
+void rankingInit(SupplierRanking *ranking, int order) {
+    ranking->root = NULL;
+    ranking->order = order;
+    ranking->leftmost_leaf = NULL;
+    poolInit(&ranking->leafNodes, sizeof(RankingNode) + order * sizeof(RankKey));
+    poolInit(&ranking->internalNodes, sizeof(RankingNode) + order * sizeof(RankKey) + (order + 1) * sizeof(RankingNode*));
+}
+
+void rankingDestroy(SupplierRanking *ranking) {
+    poolDestroy(&ranking->leafNodes);
+    poolDestroy(&ranking->internalNodes);
+    ranking->root = NULL;
+    ranking->leftmost_leaf = NULL;
 }
 
-UniqueSupplierNode* createUniqueSupplierNode(int order, bool isLeaf) {
-    UniqueSupplierNode* node = (UniqueSupplierNode*)malloc(sizeof(UniqueSupplierNode));
+static RankingNode* createRankingNode(SupplierRanking *ranking, bool isLeaf) {
+    int order = ranking->order;
+    RankingNode *node = (RankingNode*)poolAlloc(isLeaf ? &ranking->leafNodes : &ranking->internalNodes);
     if (!node) return NULL;
 
     node->isLeaf = isLeaf;
-
     if (isLeaf) {
-        node->leaf.keys = (unsigned long*)malloc(sizeof(unsigned long) * order);
-        node->leaf.values = (UniqueSupplierData*)malloc(sizeof(UniqueSupplierData) * order);
+        node->leaf.keys = (RankKey*)(node + 1);
         node->leaf.order = order;
         node->leaf.cursize = 0;
         node->leaf.next = NULL;
         node->leaf.prev = NULL;
         node->leaf.parent = NULL;
     } else {
-        node->internal.keys = (unsigned long*)malloc(sizeof(unsigned long) * order);
-        node->internal.children = (UniqueSupplierNode**)malloc(sizeof(UniqueSupplierNode*) * (order + 1));
+        node->internal.keys = (RankKey*)(node + 1);
+        node->internal.children = (RankingNode**)(node->internal.keys + order);
         node->internal.order = order;
         node->internal.cursize = 0;
         node->internal.parent = NULL;
     }
-
     return node;
 }
-bool insertIntoUniqueSupplierLeaf(UniqueSupplierLeafNode* leaf, unsigned long key, UniqueSupplierData data) {
-    if (!leaf ) return false;
 
-    // Find the position to insert
-    int pos = 0;
-    while (pos < (leaf)->cursize && (leaf)->keys[pos] < key) {
-        pos++;
+// Descends to the leaf that holds key, or where it would go.
+static RankingNode* findRankingLeaf(SupplierRanking *ranking, const RankKey *key) {
+    RankingNode *current = ranking->root;
+    while (current && !current->isLeaf) {
+        RankingInternalNode *node = &(current->internal);
+        int low = 0, high = node->cursize;
+        while (low < high) {
+            int mid = (low + high) / 2;
+            if (compareRankKey(key, &node->keys[mid]) >= 0) low = mid + 1;
+            else high = mid;
+        }
+        current = node->children[low];
     }
+    return current;
+}
 
-    // Shift existing keys and values
-    for (int i = (leaf)->cursize; i > pos; i--) {
-        (leaf)->keys[i] = (leaf)->keys[i - 1];
-        (leaf)->values[i] = (leaf)->values[i - 1];
+// First position in the leaf whose entry is >= key.
+static int rankingLowerBound(RankingLeafNode *leaf, const RankKey *key) {
+    int low = 0, high = leaf->cursize;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (compareRankKey(&leaf->keys[mid], key) < 0) low = mid + 1;
+        else high = mid;
     }
-
-    // Insert the new key and value
-    (leaf)->keys[pos] = key;
-    (leaf)->values[pos] = data;
-    (leaf)->cursize++;
-
-    return true;
+    return low;
 }
 
-UniqueSupplierNode* splitUniqueSupplierLeafNode(UniqueSupplierLeafNode *leaf, unsigned long *midKey) {
-    int median = leaf->order / 2;
-
-    // Create a new leaf node
-    UniqueSupplierNode* newNode = createUniqueSupplierNode(leaf->order, true);
-    UniqueSupplierLeafNode *newLeaf = &(newNode->leaf);
+static void insertIntoRankingParent(SupplierRanking *ranking, RankingNode *leftNode, const RankKey *midKey, RankingNode *rightNode) {
+    RankingInternalNode *parent = leftNode->isLeaf ? leftNode->leaf.parent : leftNode->internal.parent;
 
-    // Copy the second half of keys and values to the new leaf
+    if (!parent) {
+        RankingNode *newRoot = createRankingNode(ranking, false);
+        newRoot->internal.keys[0] = *midKey;
+        newRoot->internal.children[0] = leftNode;
+        newRoot->internal.children[1] = rightNode;
+        newRoot->internal.cursize = 1;
+        if (leftNode->isLeaf) {
+            leftNode->leaf.parent = &(newRoot->internal);
+            rightNode->leaf.parent = &(newRoot->internal);
+        } else {
+            leftNode->internal.parent = &(newRoot->internal);
+            rightNode->internal.parent = &(newRoot->internal);
+        }
+        ranking->root = newRoot;
+        return;
+    }
+
+    // Slot right after the left child
+    int pos = 0;
+    while (parent->children[pos] != leftNode) pos++;
+
+    memmove(&parent->keys[pos + 1], &parent->keys[pos], (parent->cursize - pos) * sizeof(RankKey));
+    memmove(&parent->children[pos + 2], &parent->children[pos + 1], (parent->cursize - pos) * sizeof(RankingNode*));
+    parent->keys[pos] = *midKey;
+    parent->children[pos + 1] = rightNode;
+    parent->cursize++;
+    if (rightNode->isLeaf) rightNode->leaf.parent = parent;
+    else rightNode->internal.parent = parent;
+
+    if (parent->cursize < parent->order) return;
+
+    // Parent overflowed: move the upper half to a new node and push the middle key up
+    RankingNode *parentNode = NODE_FROM_MEMBER(parent, RankingNode);
+    RankingNode *sibling = createRankingNode(ranking, false);
+    int mid = parent->cursize / 2;
+    RankKey upKey = parent->keys[mid];
+
+    int moved = parent->cursize - mid - 1;
+    memcpy(sibling->internal.keys, &parent->keys[mid + 1], moved * sizeof(RankKey));
+    memcpy(sibling->internal.children, &parent->children[mid + 1], (moved + 1) * sizeof(RankingNode*));
+    sibling->internal.cursize = moved;
+    parent->cursize = mid;
+
+    for (int i = 0; i <= moved; i++) {
+        RankingNode *child = sibling->internal.children[i];
+        if (child->isLeaf) child->leaf.parent = &(sibling->internal);
+        else child->internal.parent = &(sibling->internal);
+    }
+
+    insertIntoRankingParent(ranking, parentNode, &upKey, sibling);
+}
+
+void rankingInsert(SupplierRanking *ranking, RankKey key) {
+    if (!ranking->root) {
+        RankingNode *first = createRankingNode(ranking, true);
+        first->leaf.keys[0] = key;
+        first->leaf.cursize = 1;
+        ranking->root = first;
+        ranking->leftmost_leaf = &(first->leaf);
+        return;
+    }
+
+    RankingNode *leafNode = findRankingLeaf(ranking, &key);
+    RankingLeafNode *leaf = &(leafNode->leaf);
+    int pos = rankingLowerBound(leaf, &key);
+
+    memmove(&leaf->keys[pos + 1], &leaf->keys[pos], (leaf->cursize - pos) * sizeof(RankKey));
+    leaf->keys[pos] = key;
+    leaf->cursize++;
+
+    if (leaf->cursize < leaf->order) return;
+
+    // Leaf overflowed: split it in half and link the new leaf in after it
+    RankingNode *newLeaf = createRankingNode(ranking, true);
+    int mid = leaf->cursize / 2;
+    int moved = leaf->cursize - mid;
+    memcpy(newLeaf->leaf.keys, &leaf->keys[mid], moved * sizeof(RankKey));
+    newLeaf->leaf.cursize = moved;
+    leaf->cursize = mid;
+
+    newLeaf->leaf.next = leaf->next;
+    newLeaf->leaf.prev = leaf;
+    if (leaf->next) leaf->next->prev = &(newLeaf->leaf);
+    leaf->next = &(newLeaf->leaf);
+
+    insertIntoRankingParent(ranking, leafNode, &newLeaf->leaf.keys[0], newLeaf);
+}
+
+// Unlinks an empty child from its parent, collapsing parents that run out of
+// children, as the name index does.
+static void removeRankingChild(SupplierRanking *ranking, RankingInternalNode *parent, RankingNode *child) {
+    int pos = 0;
+    while (parent->children[pos] != child) pos++;
+
+    // Dropping child i removes the separator to its left (or right, for the first child)
+    int keyPos = (pos > 0) ? pos - 1 : 0;
+    memmove(&parent->keys[keyPos], &parent->keys[keyPos + 1], (parent->cursize - keyPos - 1) * sizeof(RankKey));
+    memmove(&parent->children[pos], &parent->children[pos + 1], (parent->cursize - pos) * sizeof(RankingNode*));
+    parent->cursize--;
+
+    if (parent->cursize > 0) return;
+    RankingNode *parentNode = NODE_FROM_MEMBER(parent, RankingNode);
+
+    // One child left: splice it into the grandparent's slot
+    RankingNode *only = parent->children[0];
+    RankingInternalNode *grandparent = parent->parent;
+    if (only->isLeaf) only->leaf.parent = grandparent;
+    else only->internal.parent = grandparent;
+
+    if (!grandparent) {
+        ranking->root = only;
+    } else {
+        int slot = 0;
+        while (grandparent->children[slot] != parentNode) slot++;
+        grandparent->children[slot] = only;
+    }
+    poolFree(&ranking->internalNodes, parentNode);
+}
+
+void rankingRemove(SupplierRanking *ranking, RankKey key) {
+    RankingNode *leafNode = findRankingLeaf(ranking, &key);
+    if (!leafNode) return;
+
+    RankingLeafNode *leaf = &(leafNode->leaf);
+    int pos = rankingLowerBound(leaf, &key);
+    if (pos == leaf->cursize || compareRankKey(&leaf->keys[pos], &key) != 0) return;
+
+    memmove(&leaf->keys[pos], &leaf->keys[pos + 1], (leaf->cursize - pos - 1) * sizeof(RankKey));
+    leaf->cursize--;
+    if (leaf->cursize > 0) return;
+
+    // Empty leaf: take it out of the chain and the tree
+    if (leaf->prev) leaf->prev->next = leaf->next;
+    else ranking->leftmost_leaf = leaf->next;
+    if (leaf->next) leaf->next->prev = leaf->prev;
+
+    if (leaf->parent) {
+        removeRankingChild(ranking, leaf->parent, leafNode);
+    } else {
+        ranking->root = NULL;
+    }
+    poolFree(&ranking->leafNodes, leafNode);
+}
+
+static void rankUniqueSupplier(UniqueSupplierBPlusTree *tree, const UniqueSupplierData *data) {
+    rankingInsert(&tree->byTurnover, (RankKey){ data->turnoverProduced, data->Supplier_ID });
+    rankingInsert(&tree->byMedicines, (RankKey){ data->noOfUniqueMedicines, data->Supplier_ID });
+}
+
+static void unrankUniqueSupplier(UniqueSupplierBPlusTree *tree, const UniqueSupplierData *data) {
+    rankingRemove(&tree->byTurnover, (RankKey){ data->turnoverProduced, data->Supplier_ID });
+    rankingRemove(&tree->byMedicines, (RankKey){ data->noOfUniqueMedicines, data->Supplier_ID });
+}
+
+// Sets the totals of a supplier held in the tree, moving it in both rankings.
+// Every change to noOfUniqueMedicines or turnoverProduced goes through here.
+void setUniqueSupplierTotals(UniqueSupplierBPlusTree *tree, UniqueSupplierData *data, unsigned int medicines, unsigned long turnover) {
+    unrankUniqueSupplier(tree, data);
+    data->noOfUniqueMedicines = medicines;
+    data->turnoverProduced = turnover;
+    rankUniqueSupplier(tree, data);
+}
+
+UniqueSupplierData* findUniqueSupplier(UniqueSupplierBPlusTree *tree, unsigned long supplierID) {
+    UniqueSupplierNode *leaf2 = findUniqueSupplierLeafNode(tree, supplierID);
+    int i = leaf2 ? findKeyIndex(leaf2->leaf.keys, leaf2->leaf.cursize, supplierID) : -1;
+    return (i == -1) ? NULL : &leaf2->leaf.values[i];
+}
+
+// Calls visit on the k suppliers ranked highest by turnover or by medicine
+// count, largest first, reading each in place from the tree: O(k log n).
+int topUniqueSuppliers(UniqueSupplierBPlusTree *tree, bool byTurnover, int k,
+                       void (*visit)(const UniqueSupplierData *supplier, void *context), void *context) {
+    const SupplierRanking *ranking = byTurnover ? &tree->byTurnover : &tree->byMedicines;
+    int found = 0;
+    for (RankingLeafNode *leaf = ranking->leftmost_leaf; leaf && found < k; leaf = leaf->next) {
+        for (int i = 0; i < leaf->cursize && found < k; i++) {
+            const UniqueSupplierData *supplier = findUniqueSupplier(tree, leaf->keys[i].id);
+            if (visit) visit(supplier, context);
+            found++;
+        }
+    }
+    return found;
+}
+
+UniqueSupplierBPlusTree* createUniqueSupplierBPlusTree(int order) {
+    UniqueSupplierBPlusTree* tree = (UniqueSupplierBPlusTree*)malloc(sizeof(UniqueSupplierBPlusTree));
+    if (!tree) return NULL;
+
+    tree->order = order;
+    tree->root = NULL;
+    tree->leftmost_leaf = NULL;
+    poolInit(&tree->leafNodes, sizeof(UniqueSupplierNode) + order * (sizeof(unsigned long) + sizeof(UniqueSupplierData)));
+    poolInit(&tree->internalNodes, sizeof(UniqueSupplierNode) + order * sizeof(unsigned long) + (order + 1) * sizeof(UniqueSupplierNode*));
+    rankingInit(&tree->byTurnover, order);
+    rankingInit(&tree->byMedicines, order);
+    return tree;
+}
+
+void destroyUniqueSupplierBPlusTree(UniqueSupplierBPlusTree* tree) {
+    if (!tree) return;
+    poolDestroy(&tree->leafNodes);
+    poolDestroy(&tree->internalNodes);
+    rankingDestroy(&tree->byTurnover);
+    rankingDestroy(&tree->byMedicines);
+    free(tree);
+}
+
+UniqueSupplierNode* createUniqueSupplierNode(UniqueSupplierBPlusTree* tree, bool isLeaf) {
+    int order = tree->order;
+    UniqueSupplierNode* node = (UniqueSupplierNode*)poolAlloc(isLeaf ? &tree->leafNodes : &tree->internalNodes);
+    if (!node) return NULL;
+
+    node->isLeaf = isLeaf;
+
+    if (isLeaf) {
+        node->leaf.keys = (unsigned long*)(node + 1);
+        node->leaf.values = (UniqueSupplierData*)(node->leaf.keys + order);
+        node->leaf.order = order;
+        node->leaf.cursize = 0;
+        node->leaf.next = NULL;
+        node->leaf.prev = NULL;
+        node->leaf.parent = NULL;
+    } else {
+        node->internal.keys = (unsigned long*)(node + 1);
+        node->internal.children = (UniqueSupplierNode**)(node->internal.keys + order);
+        node->internal.order = order;
+        node->internal.cursize = 0;
+        node->internal.parent = NULL;
+    }
+
+    return node;
+}
+bool insertIntoUniqueSupplierLeaf(UniqueSupplierLeafNode* leaf, unsigned long key, UniqueSupplierData data) {
+    if (!leaf ) return false;
+
+    // Find the position to insert
+    int pos = lowerBoundKey(leaf->keys, leaf->cursize, key);
+
+    // Shift existing keys and values
+    for (int i = (leaf)->cursize; i > pos; i--) {
+        (leaf)->keys[i] = (leaf)->keys[i - 1];
+        (leaf)->values[i] = (leaf)->values[i - 1];
+    }
+
+    // Insert the new key and value
+    (leaf)->keys[pos] = key;
+    (leaf)->values[pos] = data;
+    (leaf)->cursize++;
+
+    return true;
+}
+
+UniqueSupplierNode* splitUniqueSupplierLeafNode(UniqueSupplierBPlusTree* tree, UniqueSupplierLeafNode *leaf, unsigned long *midKey) {
+    int median = leaf->order / 2;
+
+    // Create a new leaf node
+    UniqueSupplierNode* newNode = createUniqueSupplierNode(tree, true);
+    UniqueSupplierLeafNode *newLeaf = &(newNode->leaf);
+
+    // Copy the second half of keys and values to the new leaf
     for (int i = median; i < leaf->cursize; i++) {
         newLeaf->keys[i - median] = leaf->keys[i];
         newLeaf->values[i - median] = leaf->values[i];
@@ -790,12 +1949,12 @@ UniqueSupplierNode* splitUniqueSupplierLeafNode(UniqueSupplierLeafNode *leaf, un
     return newNode;
 }
 
-UniqueSupplierNode* splitUniqueSupplierInternalNode(UniqueSupplierInternalNode* node, unsigned long* midKey) {
+UniqueSupplierNode* splitUniqueSupplierInternalNode(UniqueSupplierBPlusTree* tree, UniqueSupplierInternalNode* node, unsigned long* midKey) {
     int median = node->order / 2;
     *midKey = node->keys[median];
 
     // Create a new internal node
-    UniqueSupplierNode* newNode = createUniqueSupplierNode(node->order, false);
+    UniqueSupplierNode* newNode = createUniqueSupplierNode(tree, false);
     UniqueSupplierInternalNode* newInternal = &(newNode->internal);
 
     for (int i = median + 1; i < node->cursize; i++) {
@@ -831,7 +1990,7 @@ void insertIntoUniqueSupplierParent(UniqueSupplierBPlusTree* tree, UniqueSupplie
     if ((leftNode->isLeaf && !leftNode->leaf.parent) || (!leftNode->isLeaf && !leftNode->internal.parent)) {
         // printf("[DEBUG] Creating a new root for the UniqueSupplierBPlusTree.\n");
 
-        UniqueSupplierNode* newRoot = createUniqueSupplierNode(tree->order, false);
+        UniqueSupplierNode* newRoot = createUniqueSupplierNode(tree, false);
         if (!newRoot) {
             printf("[ERROR] Memory allocation failed for new root.\n");
             return;
@@ -866,75 +2025,31 @@ void insertIntoUniqueSupplierParent(UniqueSupplierBPlusTree* tree, UniqueSupplie
         parent = leftNode->internal.parent;
     }
 
-    UniqueSupplierNode parentNode;
-    parentNode.isLeaf = false;
-    parentNode.internal = *parent;
-
-    if (parent->cursize < parent->order - 1) {
-        int i = parent->cursize - 1;
-        while (i >= 0 && parent->keys[i] > midKey) {
-            parent->keys[i + 1] = parent->keys[i];
-            parent->children[i + 2] = parent->children[i + 1];
-            i--;
-        }
-
-        parent->keys[i + 1] = midKey;
-        parent->children[i + 2] = rightNode;
-        parent->cursize++;
-
-        if (rightNode->isLeaf) {
-            rightNode->leaf.parent = parent;
-        } else {
-            rightNode->internal.parent = parent;
-        }
-        return;
+    // Insert the new key and child into parent, then split it if that overflowed
+    int i = parent->cursize - 1;
+    while (i >= 0 && parent->keys[i] > midKey) {
+        parent->keys[i + 1] = parent->keys[i];
+        parent->children[i + 2] = parent->children[i + 1];
+        i--;
     }
 
-    unsigned long newMidKey;
-    UniqueSupplierNode* newParentNode = splitUniqueSupplierInternalNode(parent, &newMidKey);
-
-    if (midKey > newMidKey) {
-        UniqueSupplierInternalNode* rightParent = &(newParentNode->internal);
-        int i = rightParent->cursize - 1;
-        while (i >= 0 && rightParent->keys[i] > midKey) {
-            rightParent->keys[i + 1] = rightParent->keys[i];
-            rightParent->children[i + 2] = rightParent->children[i + 1];
-            i--;
-        }
-
-        rightParent->keys[i + 1] = midKey;
-        rightParent->children[i + 2] = rightNode;
-        rightParent->cursize++;
+    parent->keys[i + 1] = midKey;
+    parent->children[i + 2] = rightNode;
+    parent->cursize++;
 
-        if (rightNode->isLeaf) {
-            rightNode->leaf.parent = rightParent;
-        } else {
-            rightNode->internal.parent = rightParent;
-        }
+    if (rightNode->isLeaf) {
+        rightNode->leaf.parent = parent;
     } else {
-        int i = parent->cursize - 1;
-        while (i >= 0 && parent->keys[i] > midKey) {
-            parent->keys[i + 1] = parent->keys[i];
-            parent->children[i + 2] = parent->children[i + 1];
-            i--;
-        }
-
-        parent->keys[i + 1] = midKey;
-        parent->children[i + 2] = rightNode;
-        parent->cursize++;
-
-        if (rightNode->isLeaf) {
-            rightNode->leaf.parent = parent;
-        } else {
-            rightNode->internal.parent = parent;
-        }
+        rightNode->internal.parent = parent;
     }
 
-    UniqueSupplierNode* parentContainer2 = (UniqueSupplierNode*)malloc(sizeof(UniqueSupplierNode));
-    parentContainer2->isLeaf = false;
-    parentContainer2->internal = *parent;
+    if (parent->cursize < parent->order) {
+        return;
+    }
 
-    insertIntoUniqueSupplierParent(tree, parentContainer2, newMidKey, newParentNode);
+    unsigned long newMidKey;
+    UniqueSupplierNode *newParentNode = splitUniqueSupplierInternalNode(tree, parent, &newMidKey);
+    insertIntoUniqueSupplierParent(tree, NODE_FROM_MEMBER(parent, UniqueSupplierNode), newMidKey, newParentNode);
 }
 
 UniqueSupplierNode* findUniqueSupplierLeafNode(UniqueSupplierBPlusTree* tree, unsigned long supplierID) {
@@ -944,10 +2059,7 @@ UniqueSupplierNode* findUniqueSupplierLeafNode(UniqueSupplierBPlusTree* tree, un
 
     // Traverse down to the leaf node
     while (!current->isLeaf) {
-        int i;
-        for (i = 0; i < current->internal.cursize; i++) {
-            if (supplierID < current->internal.keys[i]) break;
-        }
+        int i = upperBoundKey(current->internal.keys, current->internal.cursize, supplierID);
         current = current->internal.children[i];
     }
 
@@ -968,7 +2080,7 @@ bool insertUniqueSupplier(UniqueSupplierBPlusTree* tree, unsigned long supplierI
 
 
     if (!tree->root) {
-        UniqueSupplierNode *firstNode = createUniqueSupplierNode(tree->order, true);
+        UniqueSupplierNode *firstNode = createUniqueSupplierNode(tree, true);
         
         // Insert the key and value
         firstNode->leaf.keys[0] = id;
@@ -977,6 +2089,7 @@ bool insertUniqueSupplier(UniqueSupplierBPlusTree* tree, unsigned long supplierI
 
         tree->root = firstNode;
         tree->leftmost_leaf = &(firstNode->leaf);
+        rankUniqueSupplier(tree, &data);
         return true;
     }
     
@@ -986,21 +2099,21 @@ bool insertUniqueSupplier(UniqueSupplierBPlusTree* tree, unsigned long supplierI
     if (!leaf) return false;
 
 
-    for (int i = 0; i < leaf->cursize; i++) {
-        if (leaf->keys[i] == id) {
-            leaf->values[i].noOfUniqueMedicines += 1;
-            leaf->values[i].turnoverProduced += turnover;
-            return true;
-        }
+    int existing = findKeyIndex(leaf->keys, leaf->cursize, id);
+    if (existing != -1) {
+        UniqueSupplierData *held = &leaf->values[existing];
+        setUniqueSupplierTotals(tree, held, held->noOfUniqueMedicines + 1, held->turnoverProduced + turnover);
+        return true;
     }
 
     if (leaf->cursize < leaf->order - 1) {
         bool result = insertIntoUniqueSupplierLeaf(leaf, id, data);
+        if (result) rankUniqueSupplier(tree, &data);
         return result;
     }
 
     unsigned long midKey;
-    UniqueSupplierNode* newLeafNode = splitUniqueSupplierLeafNode(leaf, &midKey);
+    UniqueSupplierNode* newLeafNode = splitUniqueSupplierLeafNode(tree, leaf, &midKey);
     if(!newLeafNode) return false;
 
     if(id >= midKey) {
@@ -1014,45 +2127,169 @@ bool insertUniqueSupplier(UniqueSupplierBPlusTree* tree, unsigned long supplierI
     }
 
     insertIntoUniqueSupplierParent(tree, leaf2, midKey, newLeafNode);
+    rankUniqueSupplier(tree, &data);
     return true;
 }
 
 
+static inline void setUniqueSupplierParent(UniqueSupplierNode *node, UniqueSupplierInternalNode *parent) {
+    if (node->isLeaf) node->leaf.parent = parent;
+    else node->internal.parent = parent;
+}
+
+// Borrow-or-merge walk up the delete path, as in rebalanceMedicationTree.
+static void rebalanceUniqueSupplierTree(UniqueSupplierBPlusTree *tree, UniqueSupplierInternalNode **path, int *pathIndices, int pathLen) {
+    int minKeys = (tree->order - 1) / 2;
+
+    while (pathLen > 0) {
+        UniqueSupplierInternalNode *parent = path[pathLen - 1];
+        int childIndex = pathIndices[pathLen - 1];
+        UniqueSupplierNode *node = parent->children[childIndex];
+        UniqueSupplierNode *left = childIndex > 0 ? parent->children[childIndex - 1] : NULL;
+        UniqueSupplierNode *right = childIndex < parent->cursize ? parent->children[childIndex + 1] : NULL;
+
+        // The pair that merges is always (left, node) or (node, right);
+        // the right one of the two is folded into the left one and freed
+        int separator = left ? childIndex - 1 : childIndex;
+        UniqueSupplierNode *into = left ? left : node;
+        UniqueSupplierNode *gone = left ? node : right;
+
+        if (node->isLeaf) {
+            UniqueSupplierLeafNode *leaf = &(node->leaf);
+            if (leaf->cursize >= minKeys) return;
+
+            if (left && left->leaf.cursize > minKeys) {
+                UniqueSupplierLeafNode *from = &(left->leaf);
+                from->cursize--;
+                memmove(&leaf->keys[1], &leaf->keys[0], leaf->cursize * sizeof(unsigned long));
+                memmove(&leaf->values[1], &leaf->values[0], leaf->cursize * sizeof(UniqueSupplierData));
+                leaf->keys[0] = from->keys[from->cursize];
+                leaf->values[0] = from->values[from->cursize];
+                leaf->cursize++;
+                parent->keys[childIndex - 1] = leaf->keys[0];
+                return;
+            }
+            if (right && right->leaf.cursize > minKeys) {
+                UniqueSupplierLeafNode *from = &(right->leaf);
+                leaf->keys[leaf->cursize] = from->keys[0];
+                leaf->values[leaf->cursize] = from->values[0];
+                leaf->cursize++;
+                from->cursize--;
+                memmove(&from->keys[0], &from->keys[1], from->cursize * sizeof(unsigned long));
+                memmove(&from->values[0], &from->values[1], from->cursize * sizeof(UniqueSupplierData));
+                parent->keys[childIndex] = from->keys[0];
+                return;
+            }
+
+            UniqueSupplierLeafNode *to = &(into->leaf);
+            UniqueSupplierLeafNode *from = &(gone->leaf);
+            memcpy(&to->keys[to->cursize], from->keys, from->cursize * sizeof(unsigned long));
+            memcpy(&to->values[to->cursize], from->values, from->cursize * sizeof(UniqueSupplierData));
+            to->cursize += from->cursize;
+            to->next = from->next;
+            if (from->next) from->next->prev = to;
+            poolFree(&tree->leafNodes, gone);
+        } else {
+            UniqueSupplierInternalNode *internal = &(node->internal);
+            if (internal->cursize >= minKeys) return;
+
+            // Borrowing rotates a key through the parent and moves one child across
+            if (left && left->internal.cursize > minKeys) {
+                UniqueSupplierInternalNode *from = &(left->internal);
+                memmove(&internal->keys[1], &internal->keys[0], internal->cursize * sizeof(unsigned long));
+                memmove(&internal->children[1], &internal->children[0], (internal->cursize + 1) * sizeof(UniqueSupplierNode*));
+                internal->keys[0] = parent->keys[childIndex - 1];
+                internal->children[0] = from->children[from->cursize];
+                setUniqueSupplierParent(internal->children[0], internal);
+                internal->cursize++;
+                parent->keys[childIndex - 1] = from->keys[from->cursize - 1];
+                from->cursize--;
+                return;
+            }
+            if (right && right->internal.cursize > minKeys) {
+                UniqueSupplierInternalNode *from = &(right->internal);
+                internal->keys[internal->cursize] = parent->keys[childIndex];
+                internal->children[internal->cursize + 1] = from->children[0];
+                setUniqueSupplierParent(from->children[0], internal);
+                internal->cursize++;
+                parent->keys[childIndex] = from->keys[0];
+                memmove(&from->keys[0], &from->keys[1], (from->cursize - 1) * sizeof(unsigned long));
+                memmove(&from->children[0], &from->children[1], from->cursize * sizeof(UniqueSupplierNode*));
+                from->cursize--;
+                return;
+            }
+
+            // Merging pulls the separator down between the two halves
+            UniqueSupplierInternalNode *to = &(into->internal);
+            UniqueSupplierInternalNode *from = &(gone->internal);
+            to->keys[to->cursize] = parent->keys[separator];
+            memcpy(&to->keys[to->cursize + 1], from->keys, from->cursize * sizeof(unsigned long));
+            memcpy(&to->children[to->cursize + 1], from->children, (from->cursize + 1) * sizeof(UniqueSupplierNode*));
+            for (int i = 0; i <= from->cursize; i++) {
+                setUniqueSupplierParent(from->children[i], to);
+            }
+            to->cursize += from->cursize + 1;
+            poolFree(&tree->internalNodes, gone);
+        }
+
+        // Drop the separator and the freed child from the parent
+        int tail = parent->cursize - separator - 1;
+        memmove(&parent->keys[separator], &parent->keys[separator + 1], tail * sizeof(unsigned long));
+        memmove(&parent->children[separator + 1], &parent->children[separator + 2], tail * sizeof(UniqueSupplierNode*));
+        parent->cursize--;
+        pathLen--;
+
+        // A root left with one child hands the tree to that child
+        if (pathLen == 0 && parent->cursize == 0) {
+            tree->root = parent->children[0];
+            setUniqueSupplierParent(tree->root, NULL);
+            poolFree(&tree->internalNodes, NODE_FROM_MEMBER(parent, UniqueSupplierNode));
+        }
+    }
+}
+
 // Function to delete a supplier from the UniqueSupplierBPlusTree
 void deleteUniqueSupplier(UniqueSupplierBPlusTree* tree, unsigned long supplierID) {
     if (!tree || !tree->root) return;
 
-    // Find the appropriate leaf node
-    UniqueSupplierNode* leaf2 = findUniqueSupplierLeafNode(tree, supplierID);
-    UniqueSupplierLeafNode* leaf = &(leaf2->leaf);
-    if (!leaf) return;
+    UniqueSupplierInternalNode* path[256]; // Assumes tree height < 256
+    int pathIndices[256];
+    int pathLen = 0;
 
-    // Find the supplier in the leaf node
-    int pos = -1;
-    for (int i = 0; i < leaf->cursize; i++) {
-        if (leaf->keys[i] == supplierID) {
-            pos = i;
-            break;
-        }
+    // Find the appropriate leaf node, remembering the way down
+    UniqueSupplierNode* current = tree->root;
+    while (!current->isLeaf) {
+        UniqueSupplierInternalNode* internal = &(current->internal);
+        int i = upperBoundKey(internal->keys, internal->cursize, supplierID);
+        path[pathLen] = internal;
+        pathIndices[pathLen] = i;
+        pathLen++;
+        current = internal->children[i];
     }
+    UniqueSupplierLeafNode* leaf = &(current->leaf);
+
+    // Find the supplier in the leaf node
+    int pos = findKeyIndex(leaf->keys, leaf->cursize, supplierID);
 
     if (pos == -1) return; // Supplier not found
+    unrankUniqueSupplier(tree, &leaf->values[pos]);
 
     // Shift keys and values to remove the supplier
-    for (int i = pos; i < leaf->cursize - 1; i++) {
-        leaf->keys[i] = leaf->keys[i + 1];
-        leaf->values[i] = leaf->values[i + 1];
-    }
+    int tail = leaf->cursize - pos - 1;
+    memmove(&leaf->keys[pos], &leaf->keys[pos + 1], tail * sizeof(unsigned long));
+    memmove(&leaf->values[pos], &leaf->values[pos + 1], tail * sizeof(UniqueSupplierData));
     leaf->cursize--;
 
     // If the leaf is empty and is the root, free the root
-    if (leaf->cursize == 0 && leaf->parent == NULL) {
-        free(leaf->keys);
-        free(leaf->values);
-        free(tree->root);
-        tree->root = NULL;
-        tree->leftmost_leaf = NULL;
+    if (pathLen == 0) {
+        if (leaf->cursize == 0) {
+            poolFree(&tree->leafNodes, tree->root);
+            tree->root = NULL;
+            tree->leftmost_leaf = NULL;
+        }
+        return;
     }
+    rebalanceUniqueSupplierTree(tree, path, pathIndices, pathLen);
 }
 
 void updateUniqueSupplierTreeAfterInsert(unsigned long supplierID, const char *supplierName, unsigned int quantity, unsigned long turnover) {
@@ -1063,6 +2300,7 @@ void updateUniqueSupplierTreeAfterInsert(unsigned long supplierID, const char *s
 
     // Insert or update the unique supplier in the tree
     insertUniqueSupplier(uniqueSupplierTree, supplierID, supplierName, 1, turnover);
+    walLogUniqueSupplier(supplierID);
 }
 
 // Function to update the UniqueSupplierBPlusTree after deleting a supplier
@@ -1074,22 +2312,21 @@ void updateUniqueSupplierTreeAfterDelete(unsigned long supplierID, unsigned int
 
     // Find the supplier in the unique supplier tree
     UniqueSupplierNode *leaf2 = findUniqueSupplierLeafNode(uniqueSupplierTree, supplierID);
+    if (!leaf2) return;
     UniqueSupplierLeafNode *leaf = &(leaf2->leaf);
-    if (!leaf) return;
 
-    for (int i = 0; i < leaf->cursize; i++) {
-        if (leaf->keys[i] == supplierID) {
-            // Decrease the turnover and unique medicine count
-            leaf->values[i].turnoverProduced -= turnover;
-            leaf->values[i].noOfUniqueMedicines--;
+    int i = findKeyIndex(leaf->keys, leaf->cursize, supplierID);
+    if (i == -1) return;
 
-            // If the supplier no longer supplies any medicines, remove it from the tree
-            if (leaf->values[i].noOfUniqueMedicines == 0) {
-                deleteUniqueSupplier(uniqueSupplierTree, supplierID);
-            }
-            return;
-        }
+    // Decrease the turnover and unique medicine count; if the supplier no
+    // longer supplies any medicines, remove it from the tree
+    UniqueSupplierData *held = &leaf->values[i];
+    if (held->noOfUniqueMedicines <= 1) {
+        deleteUniqueSupplier(uniqueSupplierTree, supplierID);
+    } else {
+        setUniqueSupplierTotals(uniqueSupplierTree, held, held->noOfUniqueMedicines - 1, held->turnoverProduced - turnover);
     }
+    walLogUniqueSupplier(supplierID);
 }
 
 
@@ -1125,18 +2362,20 @@ SupplierData initSupplier(SupplierBPlusTree *supplierTree, MedicationData *medic
     return supplier;
 }
 
-SupplierNode* createSupplierNode(int order, bool isLeaf) {
-    SupplierNode* node = (SupplierNode*)malloc(sizeof(SupplierNode));
+SupplierNode* createSupplierNode(SupplierBPlusTree *tree, bool isLeaf) {
+    int order = tree->order;
+    SupplierNode* node = (SupplierNode*)poolAlloc(isLeaf ? tree->leafNodes : tree->internalNodes);
     if (!node) {
         return NULL; // Memory allocation failed
     }
     
     node->isLeaf = isLeaf;
+    olcInit(&node->version);
     
     if (isLeaf) {
         // Leaf node setup
-        node->leaf.keys = (unsigned long*)malloc(sizeof(unsigned long) * (order - 1));
-        node->leaf.values = (SupplierData*)malloc(sizeof(SupplierData) * order);
+        node->leaf.values = (SupplierData*)(node + 1);
+        node->leaf.keys = (unsigned long*)(node->leaf.values + order);
         node->leaf.order = order;
         node->leaf.cursize = 0;
         node->leaf.next = NULL;
@@ -1144,8 +2383,8 @@ SupplierNode* createSupplierNode(int order, bool isLeaf) {
         node->leaf.parent = NULL;
     } else {
         // Internal node setup
-        node->internal.keys = (unsigned long*)malloc(sizeof(unsigned long) *( order -1));
-        node->internal.children = (SupplierNode**)malloc(sizeof(SupplierNode*) * (order));
+        node->internal.keys = (unsigned long*)(node + 1);
+        node->internal.children = (SupplierNode**)(node->internal.keys + order);
         node->internal.order = order;
         node->internal.cursize = 0;
         node->internal.parent = NULL;
@@ -1154,16 +2393,42 @@ SupplierNode* createSupplierNode(int order, bool isLeaf) {
     return node;
 }
 
-SupplierBPlusTree* createSupplierBPlusTree(int order) {
-    SupplierBPlusTree* tree = (SupplierBPlusTree*)malloc(sizeof(SupplierBPlusTree));
+// Supplier trees draw their nodes from pools owned by the medication tree,
+// so destroying the medication tree releases every supplier tree with it.
+SupplierBPlusTree* createSupplierBPlusTree(MedicationBPlusTree *owner) {
+    SupplierBPlusTree* tree = (SupplierBPlusTree*)poolAlloc(&owner->supplierTrees);
     if (!tree) return NULL;
 
-    tree->order = order;
+    olcInit(&tree->version);
+    tree->order = owner->order;
     tree->root = NULL;
     tree->leftmost_leaf = NULL;
+    tree->leafNodes = &owner->supplierLeafNodes;
+    tree->internalNodes = &owner->supplierInternalNodes;
+    tree->postings = NULL;
+    tree->medication = NULL;
     return tree;    
 }
 
+static void releaseSupplierNodes(SupplierBPlusTree *tree, SupplierNode *node) {
+    if (!node->isLeaf) {
+        for (int i = 0; i <= node->internal.cursize; i++) {
+            releaseSupplierNodes(tree, node->internal.children[i]);
+        }
+    }
+    olcMarkObsolete(&node->version);
+    poolFree(node->isLeaf ? tree->leafNodes : tree->internalNodes, node);
+}
+
+// Returns a single medication's supplier tree to the owner's pools.
+void releaseSupplierBPlusTree(MedicationBPlusTree *owner, SupplierBPlusTree *tree) {
+    if (!tree) return;
+    detachSupplierTree(tree);
+    olcMarkObsolete(&tree->version);
+    if (tree->root) releaseSupplierNodes(tree, tree->root);
+    poolFree(&owner->supplierTrees, tree);
+}
+
 bool checkSuppID(unsigned long id, SupplierBPlusTree *tree) {
     if (!tree || !tree->root) {
         return true; // ID doesn't exist in an empty tree
@@ -1172,20 +2437,12 @@ bool checkSuppID(unsigned long id, SupplierBPlusTree *tree) {
     SupplierNode *leaf2 = findSupplierLeafNode(tree, id);
     SupplierLeafNode *leaf = &(leaf2->leaf);
     
-    for (int i = 0; i < leaf->cursize; i++) {
-        if (leaf->keys[i] == id) {
-            return false; // ID already exists
-        }
-    }
-    
-    return true; // ID doesn't exist
+    // ID doesn't exist unless it is found in the leaf
+    return findKeyIndex(leaf->keys, leaf->cursize, id) == -1;
 }
 
 bool insertIntoSupplierLeaf(SupplierLeafNode *leaf, unsigned long key, SupplierData data) {
-    int pos = 0;
-    while (pos < leaf->cursize && leaf->keys[pos] < key) {
-        pos++;
-    }
+    int pos = lowerBoundKey(leaf->keys, leaf->cursize, key);
     
     // Check if key already exists
     if (pos < leaf->cursize && leaf->keys[pos] == key) {
@@ -1212,7 +2469,7 @@ void insertIntoSupplierParent(SupplierBPlusTree *tree, SupplierNode *leftNode, u
     // Case 1: leaf is the root (has no parent)
     if ((leftNode->isLeaf && !leftNode->leaf.parent) || (!leftNode->isLeaf && !leftNode->internal.parent)) {
         // Create a new root
-        SupplierNode* newRoot = createSupplierNode(tree->order, false);
+        SupplierNode* newRoot = createSupplierNode(tree, false);
         if (!newRoot) return;
         
         tree->root = newRoot;
@@ -1235,7 +2492,6 @@ void insertIntoSupplierParent(SupplierBPlusTree *tree, SupplierNode *leftNode, u
             rightNode->internal.parent = &(newRoot->internal);
         }
         
-        printf("Created new root with key: %lu\n", midKey);
         return;
     }
 
@@ -1247,105 +2503,80 @@ void insertIntoSupplierParent(SupplierBPlusTree *tree, SupplierNode *leftNode, u
         parent = leftNode->internal.parent;
     }
     
-    // Create a container node for the parent (for easier handling)
-    SupplierNode parentNode;
-    parentNode.isLeaf = false;
-    parentNode.internal = *parent;
-    
-    // Check if parent has space for a new key
-    if (parent->cursize < parent->order - 1) {
-        // Insert the new key and child into parent
-        int i = parent->cursize - 1;
-        while (i >= 0 && parent->keys[i] > midKey) {
-            parent->keys[i + 1] = parent->keys[i];
-            parent->children[i + 2] = parent->children[i + 1];
-            i--;
-        }
-        
-        parent->keys[i + 1] = midKey;
-        parent->children[i + 2] = rightNode;
-        parent->cursize++;
-        
-        // Update parent pointer of the right child
-        if (rightNode->isLeaf) {
-            rightNode->leaf.parent = parent;
-        } else {
-            rightNode->internal.parent = parent;
-        }
-        
-        printf("Inserted key %lu into existing parent\n", midKey);
-        return;
+    // Insert the new key and child into parent, then split it if that overflowed
+    int i = parent->cursize - 1;
+    while (i >= 0 && parent->keys[i] > midKey) {
+        parent->keys[i + 1] = parent->keys[i];
+        parent->children[i + 2] = parent->children[i + 1];
+        i--;
     }
-    
-    // Parent is full, need to split
-    unsigned long newMidKey;
-    SupplierNode *newParentNode = splitSupplierInternalNode(parent, &newMidKey);
-    
-    // Decide which parent node should contain our key
-    if (midKey > newMidKey) {
-        // Insert into right parent
-        SupplierInternalNode *rightParent = &(newParentNode->internal);
-        int i = rightParent->cursize - 1;
-        while (i >= 0 && rightParent->keys[i] > midKey) {
-            rightParent->keys[i + 1] = rightParent->keys[i];
-            rightParent->children[i + 2] = rightParent->children[i + 1];
-            i--;
-        }
-        
-        rightParent->keys[i + 1] = midKey;
-        rightParent->children[i + 2] = rightNode;
-        rightParent->cursize++;
-        
-        // Update parent pointer
-        if (rightNode->isLeaf) {
-            rightNode->leaf.parent = rightParent;
-        } else {
-            rightNode->internal.parent = rightParent;
-        }
+
+    parent->keys[i + 1] = midKey;
+    parent->children[i + 2] = rightNode;
+    parent->cursize++;
+
+    if (rightNode->isLeaf) {
+        rightNode->leaf.parent = parent;
     } else {
-        // Insert into original parent
-        int i = parent->cursize - 1;
-        while (i >= 0 && parent->keys[i] > midKey) {
-            parent->keys[i + 1] = parent->keys[i];
-            parent->children[i + 2] = parent->children[i + 1];
-            i--;
-        }
-        
-        parent->keys[i + 1] = midKey;
-        parent->children[i + 2] = rightNode;
-        parent->cursize++;
-        
-        // Update parent pointer
-        if (rightNode->isLeaf) {
-            rightNode->leaf.parent = parent;
-        } else {
-            rightNode->internal.parent = parent;
-        }
+        rightNode->internal.parent = parent;
     }
-    
-    // Now we need to insert the split parent into its parent
-    // Create a container node for the original parent (for recursive call)
-    SupplierNode *parentContainer = (SupplierNode*)malloc(sizeof(SupplierNode));
-    if (!parentContainer) return;
-    
-    parentContainer->isLeaf = false;
-    parentContainer->internal = *parent;
-    
-    // Recursive call to insert the split parent
-    insertIntoSupplierParent(tree, parentContainer, newMidKey, newParentNode);
+
+    if (parent->cursize < parent->order) {
+        return;
+    }
+
+    unsigned long newMidKey;
+    SupplierNode *newParentNode = splitSupplierInternalNode(tree, parent, &newMidKey);
+    insertIntoSupplierParent(tree, NODE_FROM_MEMBER(parent, SupplierNode), newMidKey, newParentNode);
 
 }
 
-bool insertSupplier(SupplierBPlusTree *tree, SupplierData data) {
-    if (!tree){ 
-        printf("Tree is NULL\n");
-        return false; // Tree is NULL
+#define SUPPLIER_MAX_HEIGHT 64
+
+// Supplier writers lock the root guard and every node on the way down rather
+// than working out which ones are safe (see "Concurrent access"). Returns the locked leaf, or NULL if the tree is empty.
+static SupplierNode* lockSupplierPath(SupplierBPlusTree *tree, unsigned long key, SupplierInternalNode **path, int *pathIndices, int *pathLen) {
+    olcWriteLock(&tree->version);
+    *pathLen = 0;
+    SupplierNode *node = tree->root;
+    if (!node) return NULL;
+    olcWriteLock(&node->version);
+
+    while (!node->isLeaf) {
+        int i = upperBoundKey(node->internal.keys, node->internal.cursize, key);
+        path[*pathLen] = &(node->internal);
+        pathIndices[*pathLen] = i;
+        (*pathLen)++;
+        node = node->internal.children[i];
+        olcWriteLock(&node->version);
+    }
+    return node;
+}
+
+// Unlocks what lockSupplierPath took, then frees the nodes that left the tree.
+static void unlockSupplierPath(SupplierBPlusTree *tree, SupplierInternalNode **path, int pathLen, SupplierNode *leaf, SupplierNode **retired, int retiredCount) {
+    if (leaf) olcWriteUnlock(&leaf->version);
+    for (int i = pathLen - 1; i >= 0; i--) {
+        olcWriteUnlock(&NODE_FROM_MEMBER(path[i], SupplierNode)->version);
     }
+    olcWriteUnlock(&tree->version);
+    for (int i = 0; i < retiredCount; i++) {
+        poolFree(retired[i]->isLeaf ? tree->leafNodes : tree->internalNodes, retired[i]);
+    }
+}
+
+static void retireSupplierNode(SupplierNode **retired, int *retiredCount, SupplierNode *node) {
+    olcMarkObsolete(&node->version);
+    retired[(*retiredCount)++] = node;
+}
+
+// The body of insertSupplier, run with the path to leaf2 locked (leaf2 is NULL for an empty tree).
+static bool insertSupplierLocked(SupplierBPlusTree *tree, SupplierData data, SupplierNode *leaf2) {
     unsigned long id = data.Supplier_ID;
     
     // If tree is empty, create the first leaf node
-    if (!tree->root) {
-        SupplierNode *firstNode = createSupplierNode(tree->order, true);
+    if (!leaf2) {
+        SupplierNode *firstNode = createSupplierNode(tree, true);
         
         // Insert the key and value
         firstNode->leaf.keys[0] = id;
@@ -1355,24 +2586,20 @@ bool insertSupplier(SupplierBPlusTree *tree, SupplierData data) {
         tree->root = firstNode;
         tree->leftmost_leaf = &(firstNode->leaf);
 
+        if (tree->postings) supplierPostingsInsert(tree->postings, id, tree->medication);
         return true;
     }
     
-    // Find the appropriate leaf node
-    SupplierNode *leaf2 = findSupplierLeafNode(tree, id);
     SupplierLeafNode *leaf = &(leaf2->leaf);
-    if (!leaf) return false;
-
-
-
-    for (int i = 0; i < leaf->cursize; i++) {
-        if (leaf->keys[i] == id) {
-            // Update existing value
-            leaf->values[i] = data;
-            return true;
-        }
+    int existing = findKeyIndex(leaf->keys, leaf->cursize, id);
+    if (existing != -1) {
+        // Update existing value
+        leaf->values[existing] = data;
+        return true;
     }
 
+    if (tree->postings) supplierPostingsInsert(tree->postings, id, tree->medication);
+
     // If leaf is not full, simply insert
     if (leaf->cursize < leaf->order - 1) {
         bool result = insertIntoSupplierLeaf(leaf, id, data);
@@ -1380,7 +2607,7 @@ bool insertSupplier(SupplierBPlusTree *tree, SupplierData data) {
     }
 
     unsigned long midKey;
-    SupplierNode *newLeafNode = splitSupplierLeafNode(leaf, &midKey);
+    SupplierNode *newLeafNode = splitSupplierLeafNode(tree, leaf, &midKey);
     if (!newLeafNode) return false;
 
     if (id >= midKey) {
@@ -1392,13 +2619,28 @@ bool insertSupplier(SupplierBPlusTree *tree, SupplierData data) {
     insertIntoSupplierParent(tree, leaf2, midKey, newLeafNode);  
     return true;
 }
+
+bool insertSupplier(SupplierBPlusTree *tree, SupplierData data) {
+    if (!tree){ 
+        printf("Tree is NULL\n");
+        return false; // Tree is NULL
+    }
+
+    SupplierInternalNode *path[SUPPLIER_MAX_HEIGHT];
+    int pathIndices[SUPPLIER_MAX_HEIGHT];
+    int pathLen;
+    SupplierNode *leafNode = lockSupplierPath(tree, data.Supplier_ID, path, pathIndices, &pathLen);
+    bool result = insertSupplierLocked(tree, data, leafNode);
+    unlockSupplierPath(tree, path, pathLen, leafNode, NULL, 0);
+    return result;
+}
  
-SupplierNode* splitSupplierInternalNode( SupplierInternalNode *node,unsigned long *midKey) {
+SupplierNode* splitSupplierInternalNode(SupplierBPlusTree *tree, SupplierInternalNode *node,unsigned long *midKey) {
     int median = node->order / 2;
     *midKey = node->keys[median];
     
     // Create a new internal node
-    SupplierNode *newNode = createSupplierNode(node->order, false);
+    SupplierNode *newNode = createSupplierNode(tree, false);
     SupplierInternalNode *newInternal = &(newNode->internal);
     
     // Copy the second half of keys and children to the new node
@@ -1432,11 +2674,11 @@ SupplierNode* splitSupplierInternalNode( SupplierInternalNode *node,unsigned lon
 
 }
 
-SupplierNode* splitSupplierLeafNode(SupplierLeafNode *leaf,unsigned long *midKey) {
+SupplierNode* splitSupplierLeafNode(SupplierBPlusTree *tree, SupplierLeafNode *leaf,unsigned long *midKey) {
     int median = leaf->order / 2;
     
     // Create a new leaf node
-    SupplierNode *newNode = createSupplierNode(leaf->order, true);
+    SupplierNode *newNode = createSupplierNode(tree, true);
 
     SupplierLeafNode *newLeaf = &(newNode->leaf);
     
@@ -1474,12 +2716,7 @@ SupplierNode* findSupplierLeafNode(SupplierBPlusTree *tree, unsigned long key) {
     
     // Traverse down to leaf node
     while (!current->isLeaf) {
-        int i;
-        for (i = 0; i < current->internal.cursize; i++) {
-            if (key < current->internal.keys[i]) {
-                break;
-            }
-        }
+        int i = upperBoundKey(current->internal.keys, current->internal.cursize, key);
         current = current->internal.children[i];
     }
     
@@ -1496,16 +2733,16 @@ bool CheckMedicIdExist(unsigned long newID, MedicationBPlusTree *tree) {
     MedicationNode *leaf2 = findLeafNode(tree, newID);
     MedicationLeafNode *leaf = &(leaf2->leaf);
     
-    for (int i = 0; i < leaf->cursize; i++) {
-        if (leaf->keys[i] == newID) {
-            return true; // ID already exists
-        }
-    }
-    
-    return false; // ID doesn't exist
+    return findKeyIndex(leaf->keys, leaf->cursize, newID) != -1;
+}
+
+// Expiration tree key for a medication.
+unsigned long long medicationExpirationKey(const MedicationData *medication) {
+    const ExpiryDate *date = &medication->Batch_details.Expiration_Date;
+    return makeExpirationKey(date->dayNumber, medication->Medication_ID);
 }
 
-MedicationData createMedicationData(int order, MedicationBPlusTree *tree) {
+MedicationData createMedicationData(MedicationBPlusTree *tree) {
     MedicationData newMed;
     unsigned long newID;
     
@@ -1539,17 +2776,19 @@ MedicationData createMedicationData(int order, MedicationBPlusTree *tree) {
 
     printf("Enter Expiration Date in DD-MM-YYYY \n");
     printf("Enter Day: ");
-    scanf("%d", &newMed.Batch_details.Expiration_Date.day);
+    int day, month, year;
+    scanf("%d", &day);
     printf("Enter Month: ");
-    scanf("%d", &newMed.Batch_details.Expiration_Date.month);
+    scanf("%d", &month);
     printf("Enter Year: ");
-    scanf("%d", &newMed.Batch_details.Expiration_Date.year);
+    scanf("%d", &year);
+    setExpiryDate(&newMed.Batch_details.Expiration_Date, day, month, year);
 
     // Initialize total sales
     newMed.Batch_details.Total_sales = 0;
     
     // Create a B+ tree for suppliers
-    newMed.Suppliers = createSupplierBPlusTree(order);
+    newMed.Suppliers = createSupplierBPlusTree(tree);
     
     int nS;
     printf("Enter the number of suppliers: ");
@@ -1561,26 +2800,25 @@ MedicationData createMedicationData(int order, MedicationBPlusTree *tree) {
         insertSupplier(newMed.Suppliers, suppl);
     }
 
-    unsigned long long int expirationKey = newMed.Batch_details.Expiration_Date.year * 10000 +
-    newMed.Batch_details.Expiration_Date.month * 100 +
-    newMed.Batch_details.Expiration_Date.day + 100000000*newID;
-
-    insertIntoExpirationTree(expirationTree, expirationKey, newMed.Medication_ID, newMed.Medicine_Name);
+    insertIntoExpirationTree(expirationTree, medicationExpirationKey(&newMed), newMed.Medication_ID, newMed.Medicine_Name);
 
     return newMed;
 }
 
-MedicationNode* createMedicationNode(int order, bool isLeaf) {
+MedicationNode* createMedicationNode(MedicationBPlusTree *tree, bool isLeaf) {
+    int order = tree->order;
 
-    MedicationNode* node = (MedicationNode*)malloc(sizeof(MedicationNode));
+    // Header, keys and handles/children all live in one pooled slot
+    MedicationNode* node = (MedicationNode*)poolAlloc(isLeaf ? &tree->leafNodes : &tree->internalNodes);
     if (!node) return NULL;
     
     node->isLeaf = isLeaf;
+    olcInit(&node->version);
     
     if (isLeaf) {
         // Leaf node setup
-        node->leaf.keys = (unsigned long*)malloc(sizeof(unsigned long) * order);
-        node->leaf.values = (MedicationData*)malloc(sizeof(MedicationData) * order);
+        node->leaf.keys = (unsigned long*)(node + 1);
+        node->leaf.values = (MedicationData**)(node->leaf.keys + order);
         node->leaf.order = order;
         node->leaf.cursize = 0;
         node->leaf.next = NULL;
@@ -1588,8 +2826,8 @@ MedicationNode* createMedicationNode(int order, bool isLeaf) {
         node->leaf.parent = NULL;
     } else {
         // Internal node setup
-        node->internal.keys = (unsigned long*)malloc(sizeof(unsigned long) * order);
-        node->internal.children = (MedicationNode**)malloc(sizeof(MedicationNode*) * (order + 1));
+        node->internal.keys = (unsigned long*)(node + 1);
+        node->internal.children = (MedicationNode**)(node->internal.keys + order);
         node->internal.order = order;
         node->internal.cursize = 0;
         node->internal.parent = NULL;
@@ -1605,54 +2843,322 @@ MedicationBPlusTree* createMedicationBPlusTree(int order) {
     tree->order = order;
     tree->root = NULL;
     tree->leftmost_leaf = NULL;
+
+    // Size classes derived from the order
+    poolInit(&tree->records, sizeof(MedicationData));
+    poolInit(&tree->leafNodes, sizeof(MedicationNode) + order * (sizeof(unsigned long) + sizeof(MedicationData*)));
+    poolInit(&tree->internalNodes, sizeof(MedicationNode) + order * sizeof(unsigned long) + (order + 1) * sizeof(MedicationNode*));
+    poolInit(&tree->supplierTrees, sizeof(SupplierBPlusTree));
+    poolInit(&tree->supplierLeafNodes, sizeof(SupplierNode) + order * sizeof(SupplierData) + (order - 1) * sizeof(unsigned long));
+    poolInit(&tree->supplierInternalNodes, sizeof(SupplierNode) + order * sizeof(unsigned long) + (order + 1) * sizeof(SupplierNode*));
+    nameIndexInit(&tree->names, order);
+    supplierPostingsInit(&tree->postings, order);
+    tree->lowStock.records = NULL;
+    tree->lowStock.count = 0;
+    tree->lowStock.capacity = 0;
+    tree->rootVersion = 0;
+    pthread_mutex_init(&tree->writer, NULL);
     return tree;
 }
 
+// Releases the tree, its records and every supplier tree by freeing the pool slabs.
+void destroyMedicationBPlusTree(MedicationBPlusTree *tree) {
+    if (!tree) return;
+    poolDestroy(&tree->records);
+    poolDestroy(&tree->leafNodes);
+    poolDestroy(&tree->internalNodes);
+    poolDestroy(&tree->supplierTrees);
+    poolDestroy(&tree->supplierLeafNodes);
+    poolDestroy(&tree->supplierInternalNodes);
+    nameIndexDestroy(&tree->names);
+    supplierPostingsDestroy(&tree->postings);
+    free(tree->lowStock.records);
+    pthread_mutex_destroy(&tree->writer);
+    free(tree);
+}
+
 MedicationNode* findLeafNode(MedicationBPlusTree *tree, unsigned long key) {
     if (!tree || !tree->root) {
         printf("Tree is empty.\n");
         return NULL;
     }
     
+    STAT_TIMER_START(find);
     MedicationNode *current = tree->root;
     
     // Traverse down to leaf node
     while (!current->isLeaf) {
-        int i;
-        for (i = 0; i < current->internal.cursize; i++) {
-            if (key < current->internal.keys[i]) {
-                break;
-            }
-        }
+        STAT_ADD(STAT_NODE_VISITS, 1);
+        int i = upperBoundKey(current->internal.keys, current->internal.cursize, key);
         current = current->internal.children[i];
     }
+    STAT_ADD(STAT_NODE_VISITS, 1);
+    STAT_TIMER_STOP(find, STAT_FIND_LEAF);
     
     return current;
 }
 
-bool insertIntoLeaf(MedicationLeafNode *leaf, unsigned long key, MedicationData data) {
-    // Find position to insert
-    int pos = 0;
-    while (pos < leaf->cursize && leaf->keys[pos] < key) {
-        pos++;
+// Returns the stored record for id, or NULL if it is not in the tree.
+MedicationData* findMedication(MedicationBPlusTree *tree, unsigned long id) {
+    if (!tree || !tree->root) return NULL;
+
+    MedicationNode *leafNode = findLeafNode(tree, id);
+    MedicationLeafNode *leaf = &(leafNode->leaf);
+
+    int i = findKeyIndex(leaf->keys, leaf->cursize, id);
+    return (i == -1) ? NULL : leaf->values[i];
+}
+
+//==============================================================================
+// Concurrent access
+//
+// lookupMedication and lookupSupplier may run on any number of threads while
+// insertMedication, deleteMedicationByID, sellMedication and sellBasket
+// change the tree. Those writers take tree->writer, so they run one at a
+// time; the supplier writers (insertSupplier, deleteSupplierByID) share the
+// owner's pools and belong on the same writer thread. Lookups take no lock:
+// they use the node versions (see "Optimistic lock coupling") and start
+// again if a split, merge or edit got in their way. Writers lock the nodes
+// they will change. On the medication tree they lock down from the root with
+// tree->rootVersion standing in for the root's parent, and let go of every
+// ancestor once a node is safe, so readers are held up only where the tree
+// actually changes. Supplier trees are small, so their writers simply lock
+// the whole path. Other changes (bulk loads, batch inserts, supplier feeds,
+// menu edits and snapshot loading) expect no lookups to be in flight.
+
+#define MEDICATION_MAX_HEIGHT 64
+
+typedef struct MedicationWritePath {
+    MedicationInternalNode *nodes[MEDICATION_MAX_HEIGHT];  // Internal nodes from the root down
+    int indices[MEDICATION_MAX_HEIGHT];                     // Child taken in each
+    int length;
+    int lockedFrom;                            // nodes[lockedFrom..length-1] are still locked
+    bool rootLocked;                           // tree->rootVersion is still locked
+    MedicationNode *retired[MEDICATION_MAX_HEIGHT + 1];     // Freed once every lock is released
+    int retiredCount;
+} MedicationWritePath;
+
+// Locks the leaf that would hold key so a writer can edit records in place.
+// Only writers change the tree's shape and they run one at a time, so the
+// way down needs no locks. Returns NULL on an empty tree.
+static MedicationNode* lockMedicationLeaf(MedicationBPlusTree *tree, unsigned long key) {
+    MedicationNode *node = tree->root;
+    if (!node) return NULL;
+    while (!node->isLeaf) {
+        STAT_ADD(STAT_NODE_VISITS, 1);
+        node = node->internal.children[upperBoundKey(node->internal.keys, node->internal.cursize, key)];
+    }
+    STAT_ADD(STAT_NODE_VISITS, 1);
+    olcWriteLock(&node->version);
+    return node;
+}
+
+// Locks the way down to the leaf for key, recording the path. A node is safe
+// when the change cannot spread above it: inserting, it has room for one more
+// key; deleting, it can lose one without underflowing (the root just has to
+// keep a key). Reaching a safe node unlocks everything above it. Returns the
+// locked leaf, or NULL with only the root version locked if the tree is empty.
+static MedicationNode* lockMedicationPath(MedicationBPlusTree *tree, unsigned long key, bool inserting, MedicationWritePath *path) {
+    int minKeys = (tree->order - 1) / 2;
+    path->length = 0;
+    path->lockedFrom = 0;
+    path->retiredCount = 0;
+    path->rootLocked = true;
+    olcWriteLock(&tree->rootVersion);
+
+    MedicationNode *node = tree->root;
+    if (!node) return NULL;
+    olcWriteLock(&node->version);
+
+    for (;;) {
+        STAT_ADD(STAT_NODE_VISITS, 1);
+        int keys = node->isLeaf ? node->leaf.cursize : node->internal.cursize;
+        bool safe;
+        if (inserting) safe = keys < tree->order - 1;
+        else safe = keys > (path->length == 0 ? 1 : minKeys);
+
+        if (safe) {
+            if (path->rootLocked) olcWriteUnlock(&tree->rootVersion);
+            path->rootLocked = false;
+            for (; path->lockedFrom < path->length; path->lockedFrom++) {
+                olcWriteUnlock(&NODE_FROM_MEMBER(path->nodes[path->lockedFrom], MedicationNode)->version);
+            }
+        }
+        if (node->isLeaf) return node;
+
+        int i = upperBoundKey(node->internal.keys, node->internal.cursize, key);
+        path->nodes[path->length] = &(node->internal);
+        path->indices[path->length] = i;
+        path->length++;
+        node = node->internal.children[i];
+        olcWriteLock(&node->version);
+    }
+}
+
+// Moves a node that has left the tree to the path's retired list.
+static void retireMedicationNode(MedicationNode **retired, int *retiredCount, MedicationNode *node) {
+    olcMarkObsolete(&node->version);
+    retired[(*retiredCount)++] = node;
+}
+
+// Unlocks what lockMedicationPath still holds and frees the retired nodes.
+static void unlockMedicationPath(MedicationBPlusTree *tree, MedicationWritePath *path, MedicationNode *leaf) {
+    if (leaf) olcWriteUnlock(&leaf->version);
+    for (int i = path->length - 1; i >= path->lockedFrom; i--) {
+        olcWriteUnlock(&NODE_FROM_MEMBER(path->nodes[i], MedicationNode)->version);
+    }
+    if (path->rootLocked) olcWriteUnlock(&tree->rootVersion);
+
+    for (int i = 0; i < path->retiredCount; i++) {
+        MedicationNode *node = path->retired[i];
+        poolFree(node->isLeaf ? &tree->leafNodes : &tree->internalNodes, node);
+    }
+}
+
+// Finds the leaf for key without taking a lock. On success the leaf is
+// returned with its version in seen, to be validated after reading from it;
+// NULL with *empty set means the tree is empty, and NULL otherwise means a
+// writer got in the way and the caller should start again.
+static MedicationNode* optimisticMedicationLeaf(MedicationBPlusTree *tree, unsigned long key, NodeVersion *seen, bool *empty) {
+    *empty = false;
+    NodeVersion rootSeen = olcReadBegin(&tree->rootVersion);
+    MedicationNode *node = tree->root;
+    if (!node) {
+        *empty = olcReadValidate(&tree->rootVersion, rootSeen);
+        return NULL;
     }
+    NodeVersion version = olcReadBegin(&node->version);
+    if (!olcReadValidate(&tree->rootVersion, rootSeen)) return NULL;
+
+    for (;;) {
+        // A freed slot loses isLeaf to the pool's free list, so it is checked
+        // first; slots never change kind, so the node's arrays then stay put
+        bool isLeaf = node->isLeaf;
+        if (!olcReadValidate(&node->version, version)) return NULL;
+        STAT_ADD(STAT_NODE_VISITS, 1);
+        if (isLeaf) break;
+
+        // A torn size is caught by validation, but must not run the search off the node
+        int keys = node->internal.cursize;
+        if (keys < 0 || keys >= tree->order) return NULL;
+        MedicationNode *child = node->internal.children[upperBoundKey(node->internal.keys, keys, key)];
+        if (!olcReadValidate(&node->version, version)) return NULL;
+
+        NodeVersion childVersion = olcReadBegin(&child->version);
+        if (!olcReadValidate(&node->version, version)) return NULL;
+        node = child;
+        version = childVersion;
+    }
+    *seen = version;
+    return node;
+}
+
+// Copies the record for id into copy (if given) and reports whether id is
+// stored, without taking a lock. The copy's supplier tree belongs to the
+// writers; use lookupSupplier to read from it.
+bool lookupMedication(MedicationBPlusTree *tree, unsigned long id, MedicationData *copy) {
+    if (!tree) return false;
+    for (;;) {
+        NodeVersion seen;
+        bool empty;
+        MedicationNode *leafNode = optimisticMedicationLeaf(tree, id, &seen, &empty);
+        if (!leafNode) {
+            if (empty) return false;
+            continue;
+        }
+
+        int keys = leafNode->leaf.cursize;
+        if (keys < 0 || keys >= tree->order) continue;
+        int i = findKeyIndex(leafNode->leaf.keys, keys, id);
+        MedicationData *record = (i == -1) ? NULL : leafNode->leaf.values[i];
+        if (!olcReadValidate(&leafNode->version, seen)) continue;
+        if (!record) return false;
+
+        // Record edits lock the leaf too, so one more check covers the copy
+        if (copy) *copy = *record;
+        if (olcReadValidate(&leafNode->version, seen)) return true;
+    }
+}
+
+// Copies supplier supplierID of medication medicationID into copy (if given)
+// and reports whether it exists, without taking a lock.
+bool lookupSupplier(MedicationBPlusTree *tree, unsigned long medicationID, unsigned long supplierID, SupplierData *copy) {
+    if (!tree) return false;
+    for (;;) {
+        NodeVersion seen;
+        bool empty;
+        MedicationNode *leafNode = optimisticMedicationLeaf(tree, medicationID, &seen, &empty);
+        if (!leafNode) {
+            if (empty) return false;
+            continue;
+        }
+
+        int keys = leafNode->leaf.cursize;
+        if (keys < 0 || keys >= tree->order) continue;
+        int i = findKeyIndex(leafNode->leaf.keys, keys, medicationID);
+        MedicationData *record = (i == -1) ? NULL : leafNode->leaf.values[i];
+        if (!olcReadValidate(&leafNode->version, seen)) continue;
+        if (!record) return false;
+        SupplierBPlusTree *suppliers = record->Suppliers;
+        if (!olcReadValidate(&leafNode->version, seen)) continue;
+        if (!suppliers) return false;
+
+        // Deleting the medication locks its leaf before releasing the supplier tree
+        NodeVersion treeSeen = olcReadBegin(&suppliers->version);
+        SupplierNode *node = suppliers->root;
+        if (!olcReadValidate(&leafNode->version, seen) || !olcReadValidate(&suppliers->version, treeSeen)) continue;
+        if (!node) return false;
+        NodeVersion version = olcReadBegin(&node->version);
+        if (!olcReadValidate(&suppliers->version, treeSeen)) continue;
+
+        bool restart = false;
+        for (;;) {
+            bool isLeaf = node->isLeaf;
+            if (!olcReadValidate(&node->version, version)) { restart = true; break; }
+            if (isLeaf) break;
+
+            int childKeys = node->internal.cursize;
+            if (childKeys < 0 || childKeys >= tree->order) { restart = true; break; }
+            SupplierNode *child = node->internal.children[upperBoundKey(node->internal.keys, childKeys, supplierID)];
+            if (!olcReadValidate(&node->version, version)) { restart = true; break; }
+
+            NodeVersion childVersion = olcReadBegin(&child->version);
+            if (!olcReadValidate(&node->version, version)) { restart = true; break; }
+            node = child;
+            version = childVersion;
+        }
+        if (restart) continue;
+
+        keys = node->leaf.cursize;
+        if (keys < 0 || keys >= tree->order) continue;
+        i = findKeyIndex(node->leaf.keys, keys, supplierID);
+        if (!olcReadValidate(&node->version, version)) continue;
+        if (i == -1) return false;
+        if (copy) *copy = node->leaf.values[i];
+        if (olcReadValidate(&node->version, version)) return true;
+    }
+}
+
+bool insertIntoLeaf(MedicationLeafNode *leaf, unsigned long key, MedicationData *record) {
+    // Find position to insert
+    int pos = lowerBoundKey(leaf->keys, leaf->cursize, key);
     
     // Check if key already exists
     if (pos < leaf->cursize && leaf->keys[pos] == key) {
         // Update existing value
-        leaf->values[pos] = data;
+        leaf->values[pos] = record;
         return true;
     }
     
-    // Shift existing keys and values
-    for (int i = leaf->cursize; i > pos; i--) {
-        leaf->keys[i] = leaf->keys[i - 1];
-        leaf->values[i] = leaf->values[i - 1];
-    }
+    // Shift existing keys and handles
+    int tail = leaf->cursize - pos;
+    memmove(&leaf->keys[pos + 1], &leaf->keys[pos], tail * sizeof(unsigned long));
+    memmove(&leaf->values[pos + 1], &leaf->values[pos], tail * sizeof(MedicationData*));
+    STAT_MOVE(tail, tail * (sizeof(unsigned long) + sizeof(MedicationData*)));
     
     // Insert new key and value
     leaf->keys[pos] = key;
-    leaf->values[pos] = data;
+    leaf->values[pos] = record;
     leaf->cursize++;
     
     return true;
@@ -1660,10 +3166,7 @@ bool insertIntoLeaf(MedicationLeafNode *leaf, unsigned long key, MedicationData
 
 void insertIntoInternalNode(MedicationInternalNode *node, unsigned long key, MedicationNode *left, MedicationNode *right) {
     // Find position to insert
-    int pos = 0;
-    while (pos < node->cursize && node->keys[pos] < key) {
-        pos++;
-    }
+    int pos = lowerBoundKey(node->keys, node->cursize, key);
     
     // Shift existing keys and children
     for (int i = node->cursize; i > pos; i--) {
@@ -1691,21 +3194,22 @@ void insertIntoInternalNode(MedicationInternalNode *node, unsigned long key, Med
     }
 }
 
-MedicationNode* splitLeafNode(MedicationLeafNode *leaf, unsigned long *midKey) {
+MedicationNode* splitLeafNode(MedicationBPlusTree *tree, MedicationLeafNode *leaf, unsigned long *midKey) {
     int median = leaf->order / 2;
     
     // Create a new leaf node
-    MedicationNode *newNode = createMedicationNode(leaf->order, true);
+    MedicationNode *newNode = createMedicationNode(tree, true);
     if (!newNode) return NULL;
     
     MedicationLeafNode *newLeaf = &(newNode->leaf);
     
-    // Copy the second half of keys and values to the new leaf
-    for (int i = median; i < leaf->cursize; i++) {
-        newLeaf->keys[i - median] = leaf->keys[i];
-        newLeaf->values[i - median] = leaf->values[i];
-        newLeaf->cursize++;
-    }
+    // Move the second half of keys and record handles to the new leaf
+    int moved = leaf->cursize - median;
+    memcpy(newLeaf->keys, &leaf->keys[median], moved * sizeof(unsigned long));
+    memcpy(newLeaf->values, &leaf->values[median], moved * sizeof(MedicationData*));
+    newLeaf->cursize = moved;
+    STAT_ADD(STAT_SPLITS, 1);
+    STAT_MOVE(moved, moved * (sizeof(unsigned long) + sizeof(MedicationData*)));
     
     // Update the current size of the original leaf
     leaf->cursize = median;
@@ -1727,12 +3231,12 @@ MedicationNode* splitLeafNode(MedicationLeafNode *leaf, unsigned long *midKey) {
     return newNode;
 }
 
-MedicationNode* splitInternalNode(MedicationInternalNode *node, unsigned long *midKey) {
+MedicationNode* splitInternalNode(MedicationBPlusTree *tree, MedicationInternalNode *node, unsigned long *midKey) {
     int median = node->order / 2;
     *midKey = node->keys[median];
     
     // Create a new internal node
-    MedicationNode *newNode = createMedicationNode(node->order, false);
+    MedicationNode *newNode = createMedicationNode(tree, false);
     if (!newNode) return NULL;
     
     MedicationInternalNode *newInternal = &(newNode->internal);
@@ -1760,23 +3264,15 @@ MedicationNode* splitInternalNode(MedicationInternalNode *node, unsigned long *m
         node->children[node->cursize]->internal.parent = newInternal;
     }
     
+    STAT_ADD(STAT_SPLITS, 1);
+    STAT_MOVE(newInternal->cursize, newInternal->cursize * sizeof(unsigned long) + (newInternal->cursize + 1) * sizeof(MedicationNode*));
+
     // Update current node size (excluding the median key)
     node->cursize = median;
     
     // Set parent pointer
     newInternal->parent = node->parent;
     
-    printf("Internal node split completed. MidKey: %lu\n", *midKey);
-    printf("Original internal node keys: ");
-    for (int i = 0; i < node->cursize; i++) {
-        printf("%lu ", node->keys[i]);
-    }
-    printf("\nNew internal node keys: ");
-    for (int i = 0; i < newInternal->cursize; i++) {
-        printf("%lu ", newInternal->keys[i]);
-    }
-    printf("\n");
-    
     return newNode;
 }
 
@@ -1784,7 +3280,7 @@ void insertIntoParent(MedicationBPlusTree *tree, MedicationNode *leftNode, unsig
     // Case 1: leftNode is the root (has no parent)
     if ((leftNode->isLeaf && !leftNode->leaf.parent) || (!leftNode->isLeaf && !leftNode->internal.parent)) {
         // Create a new root
-        MedicationNode* newRoot = createMedicationNode(tree->order, false);
+        MedicationNode* newRoot = createMedicationNode(tree, false);
         if (!newRoot) return;
         
         tree->root = newRoot;
@@ -1818,1492 +3314,7029 @@ void insertIntoParent(MedicationBPlusTree *tree, MedicationNode *leftNode, unsig
         parent = leftNode->internal.parent;
     }
     
-    // Create a container node for the parent (for easier handling)
-    MedicationNode parentNode;
-    parentNode.isLeaf = false;
-    parentNode.internal = *parent;
-    
-    // Check if parent has space for a new key
-    if (parent->cursize < parent->order - 1) {
-        // Insert the new key and child into parent
-        int i = parent->cursize - 1;
-        while (i >= 0 && parent->keys[i] > midKey) {
-            parent->keys[i + 1] = parent->keys[i];
-            parent->children[i + 2] = parent->children[i + 1];
-            i--;
-        }
-        
-        parent->keys[i + 1] = midKey;
-        parent->children[i + 2] = rightNode;
-        parent->cursize++;
-        
-        // Update parent pointer of the right child
-        if (rightNode->isLeaf) {
-            rightNode->leaf.parent = parent;
-        } else {
-            rightNode->internal.parent = parent;
-        }
+    // Insert the new key and child into parent. Internal nodes have room for
+    // one key over the limit, so a full parent takes the key first and is then
+    // split around its middle, leaving both halves at least half full.
+    int i = parent->cursize - 1;
+    while (i >= 0 && parent->keys[i] > midKey) {
+        parent->keys[i + 1] = parent->keys[i];
+        parent->children[i + 2] = parent->children[i + 1];
+        STAT_MOVE(1, sizeof(unsigned long) + sizeof(MedicationNode*));
+        i--;
+    }
+
+    parent->keys[i + 1] = midKey;
+    parent->children[i + 2] = rightNode;
+    parent->cursize++;
+
+    if (rightNode->isLeaf) {
+        rightNode->leaf.parent = parent;
+    } else {
+        rightNode->internal.parent = parent;
+    }
 
+    if (parent->cursize < parent->order) {
         return;
     }
-    // Parent is full, need to split
-    unsigned long newMidKey;
-    MedicationNode *newParentNode = splitInternalNode(parent, &newMidKey);
-    
-    if (midKey > newMidKey) {
-        MedicationInternalNode *rightParent = &(newParentNode->internal);
-        int i = rightParent->cursize - 1;
-        while (i >= 0 && rightParent->keys[i] > midKey) {
-            rightParent->keys[i + 1] = rightParent->keys[i];
-            rightParent->children[i + 2] = rightParent->children[i + 1];
-            i--;
-        }
-        
-        rightParent->keys[i + 1] = midKey;
-        rightParent->children[i + 2] = rightNode;
-        rightParent->cursize++;
-        
-        if (rightNode->isLeaf) {
-            rightNode->leaf.parent = rightParent;
-        } else {
-            rightNode->internal.parent = rightParent;
-        }
-    } else {
-        int i = parent->cursize - 1;
-        while (i >= 0 && parent->keys[i] > midKey) {
-            parent->keys[i + 1] = parent->keys[i];
-            parent->children[i + 2] = parent->children[i + 1];
-            i--;
-        }
-        
-        parent->keys[i + 1] = midKey;
-        parent->children[i + 2] = rightNode;
-        parent->cursize++;
-        
-        if (rightNode->isLeaf) {
-            rightNode->leaf.parent = parent;
-        } else {
-            rightNode->internal.parent = parent;
-        }
-    }
-    
 
-    MedicationNode *parentContainer = (MedicationNode*)malloc(sizeof(MedicationNode));
-    if (!parentContainer) return;
-    
-    parentContainer->isLeaf = false;
-    parentContainer->internal = *parent;
-    
-    insertIntoParent(tree, parentContainer, newMidKey, newParentNode);
+    unsigned long newMidKey;
+    MedicationNode *newParentNode = splitInternalNode(tree, parent, &newMidKey);
+    insertIntoParent(tree, NODE_FROM_MEMBER(parent, MedicationNode), newMidKey, newParentNode);
 }
 
-bool insertMedication(MedicationBPlusTree *tree, MedicationData data) {
-    if (!tree) return false;
-    
+// The body of insertMedication, run with the path to leafNode locked
+// (leafNode is NULL for an empty tree).
+static bool insertMedicationLocked(MedicationBPlusTree *tree, MedicationData data, MedicationNode *leafNode) {
     unsigned long key = data.Medication_ID;
 
     // Case 1: Empty tree
-    if (!tree->root) {
-        MedicationNode *newNode = createMedicationNode(tree->order, true);
+    if (!leafNode) {
+        MedicationNode *newNode = createMedicationNode(tree, true);
         if (!newNode) return false;
         
+        MedicationData *record = (MedicationData*)poolAlloc(&tree->records);
+        *record = data;
         newNode->leaf.keys[0] = key;
-        newNode->leaf.values[0] = data;
+        newNode->leaf.values[0] = record;
         newNode->leaf.cursize = 1;
         
         tree->root = newNode;
         tree->leftmost_leaf = &(newNode->leaf);
+        nameIndexInsert(&tree->names, record);
+        attachSupplierTree(tree, record);
+        lowStockUpdate(&tree->lowStock, record);
+        walLogMedication(WAL_INSERT_MEDICATION, record);
         return true;
     }
     
-    // Find the leaf node where this key should be inserted
-    MedicationNode *leafNode = findLeafNode(tree, key);
-    if (!leafNode) return false;
-    
     MedicationLeafNode *leaf = &(leafNode->leaf);
     
     // Check if key already exists
-    for (int i = 0; i < leaf->cursize; i++) {
-        if (leaf->keys[i] == key) {
-            // Update the existing value
-            leaf->values[i] = data;
-            return true;
-        }
+    int existing = findKeyIndex(leaf->keys, leaf->cursize, key);
+    if (existing != -1) {
+        // Update the existing record in place so outstanding handles stay valid
+        replaceMedicationRecord(tree, leaf->values[existing], &data);
+        walLogMedication(WAL_INSERT_MEDICATION, leaf->values[existing]);
+        return true;
     }
     
+    MedicationData *record = (MedicationData*)poolAlloc(&tree->records);
+    if (!record) return false;
+    *record = data;
+    nameIndexInsert(&tree->names, record);
+    attachSupplierTree(tree, record);
+    lowStockUpdate(&tree->lowStock, record);
+
     // If leaf is not full, simply insert
     if (leaf->cursize < leaf->order - 1) {
-        bool result = insertIntoLeaf(leaf, key, data);
+        bool result = insertIntoLeaf(leaf, key, record);
+        walLogMedication(WAL_INSERT_MEDICATION, record);
         return result;
     }
     
     // Leaf is full, need to split
     unsigned long midKey;
-    MedicationNode *newLeafNode = splitLeafNode(leaf, &midKey);
+    MedicationNode *newLeafNode = splitLeafNode(tree, leaf, &midKey);
     if (!newLeafNode) return false;
     
     // After split, determine which leaf should contain our new key
     if (key >= midKey) {
-        insertIntoLeaf(&(newLeafNode->leaf), key, data);
+        insertIntoLeaf(&(newLeafNode->leaf), key, record);
     } else {
-        insertIntoLeaf(leaf, key, data);
+        insertIntoLeaf(leaf, key, record);
     }
     
     // Update the tree by inserting the separator key into the parent
     insertIntoParent(tree, leafNode, midKey, newLeafNode);
     
+    walLogMedication(WAL_INSERT_MEDICATION, record);
     return true;
 }
 
-// =================================================================================================================================
+bool insertMedication(MedicationBPlusTree *tree, MedicationData data) {
+    if (!tree) return false;
 
-void checkStockAlerts(MedicationBPlusTree* pharmacy){
-    if (!pharmacy || !pharmacy->root) {
-        printf("The medication B+ tree is empty.\n");
-        return;
-    }
+    STAT_TIMER_START(insert);
+    MedicationWritePath path;
+    pthread_mutex_lock(&tree->writer);
+    MedicationNode *leafNode = lockMedicationPath(tree, data.Medication_ID, true, &path);
+    bool result = insertMedicationLocked(tree, data, leafNode);
+    unlockMedicationPath(tree, &path, leafNode);
+    pthread_mutex_unlock(&tree->writer);
+    STAT_TIMER_STOP(insert, STAT_INSERT);
+    return result;
+}
 
-    MedicationLeafNode* current = pharmacy->leftmost_leaf;
-    printf("\nStock Alerts:\n");
+//==============================================================================
+// Bulk loading: build a tree bottom-up from a batch of records
 
-    while (current != NULL) {
-        for (int i = 0; i < current->cursize; i++) {
-            if (current->values[i].Quantity_in_stock <= current->values[i].Reorderlevel && current->values[i].Quantity_in_stock > 0) {
-                printf("Medication ID: %lu, Name: %s, Stock: %u\n",
-                       current->keys[i],
-                       current->values[i].Medicine_Name,
-                       current->values[i].Quantity_in_stock);
-            }
-            else if(current->values[i].Quantity_in_stock < 0){
-                printf("NO STOCK LEFT FOR MEDICATION ID: %lu, Name: %s\n",
-                       current->keys[i],
-                       current->values[i].Medicine_Name);
-            }
-        }
-        current = current->next;
-    }
+// Leaves and internal nodes are packed to this fraction of their capacity, leaving
+// room for later inserts before the first splits. Overridden with --fill-factor.
+#define BULK_LOAD_DEFAULT_FILL 0.9
+
+double bulkLoadFillFactor = BULK_LOAD_DEFAULT_FILL;
+
+typedef struct BulkLoadEntry {
+    unsigned long long key;
+    int seq;                                   // Input position, so later duplicates win
+    void *value;
+} BulkLoadEntry;
+
+static int compareBulkLoadEntries(const void *a, const void *b) {
+    const BulkLoadEntry *x = (const BulkLoadEntry*)a;
+    const BulkLoadEntry *y = (const BulkLoadEntry*)b;
+    if (x->key != y->key) return (x->key < y->key) ? -1 : 1;
+    return (x->seq < y->seq) ? -1 : (x->seq > y->seq);
 }
 
-//====================================================================================================================
-int Check_leap_year(int year) {
-    //FINDING GIVEN YEAR IS LEAP YEAR OR NOT
-    if((year % 4 == 0 && year % 100 != 0) || (year % 400 == 0)){
-        return 1;
+// Sorts the entries unless they already are, then drops all but the last of each key.
+// Returns the number of distinct keys left at the front of the array.
+static int sortBulkLoadEntries(BulkLoadEntry *entries, int count, bool sorted, void (*dropDuplicate)(void*, void*), void *context) {
+    if (!sorted) {
+        qsort(entries, count, sizeof(BulkLoadEntry), compareBulkLoadEntries);
     }
-    return 0;
-}
 
-int DaysCompleted_InYear(int day, int month, int year) {
-    int total_days = 0;
-    //Till before month we are adding all days as we have an array storing days of 12 months
-    for (int i = 1; i < month; i++) {
-        total_days += days_in_month[i - 1];
-        if (i == 2 && Check_leap_year(year)) {
-            total_days += 1;
+    int distinct = 0;
+    for (int i = 0; i < count; i++) {
+        if (i + 1 < count && entries[i + 1].key == entries[i].key) {
+            if (dropDuplicate) dropDuplicate(context, entries[i].value);
+            continue;
         }
+        entries[distinct++] = entries[i];
     }
-    total_days += day;
-    return total_days;
+    return distinct;
 }
 
-int daysDifference(int day1, int month1, int year1, int day2, int month2, int year2) {
-    int days_Complemented_year1 = DaysCompleted_InYear(day1, month1, year1);
-    int days_Complemented_year2 = DaysCompleted_InYear(day2, month2, year2);
+// Slots per node for a fill factor, kept between half and full so that
+// the delete path's underflow checks hold for bulk-built nodes as well.
+static int bulkLoadNodeSlots(int capacity, double fillFactor) {
+    if (fillFactor < 0.5) fillFactor = 0.5;
+    if (fillFactor > 1.0) fillFactor = 1.0;
+
+    int slots = (int)(capacity * fillFactor);
+    int minimum = (capacity + 1) / 2;
+    if (slots < minimum) slots = minimum;
+    if (slots < 1) slots = 1;
+    return slots;
+}
 
-    if (year1 == year2) {
-        return days_Complemented_year2 - days_Complemented_year1;
-    } 
-    else {
-        if(year1>year2) return 10000000;
-        int days_remaining_in_year1;
-        if(Check_leap_year(year1)){
-            days_remaining_in_year1 =  366  - days_Complemented_year1;
-        }
-        else{
-            days_remaining_in_year1 =  365  - days_Complemented_year1;
-        }
-        
-        int days_bw_years = 0;
-        for (int i = year1 + 1; i < year2; i++) {
-            days_bw_years += Check_leap_year(i) ? 366 : 365;
+// Number of nodes needed for count items; items are then spread evenly over
+// them so that the last node is never left nearly empty.
+static int bulkLoadNodeCount(int count, int perNode) {
+    return (count + perNode - 1) / perNode;
+}
+
+static void releaseDuplicateMedication(void *context, void *value) {
+    MedicationBPlusTree *tree = (MedicationBPlusTree*)context;
+    MedicationData *record = (MedicationData*)value;
+    releaseSupplierBPlusTree(tree, record->Suppliers);
+    poolFree(&tree->records, record);
+}
+
+// Builds an empty medication tree from records already allocated in tree->records.
+// Input that is sorted by ID is linked straight into leaves; anything else is sorted
+// first. Where an ID repeats, the last record wins and the others are released.
+bool bulkLoadMedications(MedicationBPlusTree *tree, MedicationData **records, int count, double fillFactor) {
+    if (!tree || tree->root) return false;
+    if (count == 0) return true;
+
+    BulkLoadEntry *entries = (BulkLoadEntry*)malloc(sizeof(BulkLoadEntry) * count);
+    if (!entries) return false;
+
+    bool sorted = true;
+    for (int i = 0; i < count; i++) {
+        entries[i].key = records[i]->Medication_ID;
+        entries[i].seq = i;
+        entries[i].value = records[i];
+        if (i > 0 && entries[i].key <= entries[i - 1].key) sorted = false;
+    }
+    count = sortBulkLoadEntries(entries, count, sorted, releaseDuplicateMedication, tree);
+
+    int order = tree->order;
+    int perLeaf = bulkLoadNodeSlots(order - 1, fillFactor);
+    int perInternal = bulkLoadNodeSlots(order, fillFactor);
+    if (perInternal < 3 && order >= 3) perInternal = 3;
+
+    int levelSize = bulkLoadNodeCount(count, perLeaf);
+    MedicationNode **level = (MedicationNode**)malloc(sizeof(MedicationNode*) * levelSize);
+    unsigned long *lowKeys = (unsigned long*)malloc(sizeof(unsigned long) * levelSize);
+    if (!level || !lowKeys) {
+        free(level);
+        free(lowKeys);
+        free(entries);
+        return false;
+    }
+
+    // Leaf level, linked left to right
+    MedicationLeafNode *prev = NULL;
+    int next = 0;
+    for (int i = 0; i < levelSize; i++) {
+        int take = count / levelSize + (i < count % levelSize);
+        MedicationNode *node = createMedicationNode(tree, true);
+        MedicationLeafNode *leaf = &(node->leaf);
+
+        for (int j = 0; j < take; j++, next++) {
+            leaf->keys[j] = (unsigned long)entries[next].key;
+            leaf->values[j] = (MedicationData*)entries[next].value;
         }
+        leaf->cursize = take;
+        leaf->prev = prev;
+        if (prev) prev->next = leaf;
+        else tree->leftmost_leaf = leaf;
+        prev = leaf;
+
+        level[i] = node;
+        lowKeys[i] = leaf->keys[0];
+    }
+    // Internal levels; separators are the lowest key of each right-hand child
+    while (levelSize > 1) {
+        int parents = bulkLoadNodeCount(levelSize, perInternal);
+        next = 0;
+        for (int i = 0; i < parents; i++) {
+            int take = levelSize / parents + (i < levelSize % parents);
+            MedicationNode *node = createMedicationNode(tree, false);
+            MedicationInternalNode *internal = &(node->internal);
+            unsigned long lowKey = lowKeys[next];
+
+            for (int j = 0; j < take; j++, next++) {
+                MedicationNode *child = level[next];
+                internal->children[j] = child;
+                if (j > 0) internal->keys[j - 1] = lowKeys[next];
+                if (child->isLeaf) child->leaf.parent = internal;
+                else child->internal.parent = internal;
+            }
+            internal->cursize = take - 1;
 
-        int x = days_remaining_in_year1 + days_Complemented_year2 + days_bw_years;
+            // Parents are written over the front of the level being consumed
+            level[i] = node;
+            lowKeys[i] = lowKey;
+        }
+        levelSize = parents;
+    }
+    tree->root = level[0];
 
-        return x;
+    // The secondary indexes cover the records that survived de-duplication
+    MedicationData **survivors = (MedicationData**)malloc(sizeof(MedicationData*) * count);
+    bool indexed = survivors != NULL;
+    if (indexed) {
+        for (int i = 0; i < count; i++) survivors[i] = (MedicationData*)entries[i].value;
+        indexed = nameIndexBuild(&tree->names, survivors, count, fillFactor)
+               && supplierPostingsBuild(tree, survivors, count, fillFactor)
+               && lowStockBuild(&tree->lowStock, survivors, count);
     }
+
+    free(survivors);
+
+    free(level);
+    free(lowKeys);
+    free(entries);
+    return indexed;
 }
 
-void checkExpirationDates(int day, int month, int year, MedicationBPlusTree* pharmacy) {
-    if (!pharmacy || !pharmacy->root) {
-        printf("The medication B+ tree is empty.\n");
-        return;
+// Builds an empty expiration tree from a batch of entries, copying them into the
+// leaves. Sorted input skips the sort; for repeated keys the last entry wins.
+bool bulkLoadExpirationTree(ExpirationBPlusTree *tree, ExpirationIndexData *items, int count, double fillFactor) {
+    if (!tree || tree->root) return false;
+    if (count == 0) return true;
+
+    BulkLoadEntry *entries = (BulkLoadEntry*)malloc(sizeof(BulkLoadEntry) * count);
+    if (!entries) return false;
+
+    bool sorted = true;
+    for (int i = 0; i < count; i++) {
+        entries[i].key = items[i].expirationKey;
+        entries[i].seq = i;
+        entries[i].value = &items[i];
+        if (i > 0 && entries[i].key <= entries[i - 1].key) sorted = false;
+    }
+    count = sortBulkLoadEntries(entries, count, sorted, NULL, NULL);
+
+    int order = tree->order;
+    int perLeaf = bulkLoadNodeSlots(order - 1, fillFactor);
+    int perInternal = bulkLoadNodeSlots(order, fillFactor);
+    if (perInternal < 3 && order >= 3) perInternal = 3;
+
+    int levelSize = bulkLoadNodeCount(count, perLeaf);
+    ExpirationNode **level = (ExpirationNode**)malloc(sizeof(ExpirationNode*) * levelSize);
+    unsigned long long *lowKeys = (unsigned long long*)malloc(sizeof(unsigned long long) * levelSize);
+    if (!level || !lowKeys) {
+        free(level);
+        free(lowKeys);
+        free(entries);
+        return false;
+    }
+
+    ExpirationLeafNode *prev = NULL;
+    int next = 0;
+    for (int i = 0; i < levelSize; i++) {
+        int take = count / levelSize + (i < count % levelSize);
+        ExpirationNode *node = createExpirationNode(tree, true);
+        ExpirationLeafNode *leaf = &(node->leaf);
+
+        for (int j = 0; j < take; j++, next++) {
+            leaf->keys[j] = entries[next].key;
+            leaf->values[j] = *(ExpirationIndexData*)entries[next].value;
+        }
+        leaf->cursize = take;
+        leaf->prev = prev;
+        if (prev) prev->next = leaf;
+        else tree->leftmost_leaf = leaf;
+        prev = leaf;
+
+        level[i] = node;
+        lowKeys[i] = leaf->keys[0];
+    }
+    while (levelSize > 1) {
+        int parents = bulkLoadNodeCount(levelSize, perInternal);
+        next = 0;
+        for (int i = 0; i < parents; i++) {
+            int take = levelSize / parents + (i < levelSize % parents);
+            ExpirationNode *node = createExpirationNode(tree, false);
+            ExpirationInternalNode *internal = &(node->internal);
+            unsigned long long lowKey = lowKeys[next];
+
+            for (int j = 0; j < take; j++, next++) {
+                ExpirationNode *child = level[next];
+                internal->children[j] = child;
+                if (j > 0) internal->keys[j - 1] = lowKeys[next];
+                if (child->isLeaf) child->leaf.parent = internal;
+                else child->internal.parent = internal;
+            }
+            internal->cursize = take - 1;
+
+            level[i] = node;
+            lowKeys[i] = lowKey;
+        }
+        levelSize = parents;
     }
+    tree->root = level[0];
 
-    // Reset February to 28 days for non-leap years
-    days_in_month[1] = 28;
+    free(level);
+    free(lowKeys);
+    free(entries);
+    return true;
+}
 
-    // Update February to 29 days if the current year is a leap year
-    if ((year % 4 == 0 && year % 100 != 0) || (year % 400 == 0)) {
-        days_in_month[1] = 29;
-    }
+//==============================================================================
+// Batched inserts into populated trees: the batch is sorted once and then
+// applied a leaf at a time. One descent finds the leaf for the smallest pending
+// key together with the separator that bounds it on the right; every pending key
+// below that bound belongs to the same leaf, so the run is merged into it and the
+// result spread over as many leaves as the fill factor calls for.
+
+static void releaseDuplicateMedicationData(void *context, void *value) {
+    releaseSupplierBPlusTree((MedicationBPlusTree*)context, ((MedicationData*)value)->Suppliers);
+}
 
-    MedicationLeafNode* current = pharmacy->leftmost_leaf;
-    printf("\nMedicines that are expired or will expire soon:\n");
+// Number of leaves a merged run of total entries is spread over: packed to the
+// fill factor, but with one leaf fewer where that would leave them underfull.
+static int batchLeafCount(int total, int capacity) {
+    if (total <= capacity) return 1;
 
-    while (current != NULL) {
-        for (int i = 0; i < current->cursize; i++) {
-            int eday = current->values[i].Batch_details.Expiration_Date.day;
-            int emonth = current->values[i].Batch_details.Expiration_Date.month;
-            int eyear = current->values[i].Batch_details.Expiration_Date.year;
+    int leaves = bulkLoadNodeCount(total, bulkLoadNodeSlots(capacity, bulkLoadFillFactor));
+    if (total / leaves < capacity / 2 && bulkLoadNodeCount(total, leaves - 1) <= capacity) leaves--;
+    return leaves;
+}
 
-            // Calculate the difference in days
-            int result = daysDifference(day, month, year, eday, emonth, eyear);
+// Inserts or replaces every record in items, as insertMedication would one at a
+// time, and returns how many were applied. Where an ID repeats within the batch
+// the last record wins. The records' supplier trees pass to the tree; expiration
+// entries are left to the caller, as with insertMedication. All WAL records of the
+// batch are made durable together.
+int insertMedicationBatch(MedicationBPlusTree *tree, MedicationData *items, int count) {
+    if (!tree || count <= 0) return 0;
+
+    int capacity = tree->order - 1;
+    BulkLoadEntry *entries = (BulkLoadEntry*)malloc(sizeof(BulkLoadEntry) * count);
+    unsigned long *keys = (unsigned long*)malloc(sizeof(unsigned long) * (count + capacity));
+    MedicationData **values = (MedicationData**)malloc(sizeof(MedicationData*) * (count + capacity));
+    if (!entries || !keys || !values) {
+        free(entries);
+        free(keys);
+        free(values);
+        return 0;
+    }
+
+    bool sorted = true;
+    for (int i = 0; i < count; i++) {
+        entries[i].key = items[i].Medication_ID;
+        entries[i].seq = i;
+        entries[i].value = &items[i];
+        if (i > 0 && entries[i].key <= entries[i - 1].key) sorted = false;
+    }
+    count = sortBulkLoadEntries(entries, count, sorted, releaseDuplicateMedicationData, tree);
 
-            if (result <= 30) { // Expired or will expire within 30 days
-                printf("\n==================== ALERT ====================\n");
-                printf("Medication ID: %lu\n", current->keys[i]);
-                printf("Name: %s\n", current->values[i].Medicine_Name);
-                printf("Expiration Date: %02d/%02d/%04d\n", eday, emonth, eyear);
+    if (!tree->root) {
+        MedicationNode *first = createMedicationNode(tree, true);
+        tree->root = first;
+        tree->leftmost_leaf = &(first->leaf);
+    }
+
+    walBeginBatch();
+    int applied = 0;
+    int next = 0;
+    while (next < count) {
+        // Descend for the smallest pending key; deeper separators bound it more tightly
+        unsigned long key = (unsigned long)entries[next].key;
+        MedicationNode *node = tree->root;
+        bool bounded = false;
+        unsigned long bound = 0;
+        while (!node->isLeaf) {
+            int i = upperBoundKey(node->internal.keys, node->internal.cursize, key);
+            if (i < node->internal.cursize) {
+                bounded = true;
+                bound = node->internal.keys[i];
+            }
+            node = node->internal.children[i];
+        }
+        MedicationLeafNode *leaf = &(node->leaf);
+
+        // Merge the run belonging to this leaf with what it already holds
+        bool exhausted = false;
+        int total = 0, i = 0, end = next;
+        for (; end < count && (!bounded || entries[end].key < bound); end++) {
+            unsigned long id = (unsigned long)entries[end].key;
+            MedicationData *data = (MedicationData*)entries[end].value;
+            while (i < leaf->cursize && leaf->keys[i] < id) {
+                keys[total] = leaf->keys[i];
+                values[total++] = leaf->values[i++];
+            }
 
-                if (result <= 0) {
-                    printf("Status: Medication Already Expired\n");
-                } else {
-                    printf("Status: %d Days Remaining Until Expiration\n", result);
+            MedicationData *record;
+            if (i < leaf->cursize && leaf->keys[i] == id) {
+                // Update the existing record in place so outstanding handles stay valid
+                record = leaf->values[i++];
+                replaceMedicationRecord(tree, record, data);
+            } else {
+                record = (MedicationData*)poolAlloc(&tree->records);
+                if (!record) {
+                    exhausted = true;
+                    break;
                 }
-                printf("===============================================\n");
+                *record = *data;
+                nameIndexInsert(&tree->names, record);
+                attachSupplierTree(tree, record);
+                lowStockUpdate(&tree->lowStock, record);
             }
-            else if(result == 10000000){
-                printf("Medication ID: %lu\n", current->keys[i]);
-                printf("Name: %s\n", current->values[i].Medicine_Name);
-                printf("Status: Medication Expired\n");
+            keys[total] = id;
+            values[total++] = record;
+            walLogMedication(WAL_INSERT_MEDICATION, record);
+            applied++;
+        }
+        while (i < leaf->cursize) {
+            keys[total] = leaf->keys[i];
+            values[total++] = leaf->values[i++];
+        }
+
+        // The first share goes back into the leaf, the rest into new leaves to its right
+        int leaves = batchLeafCount(total, capacity);
+        int pos = 0;
+        MedicationLeafNode *left = leaf;
+        for (int l = 0; l < leaves; l++) {
+            int take = total / leaves + (l < total % leaves);
+            MedicationLeafNode *target = leaf;
+            MedicationNode *newNode = NULL;
+            if (l > 0) {
+                newNode = createMedicationNode(tree, true);
+                target = &(newNode->leaf);
+                target->prev = left;
+                target->next = left->next;
+                if (left->next) left->next->prev = target;
+                left->next = target;
             }
+            memcpy(target->keys, keys + pos, take * sizeof(unsigned long));
+            memcpy(target->values, values + pos, take * sizeof(MedicationData*));
+            target->cursize = take;
+            pos += take;
+
+            if (newNode) insertIntoParent(tree, NODE_FROM_MEMBER(left, MedicationNode), target->keys[0], newNode);
+            left = target;
         }
-        current = current->next;
+
+        if (exhausted) break;
+        next = end;
     }
-}
+    walEndBatch();
 
+    // Records that could not be stored hand back their supplier trees
+    for (int i = applied; i < count; i++) {
+        releaseSupplierBPlusTree(tree, ((MedicationData*)entries[i].value)->Suppliers);
+    }
 
-//====================================================================================================================
+    free(entries);
+    free(keys);
+    free(values);
+    return applied;
+}
 
+// Supplier batches usually hold a medication's few suppliers, so small ones
+// are sorted in place and a run that fits its leaf is merged into it directly.
+#define SUPPLIER_BATCH_INLINE_ENTRIES 16
 
-void heapifyDown(HeapNode* heap, int size, int index, bool sortByTurnover) {
-    int largest = index;
-    int left = 2 * index + 1;
-    int right = 2 * index + 2;
+// Inserts or replaces every supplier in items, as insertSupplier would one at a
+// time, and returns how many distinct IDs were applied. Where an ID repeats
+// within the batch the last entry wins.
+int insertSupplierBatch(SupplierBPlusTree *tree, SupplierData *items, int count) {
+    if (!tree || count <= 0) return 0;
 
-    // Compare with left child
-    if (left < size && 
-        ((sortByTurnover && heap[left].data.turnoverProduced > heap[largest].data.turnoverProduced) ||
-         (!sortByTurnover && heap[left].data.noOfUniqueMedicines > heap[largest].data.noOfUniqueMedicines))) {
-        largest = left;
+    int capacity = tree->order - 1;
+    BulkLoadEntry inlineEntries[SUPPLIER_BATCH_INLINE_ENTRIES];
+    BulkLoadEntry *entries = inlineEntries;
+    if (count > SUPPLIER_BATCH_INLINE_ENTRIES) {
+        entries = (BulkLoadEntry*)malloc(sizeof(BulkLoadEntry) * count);
+        if (!entries) return 0;
     }
+    unsigned long *keys = NULL;                // Scratch for runs that split their leaf
+    SupplierData *values = NULL;
 
-    // Compare with right child
-    if (right < size && 
-        ((sortByTurnover && heap[right].data.turnoverProduced > heap[largest].data.turnoverProduced) ||
-         (!sortByTurnover && heap[right].data.noOfUniqueMedicines > heap[largest].data.noOfUniqueMedicines))) {
-        largest = right;
+    bool sorted = true;
+    for (int i = 0; i < count; i++) {
+        entries[i].key = items[i].Supplier_ID;
+        entries[i].seq = i;
+        entries[i].value = &items[i];
+        if (i > 0 && entries[i].key <= entries[i - 1].key) sorted = false;
     }
+    count = sortBulkLoadEntries(entries, count, sorted, NULL, NULL);
+
+    if (!tree->root) {
+        SupplierNode *first = createSupplierNode(tree, true);
+        tree->root = first;
+        tree->leftmost_leaf = &(first->leaf);
+    }
+
+    int next = 0;
+    while (next < count) {
+        unsigned long key = (unsigned long)entries[next].key;
+        SupplierNode *node = tree->root;
+        bool bounded = false;
+        unsigned long bound = 0;
+        while (!node->isLeaf) {
+            int i = upperBoundKey(node->internal.keys, node->internal.cursize, key);
+            if (i < node->internal.cursize) {
+                bounded = true;
+                bound = node->internal.keys[i];
+            }
+            node = node->internal.children[i];
+        }
+        SupplierLeafNode *leaf = &(node->leaf);
+
+        // Count the run's new IDs to see whether the leaf can take it as it is
+        int end = next, added = 0, i = 0;
+        for (; end < count && (!bounded || entries[end].key < bound); end++) {
+            unsigned long id = (unsigned long)entries[end].key;
+            while (i < leaf->cursize && leaf->keys[i] < id) i++;
+            if (i == leaf->cursize || leaf->keys[i] != id) added++;
+        }
+        int total = leaf->cursize + added;
+
+        if (total <= capacity) {
+            // Merge from the back, so entries are moved before they are overwritten
+            int k = total - 1;
+            i = leaf->cursize - 1;
+            for (int j = end - 1; j >= next; j--) {
+                unsigned long id = (unsigned long)entries[j].key;
+                while (i >= 0 && leaf->keys[i] > id) {
+                    leaf->keys[k] = leaf->keys[i];
+                    leaf->values[k--] = leaf->values[i--];
+                }
+                if (i >= 0 && leaf->keys[i] == id) {
+                    i--;
+                } else if (tree->postings) {
+                    supplierPostingsInsert(tree->postings, id, tree->medication);
+                }
+                leaf->keys[k] = id;
+                leaf->values[k--] = *(SupplierData*)entries[j].value;
+            }
+            leaf->cursize = total;
+            next = end;
+            continue;
+        }
 
-    // If the largest is not the current index, swap and continue heapifying
-    if (largest != index) {
-        HeapNode temp = heap[index];
-        heap[index] = heap[largest];
-        heap[largest] = temp;
+        if (!keys) {
+            keys = (unsigned long*)malloc(sizeof(unsigned long) * (count + capacity));
+            values = (SupplierData*)malloc(sizeof(SupplierData) * (count + capacity));
+            if (!keys || !values) break;
+        }
+
+        total = 0;
+        i = 0;
+        for (int j = next; j < end; j++) {
+            unsigned long id = (unsigned long)entries[j].key;
+            while (i < leaf->cursize && leaf->keys[i] < id) {
+                keys[total] = leaf->keys[i];
+                values[total++] = leaf->values[i++];
+            }
+            if (i < leaf->cursize && leaf->keys[i] == id) {
+                i++;
+            } else if (tree->postings) {
+                supplierPostingsInsert(tree->postings, id, tree->medication);
+            }
+            keys[total] = id;
+            values[total++] = *(SupplierData*)entries[j].value;
+        }
+        while (i < leaf->cursize) {
+            keys[total] = leaf->keys[i];
+            values[total++] = leaf->values[i++];
+        }
+
+        int leaves = batchLeafCount(total, capacity);
+        int pos = 0;
+        SupplierLeafNode *left = leaf;
+        for (int l = 0; l < leaves; l++) {
+            int take = total / leaves + (l < total % leaves);
+            SupplierLeafNode *target = leaf;
+            SupplierNode *newNode = NULL;
+            if (l > 0) {
+                newNode = createSupplierNode(tree, true);
+                target = &(newNode->leaf);
+                target->prev = left;
+                target->next = left->next;
+                if (left->next) left->next->prev = target;
+                left->next = target;
+            }
+            memcpy(target->keys, keys + pos, take * sizeof(unsigned long));
+            memcpy(target->values, values + pos, take * sizeof(SupplierData));
+            target->cursize = take;
+            pos += take;
 
-        heapifyDown(heap, size, largest, sortByTurnover);
+            if (newNode) insertIntoSupplierParent(tree, NODE_FROM_MEMBER(left, SupplierNode), target->keys[0], newNode);
+            left = target;
+        }
+        next = end;
     }
+
+    if (entries != inlineEntries) free(entries);
+    free(keys);
+    free(values);
+    return next;
 }
 
-void buildMaxHeap(HeapNode* heap, int size, bool sortByTurnover) {
-    for (int i = size / 2 - 1; i >= 0; i--) {
-        heapifyDown(heap, size, i, sortByTurnover);
+//==============================================================================
+// Name index: records ordered by (lower-cased name, ID) for exact,
+// case-insensitive and prefix lookups without scanning every leaf.
+
+static int compareNamesIgnoringCase(const char *a, const char *b) {
+    while (*a && tolower((unsigned char)*a) == tolower((unsigned char)*b)) {
+        a++;
+        b++;
     }
+    return tolower((unsigned char)*a) - tolower((unsigned char)*b);
 }
 
-HeapNode* populateHeapFromTree(UniqueSupplierBPlusTree* tree, int* size) {
-    if (!tree || !tree->leftmost_leaf) {
-        printf("The Unique Supplier B+ Tree is empty.\n");
-        *size = 0;
-        return NULL;
-    }
+static int compareNameKey(const char *name, unsigned long id, const char *otherName, unsigned long otherID) {
+    int c = compareNamesIgnoringCase(name, otherName);
+    if (c != 0) return c;
+    return (id > otherID) - (id < otherID);
+}
 
-    // Count the total number of suppliers
-    int count = 0;
-    UniqueSupplierLeafNode* current = tree->leftmost_leaf;
-    while (current) {
-        count += current->cursize;
-        current = current->next;
+static bool hasPrefixIgnoringCase(const char *name, const char *prefix) {
+    while (*prefix) {
+        if (tolower((unsigned char)*name) != tolower((unsigned char)*prefix)) return false;
+        name++;
+        prefix++;
     }
+    return true;
+}
 
-    // Allocate memory for the heap
-    HeapNode* heap = (HeapNode*)malloc(sizeof(HeapNode) * count);
-    if (!heap) {
-        printf("Memory allocation failed.\n");
-        *size = 0;
-        return NULL;
+static void makeNameKey(NameKey *key, const MedicationData *record) {
+    int i = 0;
+    for (; record->Medicine_Name[i] && i < NAME_SIZE - 1; i++) {
+        key->name[i] = tolower((unsigned char)record->Medicine_Name[i]);
     }
+    key->name[i] = '\0';
+    key->id = record->Medication_ID;
+}
 
-    // Populate the heap with supplier data
-    int index = 0;
-    current = tree->leftmost_leaf;
-    while (current) {
-        for (int i = 0; i < current->cursize; i++) {
-            heap[index].data = current->values[i];
-            index++;
-        }
-        current = current->next;
-    }
+void nameIndexInit(NameIndex *index, int order) {
+    index->root = NULL;
+    index->order = order;
+    index->leftmost_leaf = NULL;
+    poolInit(&index->leafNodes, sizeof(NameIndexNode) + order * sizeof(MedicationData*));
+    poolInit(&index->internalNodes, sizeof(NameIndexNode) + order * sizeof(NameKey) + (order + 1) * sizeof(NameIndexNode*));
+}
 
-    *size = count;
-    return heap;
+void nameIndexDestroy(NameIndex *index) {
+    poolDestroy(&index->leafNodes);
+    poolDestroy(&index->internalNodes);
+    index->root = NULL;
+    index->leftmost_leaf = NULL;
 }
 
-void extractTop10(HeapNode* heap, int size, bool sortByTurnover) {
-    printf("\nTop 10 Suppliers:\n");
-    printf("======================================================\n");
+static NameIndexNode* createNameIndexNode(NameIndex *index, bool isLeaf) {
+    int order = index->order;
+    NameIndexNode *node = (NameIndexNode*)poolAlloc(isLeaf ? &index->leafNodes : &index->internalNodes);
+    if (!node) return NULL;
 
-    int count = 0;
-    while (size > 0 && count < 10) {
-        // Print the root (largest element)
-        printf("Supplier ID: %lu\n", heap[0].data.Supplier_ID);
-        printf("  Name: %s\n", heap[0].data.Supplier_Name);
-        printf("  Number of Unique Medicines: %u\n", heap[0].data.noOfUniqueMedicines);
-        printf("  Total Turnover: %lu\n", heap[0].data.turnoverProduced);
-        printf("----------------------------------------\n");
-
-        // Replace the root with the last element and reduce the heap size
-        heap[0] = heap[size - 1];
-        size--;
-
-        // Heapify down to maintain the max-heap property
-        heapifyDown(heap, size, 0, sortByTurnover);
-
-        count++;
+    node->isLeaf = isLeaf;
+    if (isLeaf) {
+        node->leaf.values = (MedicationData**)(node + 1);
+        node->leaf.order = order;
+        node->leaf.cursize = 0;
+        node->leaf.next = NULL;
+        node->leaf.prev = NULL;
+        node->leaf.parent = NULL;
+    } else {
+        node->internal.keys = (NameKey*)(node + 1);
+        node->internal.children = (NameIndexNode**)(node->internal.keys + order);
+        node->internal.order = order;
+        node->internal.cursize = 0;
+        node->internal.parent = NULL;
     }
+    return node;
+}
 
-    printf("======================================================\n");
+// Descends to the leaf that holds (name, id), or where it would go.
+static NameIndexNode* findNameIndexLeaf(NameIndex *index, const char *name, unsigned long id) {
+    NameIndexNode *current = index->root;
+    while (current && !current->isLeaf) {
+        NameIndexInternalNode *node = &(current->internal);
+        int low = 0, high = node->cursize;
+        while (low < high) {
+            int mid = (low + high) / 2;
+            if (compareNameKey(name, id, node->keys[mid].name, node->keys[mid].id) >= 0) low = mid + 1;
+            else high = mid;
+        }
+        current = node->children[low];
+    }
+    return current;
 }
 
-//=====================================================================================================================
+// First position in the leaf whose entry is >= (name, id).
+static int nameIndexLowerBound(NameIndexLeafNode *leaf, const char *name, unsigned long id) {
+    int low = 0, high = leaf->cursize;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        const MedicationData *entry = leaf->values[mid];
+        if (compareNameKey(entry->Medicine_Name, entry->Medication_ID, name, id) < 0) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
 
-bool deleteMedication(MedicationBPlusTree **Btree) {
-    unsigned long id;
-    printf("Enter the Medication ID to delete: ");
-    scanf("%lu", &id);
+static void insertIntoNameIndexParent(NameIndex *index, NameIndexNode *leftNode, const NameKey *midKey, NameIndexNode *rightNode) {
+    NameIndexInternalNode *parent = leftNode->isLeaf ? leftNode->leaf.parent : leftNode->internal.parent;
 
-    MedicationBPlusTree *tree = *Btree;
-    if (!tree || !tree->root) {
-        printf("Leaf node not found for ID %lu.\n", id);
-        return false; // Tree is empty
+    if (!parent) {
+        NameIndexNode *newRoot = createNameIndexNode(index, false);
+        newRoot->internal.keys[0] = *midKey;
+        newRoot->internal.children[0] = leftNode;
+        newRoot->internal.children[1] = rightNode;
+        newRoot->internal.cursize = 1;
+        if (leftNode->isLeaf) {
+            leftNode->leaf.parent = &(newRoot->internal);
+            rightNode->leaf.parent = &(newRoot->internal);
+        } else {
+            leftNode->internal.parent = &(newRoot->internal);
+            rightNode->internal.parent = &(newRoot->internal);
+        }
+        index->root = newRoot;
+        return;
     }
 
-    // Find the leaf node containing the key
-    MedicationNode *current = tree->root;
-    MedicationInternalNode *parent = NULL;
-    int parentIndex = 0;
+    // Slot right after the left child
+    int pos = 0;
+    while (parent->children[pos] != leftNode) pos++;
 
-    // Track the path to the leaf node (for possible rebalancing)
-    MedicationInternalNode *path[256];  // Assumes tree height < 256
-    int pathIndices[256];
-    int pathLen = 0;
+    memmove(&parent->keys[pos + 1], &parent->keys[pos], (parent->cursize - pos) * sizeof(NameKey));
+    memmove(&parent->children[pos + 2], &parent->children[pos + 1], (parent->cursize - pos) * sizeof(NameIndexNode*));
+    parent->keys[pos] = *midKey;
+    parent->children[pos + 1] = rightNode;
+    parent->cursize++;
+    if (rightNode->isLeaf) rightNode->leaf.parent = parent;
+    else rightNode->internal.parent = parent;
 
-    // Navigate to the leaf node
-    while (!current->isLeaf) {
-        parent = &(current->internal);
-        path[pathLen] = parent;
-        
-        int i;
-        for (i = 0; i < parent->cursize; i++) {
-            if (id < parent->keys[i]) break;
-        }
-        
-        pathIndices[pathLen] = i;
-        pathLen++;
-        current = parent->children[i];  
-    }
+    if (parent->cursize < parent->order) return;
 
-    // Now we're at the leaf node
-    MedicationLeafNode *leaf = &(current->leaf);
-    int keyIndex = -1;
+    // Parent overflowed: move the upper half to a new node and push the middle key up
+    NameIndexNode *parentNode = NODE_FROM_MEMBER(parent, NameIndexNode);
+    NameIndexNode *sibling = createNameIndexNode(index, false);
+    int mid = parent->cursize / 2;
+    NameKey upKey = parent->keys[mid];
 
-    // Find the key in the leaf node
-    for (int i = 0; i < leaf->cursize; i++) {
-        if (leaf->keys[i] == id) {
-            keyIndex = i;
-            break;
-        }
-    }
+    int moved = parent->cursize - mid - 1;
+    memcpy(sibling->internal.keys, &parent->keys[mid + 1], moved * sizeof(NameKey));
+    memcpy(sibling->internal.children, &parent->children[mid + 1], (moved + 1) * sizeof(NameIndexNode*));
+    sibling->internal.cursize = moved;
+    parent->cursize = mid;
 
-    if (keyIndex == -1) {
-        printf("Medication ID %lu not found in the tree.\n", id);
-        return false; // Key not found
+    for (int i = 0; i <= moved; i++) {
+        NameIndexNode *child = sibling->internal.children[i];
+        if (child->isLeaf) child->leaf.parent = &(sibling->internal);
+        else child->internal.parent = &(sibling->internal);
     }
 
-    // Delete the key from the leaf node
-    for (int i = keyIndex; i < leaf->cursize - 1; i++) {
-        leaf->keys[i] = leaf->keys[i + 1];
-        leaf->values[i] = leaf->values[i + 1];
-    }
-    leaf->cursize--;
+    insertIntoNameIndexParent(index, parentNode, &upKey, sibling);
+}
 
-    // Case 1: Leaf node has enough keys after deletion (at least order/2)
-    int minKeys = (leaf->order - 1) / 2;
-    if (leaf->cursize >= minKeys) {
-        return true; // No further adjustment needed
+void nameIndexInsert(NameIndex *index, MedicationData *record) {
+    if (!index->root) {
+        NameIndexNode *first = createNameIndexNode(index, true);
+        first->leaf.values[0] = record;
+        first->leaf.cursize = 1;
+        index->root = first;
+        index->leftmost_leaf = &(first->leaf);
+        return;
     }
 
-    // Case 2: Leaf node is the root
-    if (pathLen == 0) {
-        if (leaf->cursize == 0) {
-            // Tree becomes empty
-            free(leaf->keys);
-            free(leaf->values);
-            free(tree->root);
-            tree->root = NULL;
-            tree->leftmost_leaf = NULL;
-        }
-        return true;
-    }
+    NameIndexNode *leafNode = findNameIndexLeaf(index, record->Medicine_Name, record->Medication_ID);
+    NameIndexLeafNode *leaf = &(leafNode->leaf);
+    int pos = nameIndexLowerBound(leaf, record->Medicine_Name, record->Medication_ID);
 
-    // Case 3:If the left sibling has more than the minimum number of keys, the function borrows the rightmost key from the left sibling.
-    // Updates the parent key to reflect the new key in the leaf node.
-    while (pathLen > 0) {
-        pathLen--;
-        parent = path[pathLen];
-        int childIndex = pathIndices[pathLen];
-        
-        // Try to borrow from left sibling
-        if (childIndex > 0) {
-            MedicationNode *leftSibling = parent->children[childIndex - 1];
-            
-            if (leftSibling->isLeaf) {
-                MedicationLeafNode *leftLeaf = &(leftSibling->leaf);
-                
-                if (leftLeaf->cursize > minKeys) {
-                    // Borrow the rightmost key from left sibling
-                    for (int i = leaf->cursize; i > 0; i--) {
-                        leaf->keys[i] = leaf->keys[i - 1];
-                        leaf->values[i] = leaf->values[i - 1];
-                    }
-                    
-                    leaf->keys[0] = leftLeaf->keys[leftLeaf->cursize - 1];
-                    leaf->values[0] = leftLeaf->values[leftLeaf->cursize - 1];
-                    
-                    leftLeaf->cursize--;
-                    leaf->cursize++;
-                    
-                    // Update parent key
-                    parent->keys[childIndex - 1] = leaf->keys[0];
-                    
-                    return true;
-                }
-            }
-        }
+    memmove(&leaf->values[pos + 1], &leaf->values[pos], (leaf->cursize - pos) * sizeof(MedicationData*));
+    leaf->values[pos] = record;
+    leaf->cursize++;
 
-        //If the right sibling has more than the minimum number of keys, the function borrows the leftmost key from the right sibling.
-        // Updates the parent key to reflect the new key in the right sibling.
-        // Try to borrow from right sibling
+    if (leaf->cursize < leaf->order) return;
 
-        if (childIndex < parent->cursize) {
-            MedicationNode *rightSibling = parent->children[childIndex + 1];
-            
-            if (rightSibling->isLeaf) {
-                MedicationLeafNode *rightLeaf = &(rightSibling->leaf);
-                
-                if (rightLeaf->cursize > minKeys) {
-                    // Borrow the leftmost key from right sibling
-                    leaf->keys[leaf->cursize] = rightLeaf->keys[0];
-                    leaf->values[leaf->cursize] = rightLeaf->values[0];
-                    leaf->cursize++;
-                    
-                    // Shift keys in right sibling
-                    for (int i = 0; i < rightLeaf->cursize - 1; i++) {
-                        rightLeaf->keys[i] = rightLeaf->keys[i + 1];
-                        rightLeaf->values[i] = rightLeaf->values[i + 1];
-                    }
-                    rightLeaf->cursize--;
-                    
-                    // Update parent key
-                    parent->keys[childIndex] = rightLeaf->keys[0];
-                    
-                    return true;
-                }
-            }
-        }
-        
-        // Merge with a sibling
-        //If borrowing is not possible, the function merges the leaf node with its left sibling.
-        // Updates the parent node by removing the key corresponding to the merged node.
-        if (childIndex > 0) {
-            // Merge with left sibling
-            MedicationNode *leftSibling = parent->children[childIndex - 1];
-            
-            if (leftSibling->isLeaf) {
-                MedicationLeafNode *leftLeaf = &(leftSibling->leaf);
-                
-                // Copy keys and values from current leaf to left leaf
-                for (int i = 0; i < leaf->cursize; i++) {
-                    leftLeaf->keys[leftLeaf->cursize + i] = leaf->keys[i];
-                    leftLeaf->values[leftLeaf->cursize + i] = leaf->values[i];
-                }
-                
-                leftLeaf->cursize += leaf->cursize;
-                leftLeaf->next = leaf->next;
-                
-                if (leaf->next) {
-                    leaf->next->prev = leftLeaf;
-                }
-                
-                // Remove the parent key and adjust parent's children
-                for (int i = childIndex - 1; i < parent->cursize - 1; i++) {
-                    parent->keys[i] = parent->keys[i + 1];
-                    parent->children[i + 1] = parent->children[i + 2];
-                }
-                parent->cursize--;
-                
-                // Free the merged node
-                free(leaf->keys);
-                free(leaf->values);
-                free(current);
-                
-                // If parent is now empty and is the root, update root
-                if (parent->cursize == 0 && pathLen == 0) {
-                    tree->root = parent->children[0];
-                    if(tree->root->isLeaf) {
-                        tree->root->leaf.parent = NULL;
-                    } 
-                    else {
-                        tree->root->internal.parent = NULL; 
-                    }
-                    
-                    free(parent->keys);
-                    free(parent->children);
-                    free(path[0]);
-                }
-                
-                return true;
-            }
-        } else {
-            // Merge with right sibling
-            //If merging with the left sibling is not possible, the function merges the leaf node with its right sibling.
-            // Updates the parent node by removing the key corresponding to the merged node.
-            MedicationNode *rightSibling = parent->children[childIndex + 1];
-            
-            if (rightSibling->isLeaf) {
-                MedicationLeafNode *rightLeaf = &(rightSibling->leaf);
-                
-                // Copy keys and values from right leaf to current leaf
-                for (int i = 0; i < rightLeaf->cursize; i++) {
-                    leaf->keys[leaf->cursize + i] = rightLeaf->keys[i];
-                    leaf->values[leaf->cursize + i] = rightLeaf->values[i];
-                }
-                
-                leaf->cursize += rightLeaf->cursize;
-                leaf->next = rightLeaf->next;
-                
-                if (rightLeaf->next) {
-                    rightLeaf->next->prev = leaf;
-                }
-                
-                // Remove the parent key and adjust parent's children
-                for (int i = childIndex; i < parent->cursize - 1; i++) {
-                    parent->keys[i] = parent->keys[i + 1];
-                    parent->children[i + 1] = parent->children[i + 2];
-                }
-                parent->cursize--;
-                
-                // Free the merged node
-                free(rightLeaf->keys);
-                free(rightLeaf->values);
-                free(rightSibling);
-                
-                // If parent is now empty and is the root, update root
-                if (parent->cursize == 0 && pathLen == 0) {
-                    tree->root = parent->children[0];
-                    // Update the root's parent pointer
-                    if(tree->root->isLeaf) {
-                        tree->root->leaf.parent = NULL;
-                    } 
-                    else {
-                        tree->root->internal.parent = NULL; 
-                    }
-                    
-                    free(parent->keys);
-                    free(parent->children);
-                    free(path[0]);
-                }
-                
-                return true;
-            }
-        }
-        
-        // If we get here, we need to rebalance the parent
-        if (parent->cursize < minKeys && pathLen > 0) {
-            // Continue up the tree and balance the parent
-            current = path[pathLen - 1]->children[pathIndices[pathLen - 1]];
-        } else {
-            break; // Parent has enough keys
-        }
-    }
-    
-    return true;
-}
+    // Leaf overflowed: split it in half and link the new leaf in after it
+    NameIndexNode *newLeaf = createNameIndexNode(index, true);
+    int mid = leaf->cursize / 2;
+    int moved = leaf->cursize - mid;
+    memcpy(newLeaf->leaf.values, &leaf->values[mid], moved * sizeof(MedicationData*));
+    newLeaf->leaf.cursize = moved;
+    leaf->cursize = mid;
 
-void printMedicationDetails(MedicationData* medication) {
-    printf("\n=== MEDICATION DETAILS ===\n");
-    printf("ID: %lu\n", medication->Medication_ID);
-    printf("Name: %s\n", medication->Medicine_Name);
-    printf("Quantity in stock: %u\n", medication->Quantity_in_stock);
-    printf("Price per unit: $%u\n", medication->Price_per_Unit);
-    printf("Reorder level: %d\n", medication->Reorderlevel);
-    printf("Batch: %s\n", medication->Batch_details.Batch);
-    printf("Expiration date: %d-%d-%d\n", 
-           medication->Batch_details.Expiration_Date.day,
-           medication->Batch_details.Expiration_Date.month,
-           medication->Batch_details.Expiration_Date.year);
-    printf("Total sales: %d\n", medication->Batch_details.Total_sales);
-}
+    newLeaf->leaf.next = leaf->next;
+    newLeaf->leaf.prev = leaf;
+    if (leaf->next) leaf->next->prev = &(newLeaf->leaf);
+    leaf->next = &(newLeaf->leaf);
 
-void printSupplier(SupplierData* supplier) {
-    printf("  - Supplier ID: %lu\n", supplier->Supplier_ID);
-    printf("    Name: %s\n", supplier->Supplier_Name);
-    printf("    Quantity: %u\n", supplier->Quantity_of_stock_bysupplier);
-    printf("    Contact: %s\n", supplier->Contact);
+    NameKey midKey;
+    makeNameKey(&midKey, newLeaf->leaf.values[0]);
+    insertIntoNameIndexParent(index, leafNode, &midKey, newLeaf);
 }
 
-void printAllSuppliers(SupplierBPlusTree* tree) {
-    if (!tree || !tree->root) {
-        printf("  No suppliers for this medication.\n");
-        return;
-    }
-    
-    printf("\n  --- SUPPLIERS ---\n");
-    
-    // Start at the leftmost leaf
-    SupplierLeafNode* current = tree->leftmost_leaf;
-    
-    // Traverse all leaf nodes
-    while (current != NULL) {
-        for (int i = 0; i < current->cursize; i++) {
-            printSupplier(&current->values[i]);
-            printf("\n");
-        }
-        current = current->next;
-    }
-}
+// Unlinks an empty child from its parent, collapsing parents that run out of
+// children. Underfull nodes are otherwise left alone; lookups stay O(log n).
+static void removeNameIndexChild(NameIndex *index, NameIndexInternalNode *parent, NameIndexNode *child) {
+    int pos = 0;
+    while (parent->children[pos] != child) pos++;
 
+    // Dropping child i removes the separator to its left (or right, for the first child)
+    int keyPos = (pos > 0) ? pos - 1 : 0;
+    memmove(&parent->keys[keyPos], &parent->keys[keyPos + 1], (parent->cursize - keyPos - 1) * sizeof(NameKey));
+    memmove(&parent->children[pos], &parent->children[pos + 1], (parent->cursize - pos) * sizeof(NameIndexNode*));
+    parent->cursize--;
 
-void printMedicationBPlusTree(MedicationBPlusTree* tree) {
-    if (!tree || !tree->root) {
-        printf("The medication B+ tree is empty.\n");
-        return;
-    }
-    
-    printf("\n======================================================\n");
-    printf("           MEDICATION B+ TREE (Order: %d)              \n", tree->order);
-    printf("======================================================\n");
-    
-    // Start from the leftmost leaf
-    MedicationLeafNode* current = tree->leftmost_leaf;
+    if (parent->cursize > 0) return;
+    NameIndexNode *parentNode = NODE_FROM_MEMBER(parent, NameIndexNode);
 
-    // Traverse all leaf nodes
-    while (current != NULL) {
-        for (int i = 0; i < current->cursize; i++) {
-            printf("\nMedication %d:\n", i + 1);
-            printMedicationDetails(&current->values[i]);
-            printAllSuppliers(current->values[i].Suppliers);
-        }
-        current = current->next; // Move to the next leaf node
-    }
+    // One child left: splice it into the grandparent's slot
+    NameIndexNode *only = parent->children[0];
+    NameIndexInternalNode *grandparent = parent->parent;
+    if (only->isLeaf) only->leaf.parent = grandparent;
+    else only->internal.parent = grandparent;
 
-    printf("\n======================================================\n");
+    if (!grandparent) {
+        index->root = only;
+    } else {
+        int slot = 0;
+        while (grandparent->children[slot] != parentNode) slot++;
+        grandparent->children[slot] = only;
+    }
+    poolFree(&index->internalNodes, parentNode);
 }
 
-bool deleteSupplier(SupplierBPlusTree **Btree) {
-    unsigned long id;
-    printf("Enter the Supplier ID to delete: ");
-    scanf("%lu", &id);
+void nameIndexRemove(NameIndex *index, const MedicationData *record) {
+    NameIndexNode *leafNode = findNameIndexLeaf(index, record->Medicine_Name, record->Medication_ID);
+    if (!leafNode) return;
 
-    SupplierBPlusTree *tree = *Btree;
-    if (!tree || !tree->root) {
-        return false; // Tree is empty
+    NameIndexLeafNode *leaf = &(leafNode->leaf);
+    int pos = nameIndexLowerBound(leaf, record->Medicine_Name, record->Medication_ID);
+    if (pos == leaf->cursize || leaf->values[pos] != record) return;
+
+    memmove(&leaf->values[pos], &leaf->values[pos + 1], (leaf->cursize - pos - 1) * sizeof(MedicationData*));
+    leaf->cursize--;
+    if (leaf->cursize > 0) return;
+
+    // Empty leaf: take it out of the chain and the tree
+    if (leaf->prev) leaf->prev->next = leaf->next;
+    else index->leftmost_leaf = leaf->next;
+    if (leaf->next) leaf->next->prev = leaf->prev;
+
+    if (leaf->parent) {
+        removeNameIndexChild(index, leaf->parent, leafNode);
+    } else {
+        index->root = NULL;
     }
+    poolFree(&index->leafNodes, leafNode);
+}
 
-    // Find the leaf node containing the key
-    SupplierNode *current = tree->root;
-    SupplierInternalNode *parent = NULL;
-    int parentIndex = 0;
+static int compareRecordsByName(const void *a, const void *b) {
+    const MedicationData *x = *(MedicationData* const*)a;
+    const MedicationData *y = *(MedicationData* const*)b;
+    return compareNameKey(x->Medicine_Name, x->Medication_ID, y->Medicine_Name, y->Medication_ID);
+}
 
-    // Track the path to the leaf node (for possible rebalancing)
-    SupplierInternalNode *path[256];  // Assumes tree height < 256
-    int pathIndices[256];
-    int pathLen = 0;
+// Builds an empty index bottom-up from records (in any order).
+bool nameIndexBuild(NameIndex *index, MedicationData **records, int count, double fillFactor) {
+    if (index->root) return false;
+    if (count == 0) return true;
+
+    MedicationData **sorted = (MedicationData**)malloc(sizeof(MedicationData*) * count);
+    if (!sorted) return false;
+    memcpy(sorted, records, sizeof(MedicationData*) * count);
+    qsort(sorted, count, sizeof(MedicationData*), compareRecordsByName);
+
+    int order = index->order;
+    int perLeaf = bulkLoadNodeSlots(order - 1, fillFactor);
+    int perInternal = bulkLoadNodeSlots(order, fillFactor);
+    if (perInternal < 3 && order >= 3) perInternal = 3;
+
+    int levelSize = bulkLoadNodeCount(count, perLeaf);
+    NameIndexNode **level = (NameIndexNode**)malloc(sizeof(NameIndexNode*) * levelSize);
+    MedicationData **lowKeys = (MedicationData**)malloc(sizeof(MedicationData*) * levelSize);
+    if (!level || !lowKeys) {
+        free(level);
+        free(lowKeys);
+        free(sorted);
+        return false;
+    }
+
+    NameIndexLeafNode *prev = NULL;
+    int next = 0;
+    for (int i = 0; i < levelSize; i++) {
+        int take = count / levelSize + (i < count % levelSize);
+        NameIndexNode *node = createNameIndexNode(index, true);
+        NameIndexLeafNode *leaf = &(node->leaf);
+
+        memcpy(leaf->values, &sorted[next], take * sizeof(MedicationData*));
+        next += take;
+        leaf->cursize = take;
+        leaf->prev = prev;
+        if (prev) prev->next = leaf;
+        else index->leftmost_leaf = leaf;
+        prev = leaf;
+
+        level[i] = node;
+        lowKeys[i] = leaf->values[0];
+    }
+
+    while (levelSize > 1) {
+        int parents = bulkLoadNodeCount(levelSize, perInternal);
+        next = 0;
+        for (int i = 0; i < parents; i++) {
+            int take = levelSize / parents + (i < levelSize % parents);
+            NameIndexNode *node = createNameIndexNode(index, false);
+            NameIndexInternalNode *internal = &(node->internal);
+            MedicationData *lowKey = lowKeys[next];
+
+            for (int j = 0; j < take; j++, next++) {
+                NameIndexNode *child = level[next];
+                internal->children[j] = child;
+                if (j > 0) makeNameKey(&internal->keys[j - 1], lowKeys[next]);
+                if (child->isLeaf) child->leaf.parent = internal;
+                else child->internal.parent = internal;
+            }
+            internal->cursize = take - 1;
 
-    // Navigate to the leaf node
-    while (!current->isLeaf) {
-        parent = &(current->internal);
-        path[pathLen] = parent;
-        
-        int i;
-        for (i = 0; i < parent->cursize; i++) {
-            if (id < parent->keys[i]) break;
+            level[i] = node;
+            lowKeys[i] = lowKey;
         }
-        
-        pathIndices[pathLen] = i;
-        pathLen++;
-        current = parent->children[i];
+        levelSize = parents;
     }
+    index->root = level[0];
 
-    // Now we're at the leaf node
-    SupplierLeafNode *leaf = &(current->leaf);
-    int keyIndex = -1;
+    free(level);
+    free(lowKeys);
+    free(sorted);
+    return true;
+}
 
-    // Find the key in the leaf node
-    for (int i = 0; i < leaf->cursize; i++) {
-        if (leaf->keys[i] == id) {
-            keyIndex = i;
-            break;
+// Calls visit for every medication whose name matches, in (name, ID) order.
+// Exact matching is case-sensitive; the other modes ignore case. Returns the match count.
+int findMedicationsByName(MedicationBPlusTree *tree, const char *name, NameMatch match,
+                          void (*visit)(MedicationData *medication, void *context), void *context) {
+    NameIndexNode *leafNode = findNameIndexLeaf(&tree->names, name, 0);
+    if (!leafNode) return 0;
+
+    NameIndexLeafNode *leaf = &(leafNode->leaf);
+    int pos = nameIndexLowerBound(leaf, name, 0);
+    int found = 0;
+
+    for (; leaf; leaf = leaf->next, pos = 0) {
+        for (; pos < leaf->cursize; pos++) {
+            MedicationData *entry = leaf->values[pos];
+            bool inRange = (match == NAME_MATCH_PREFIX)
+                ? hasPrefixIgnoringCase(entry->Medicine_Name, name)
+                : compareNamesIgnoringCase(entry->Medicine_Name, name) == 0;
+            if (!inRange) return found;
+
+            if (match == NAME_MATCH_EXACT && strcmp(entry->Medicine_Name, name) != 0) continue;
+            found++;
+            if (visit) visit(entry, context);
         }
     }
+    return found;
+}
 
-    if (keyIndex == -1) {
-        return false; // Key not found
-    }
+// Overwrites a stored record with data, keeping the name index (and the name
+// copied into the expiration tree) in step when the name changes. A different
+// supplier tree in data replaces the record's, which is released.
+void replaceMedicationRecord(MedicationBPlusTree *tree, MedicationData *record, const MedicationData *data) {
+    bool renamed = strcmp(record->Medicine_Name, data->Medicine_Name) != 0;
+    if (renamed) nameIndexRemove(&tree->names, record);
 
-    // Delete the key from the leaf node
-    for (int i = keyIndex; i < leaf->cursize - 1; i++) {
-        leaf->keys[i] = leaf->keys[i + 1];
-        leaf->values[i] = leaf->values[i + 1];
-    }
-    leaf->cursize--;
+    SupplierBPlusTree *oldSuppliers = record->Suppliers;
+    unsigned long long oldExpirationKey = medicationExpirationKey(record);
+    *record = *data;
 
-    // Case 1: Leaf node has enough keys after deletion
-    int minKeys = (leaf->order - 1) / 2;
-    if (leaf->cursize >= minKeys) {
-        return true;
-    }
+    if (renamed) nameIndexInsert(&tree->names, record);
 
-    // Case 2: Leaf node is the root
-    if (pathLen == 0) {
-        if (leaf->cursize == 0) {
-            free(leaf->keys);
-            free(leaf->values);
-            free(tree->root);
-            tree->root = NULL;
-            tree->leftmost_leaf = NULL;
-        }
-        return true;
+    // A new expiry date moves the expiration entry; a new name is copied into it
+    unsigned long long expirationKey = medicationExpirationKey(record);
+    if (expirationKey != oldExpirationKey) {
+        deleteFromExpirationTree(expirationTree, oldExpirationKey);
+        insertIntoExpirationTree(expirationTree, expirationKey, record->Medication_ID, record->Medicine_Name);
+    } else if (renamed) {
+        renameExpirationEntry(expirationTree, expirationKey, record->Medicine_Name);
     }
+    if (record->Suppliers != oldSuppliers) {
+        releaseSupplierBPlusTree(tree, oldSuppliers);
+        attachSupplierTree(tree, record);
+    }
+    lowStockUpdate(&tree->lowStock, record);
+}
 
-    // Case 3: Leaf node has fewer than minimum keys - need to borrow or merge
-    while (pathLen > 0) {
-        pathLen--;
-        parent = path[pathLen];
-        int childIndex = pathIndices[pathLen];
+bool renameMedication(MedicationBPlusTree *tree, unsigned long id, const char *newName) {
+    MedicationData *record = findMedication(tree, id);
+    if (!record) return false;
 
-        // Try to borrow from left sibling
-        if (childIndex > 0) {
-            SupplierNode *leftSibling = parent->children[childIndex - 1];
-            
-            if (leftSibling->isLeaf) {
-                SupplierLeafNode *leftLeaf = &(leftSibling->leaf);
-                
-                if (leftLeaf->cursize > minKeys) {
-                    // Borrow from left sibling
-                    for (int i = leaf->cursize; i > 0; i--) {
-                        leaf->keys[i] = leaf->keys[i - 1];
-                        leaf->values[i] = leaf->values[i - 1];
-                    }
-                    leaf->keys[0] = leftLeaf->keys[leftLeaf->cursize - 1];
-                    leaf->values[0] = leftLeaf->values[leftLeaf->cursize - 1];
-                    
-                    leftLeaf->cursize--;
-                    leaf->cursize++;
-                    
-                    parent->keys[childIndex - 1] = leaf->keys[0];
-                    return true;
-                }
-            }
-        }
+    MedicationData data = *record;
+    strncpy(data.Medicine_Name, newName, NAME_SIZE - 1);
+    data.Medicine_Name[NAME_SIZE - 1] = '\0';
+    replaceMedicationRecord(tree, record, &data);
+    walLogMedication(WAL_UPDATE_MEDICATION, record);
+    return true;
+}
+
+//==============================================================================
+// Supplier postings: (Supplier_ID, Medication_ID) pairs for "which medications
+// does this supplier provide" in O(log n + k). Entries are added and removed by
+// the supplier trees themselves once their medication is in the tree.
+
+static int compareSupplierPostings(const SupplierPosting *a, const SupplierPosting *b) {
+    if (a->supplierID != b->supplierID) return (a->supplierID < b->supplierID) ? -1 : 1;
+    return (a->medicationID > b->medicationID) - (a->medicationID < b->medicationID);
+}
+
+static int compareSupplierPostingEntries(const void *a, const void *b) {
+    return compareSupplierPostings((const SupplierPosting*)a, (const SupplierPosting*)b);
+}
+
+void supplierPostingsInit(SupplierPostings *postings, int order) {
+    postings->root = NULL;
+    postings->order = order;
+    postings->leftmost_leaf = NULL;
+    poolInit(&postings->leafNodes, sizeof(SupplierPostingNode) + order * sizeof(SupplierPosting));
+    poolInit(&postings->internalNodes, sizeof(SupplierPostingNode) + order * sizeof(SupplierPosting) + (order + 1) * sizeof(SupplierPostingNode*));
+}
+
+void supplierPostingsDestroy(SupplierPostings *postings) {
+    poolDestroy(&postings->leafNodes);
+    poolDestroy(&postings->internalNodes);
+    postings->root = NULL;
+    postings->leftmost_leaf = NULL;
+}
+
+static SupplierPostingNode* createSupplierPostingNode(SupplierPostings *postings, bool isLeaf) {
+    int order = postings->order;
+    SupplierPostingNode *node = (SupplierPostingNode*)poolAlloc(isLeaf ? &postings->leafNodes : &postings->internalNodes);
+    if (!node) return NULL;
+
+    node->isLeaf = isLeaf;
+    if (isLeaf) {
+        node->leaf.entries = (SupplierPosting*)(node + 1);
+        node->leaf.order = order;
+        node->leaf.cursize = 0;
+        node->leaf.next = NULL;
+        node->leaf.prev = NULL;
+        node->leaf.parent = NULL;
+    } else {
+        node->internal.keys = (SupplierPosting*)(node + 1);
+        node->internal.children = (SupplierPostingNode**)(node->internal.keys + order);
+        node->internal.order = order;
+        node->internal.cursize = 0;
+        node->internal.parent = NULL;
+    }
+    return node;
+}
+
+// Descends to the leaf that holds key, or where it would go.
+static SupplierPostingNode* findSupplierPostingLeaf(SupplierPostings *postings, const SupplierPosting *key) {
+    SupplierPostingNode *current = postings->root;
+    while (current && !current->isLeaf) {
+        SupplierPostingInternalNode *node = &(current->internal);
+        int low = 0, high = node->cursize;
+        while (low < high) {
+            int mid = (low + high) / 2;
+            if (compareSupplierPostings(key, &node->keys[mid]) >= 0) low = mid + 1;
+            else high = mid;
+        }
+        current = node->children[low];
+    }
+    return current;
+}
+
+// First position in the leaf whose entry is >= key.
+static int supplierPostingLowerBound(SupplierPostingLeafNode *leaf, const SupplierPosting *key) {
+    int low = 0, high = leaf->cursize;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (compareSupplierPostings(&leaf->entries[mid], key) < 0) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+static void insertIntoSupplierPostingParent(SupplierPostings *postings, SupplierPostingNode *leftNode, const SupplierPosting *midKey, SupplierPostingNode *rightNode) {
+    SupplierPostingInternalNode *parent = leftNode->isLeaf ? leftNode->leaf.parent : leftNode->internal.parent;
+
+    if (!parent) {
+        SupplierPostingNode *newRoot = createSupplierPostingNode(postings, false);
+        newRoot->internal.keys[0] = *midKey;
+        newRoot->internal.children[0] = leftNode;
+        newRoot->internal.children[1] = rightNode;
+        newRoot->internal.cursize = 1;
+        if (leftNode->isLeaf) {
+            leftNode->leaf.parent = &(newRoot->internal);
+            rightNode->leaf.parent = &(newRoot->internal);
+        } else {
+            leftNode->internal.parent = &(newRoot->internal);
+            rightNode->internal.parent = &(newRoot->internal);
+        }
+        postings->root = newRoot;
+        return;
+    }
+
+    // Slot right after the left child
+    int pos = 0;
+    while (parent->children[pos] != leftNode) pos++;
+
+    memmove(&parent->keys[pos + 1], &parent->keys[pos], (parent->cursize - pos) * sizeof(SupplierPosting));
+    memmove(&parent->children[pos + 2], &parent->children[pos + 1], (parent->cursize - pos) * sizeof(SupplierPostingNode*));
+    parent->keys[pos] = *midKey;
+    parent->children[pos + 1] = rightNode;
+    parent->cursize++;
+    if (rightNode->isLeaf) rightNode->leaf.parent = parent;
+    else rightNode->internal.parent = parent;
+
+    if (parent->cursize < parent->order) return;
+
+    // Parent overflowed: move the upper half to a new node and push the middle key up
+    SupplierPostingNode *parentNode = NODE_FROM_MEMBER(parent, SupplierPostingNode);
+    SupplierPostingNode *sibling = createSupplierPostingNode(postings, false);
+    int mid = parent->cursize / 2;
+    SupplierPosting upKey = parent->keys[mid];
+
+    int moved = parent->cursize - mid - 1;
+    memcpy(sibling->internal.keys, &parent->keys[mid + 1], moved * sizeof(SupplierPosting));
+    memcpy(sibling->internal.children, &parent->children[mid + 1], (moved + 1) * sizeof(SupplierPostingNode*));
+    sibling->internal.cursize = moved;
+    parent->cursize = mid;
+
+    for (int i = 0; i <= moved; i++) {
+        SupplierPostingNode *child = sibling->internal.children[i];
+        if (child->isLeaf) child->leaf.parent = &(sibling->internal);
+        else child->internal.parent = &(sibling->internal);
+    }
+
+    insertIntoSupplierPostingParent(postings, parentNode, &upKey, sibling);
+}
+
+// Adds (supplierID, medication); a pair that is already posted is left as is.
+void supplierPostingsInsert(SupplierPostings *postings, unsigned long supplierID, MedicationData *medication) {
+    SupplierPosting entry = { supplierID, medication->Medication_ID, medication };
+
+    if (!postings->root) {
+        SupplierPostingNode *first = createSupplierPostingNode(postings, true);
+        first->leaf.entries[0] = entry;
+        first->leaf.cursize = 1;
+        postings->root = first;
+        postings->leftmost_leaf = &(first->leaf);
+        return;
+    }
+
+    SupplierPostingNode *leafNode = findSupplierPostingLeaf(postings, &entry);
+    SupplierPostingLeafNode *leaf = &(leafNode->leaf);
+    int pos = supplierPostingLowerBound(leaf, &entry);
+    if (pos < leaf->cursize && compareSupplierPostings(&leaf->entries[pos], &entry) == 0) {
+        leaf->entries[pos].medication = medication;
+        return;
+    }
+
+    memmove(&leaf->entries[pos + 1], &leaf->entries[pos], (leaf->cursize - pos) * sizeof(SupplierPosting));
+    leaf->entries[pos] = entry;
+    leaf->cursize++;
+
+    if (leaf->cursize < leaf->order) return;
+
+    // Leaf overflowed: split it in half and link the new leaf in after it
+    SupplierPostingNode *newLeaf = createSupplierPostingNode(postings, true);
+    int mid = leaf->cursize / 2;
+    int moved = leaf->cursize - mid;
+    memcpy(newLeaf->leaf.entries, &leaf->entries[mid], moved * sizeof(SupplierPosting));
+    newLeaf->leaf.cursize = moved;
+    leaf->cursize = mid;
+
+    newLeaf->leaf.next = leaf->next;
+    newLeaf->leaf.prev = leaf;
+    if (leaf->next) leaf->next->prev = &(newLeaf->leaf);
+    leaf->next = &(newLeaf->leaf);
+
+    insertIntoSupplierPostingParent(postings, leafNode, &newLeaf->leaf.entries[0], newLeaf);
+}
+
+// Unlinks an empty child from its parent, collapsing parents that run out of
+// children. As in the name index, underfull nodes are otherwise left alone.
+static void removeSupplierPostingChild(SupplierPostings *postings, SupplierPostingInternalNode *parent, SupplierPostingNode *child) {
+    int pos = 0;
+    while (parent->children[pos] != child) pos++;
+
+    int keyPos = (pos > 0) ? pos - 1 : 0;
+    memmove(&parent->keys[keyPos], &parent->keys[keyPos + 1], (parent->cursize - keyPos - 1) * sizeof(SupplierPosting));
+    memmove(&parent->children[pos], &parent->children[pos + 1], (parent->cursize - pos) * sizeof(SupplierPostingNode*));
+    parent->cursize--;
+
+    if (parent->cursize > 0) return;
+    SupplierPostingNode *parentNode = NODE_FROM_MEMBER(parent, SupplierPostingNode);
+
+    // One child left: splice it into the grandparent's slot
+    SupplierPostingNode *only = parent->children[0];
+    SupplierPostingInternalNode *grandparent = parent->parent;
+    if (only->isLeaf) only->leaf.parent = grandparent;
+    else only->internal.parent = grandparent;
+
+    if (!grandparent) {
+        postings->root = only;
+    } else {
+        int slot = 0;
+        while (grandparent->children[slot] != parentNode) slot++;
+        grandparent->children[slot] = only;
+    }
+    poolFree(&postings->internalNodes, parentNode);
+}
+
+void supplierPostingsRemove(SupplierPostings *postings, unsigned long supplierID, unsigned long medicationID) {
+    SupplierPosting key = { supplierID, medicationID, NULL };
+    SupplierPostingNode *leafNode = findSupplierPostingLeaf(postings, &key);
+    if (!leafNode) return;
+
+    SupplierPostingLeafNode *leaf = &(leafNode->leaf);
+    int pos = supplierPostingLowerBound(leaf, &key);
+    if (pos == leaf->cursize || compareSupplierPostings(&leaf->entries[pos], &key) != 0) return;
+
+    memmove(&leaf->entries[pos], &leaf->entries[pos + 1], (leaf->cursize - pos - 1) * sizeof(SupplierPosting));
+    leaf->cursize--;
+    if (leaf->cursize > 0) return;
+
+    // Empty leaf: take it out of the chain and the tree
+    if (leaf->prev) leaf->prev->next = leaf->next;
+    else postings->leftmost_leaf = leaf->next;
+    if (leaf->next) leaf->next->prev = leaf->prev;
+
+    if (leaf->parent) {
+        removeSupplierPostingChild(postings, leaf->parent, leafNode);
+    } else {
+        postings->root = NULL;
+    }
+    poolFree(&postings->leafNodes, leafNode);
+}
+
+// Points a record's supplier tree at the owner's postings and posts every
+// supplier already in it.
+void attachSupplierTree(MedicationBPlusTree *tree, MedicationData *record) {
+    SupplierBPlusTree *suppliers = record->Suppliers;
+    if (!suppliers) return;
+
+    suppliers->postings = &tree->postings;
+    suppliers->medication = record;
+    for (SupplierLeafNode *leaf = suppliers->leftmost_leaf; leaf; leaf = leaf->next) {
+        for (int i = 0; i < leaf->cursize; i++) {
+            supplierPostingsInsert(&tree->postings, leaf->keys[i], record);
+        }
+    }
+}
+
+// Withdraws a supplier tree's postings before its medication leaves the tree.
+void detachSupplierTree(SupplierBPlusTree *suppliers) {
+    if (!suppliers || !suppliers->postings) return;
+
+    for (SupplierLeafNode *leaf = suppliers->leftmost_leaf; leaf; leaf = leaf->next) {
+        for (int i = 0; i < leaf->cursize; i++) {
+            supplierPostingsRemove(suppliers->postings, leaf->keys[i], suppliers->medication->Medication_ID);
+        }
+    }
+    suppliers->postings = NULL;
+    suppliers->medication = NULL;
+}
+
+// Builds the empty postings tree bottom-up from the suppliers of records and
+// attaches their supplier trees, as attachSupplierTree would one at a time.
+bool supplierPostingsBuild(MedicationBPlusTree *tree, MedicationData **records, int count, double fillFactor) {
+    SupplierPostings *postings = &tree->postings;
+    if (postings->root) return false;
+
+    long total = 0;
+    for (int i = 0; i < count; i++) {
+        SupplierBPlusTree *suppliers = records[i]->Suppliers;
+        if (!suppliers) continue;
+        for (SupplierLeafNode *leaf = suppliers->leftmost_leaf; leaf; leaf = leaf->next) total += leaf->cursize;
+    }
+
+    SupplierPosting *sorted = (SupplierPosting*)malloc(sizeof(SupplierPosting) * (total ? total : 1));
+    if (!sorted) return false;
+
+    long n = 0;
+    for (int i = 0; i < count; i++) {
+        SupplierBPlusTree *suppliers = records[i]->Suppliers;
+        if (!suppliers) continue;
+        suppliers->postings = postings;
+        suppliers->medication = records[i];
+        for (SupplierLeafNode *leaf = suppliers->leftmost_leaf; leaf; leaf = leaf->next) {
+            for (int j = 0; j < leaf->cursize; j++) {
+                SupplierPosting entry = { leaf->keys[j], records[i]->Medication_ID, records[i] };
+                sorted[n++] = entry;
+            }
+        }
+    }
+    if (total == 0) {
+        free(sorted);
+        return true;
+    }
+    qsort(sorted, total, sizeof(SupplierPosting), compareSupplierPostingEntries);
+
+    int order = postings->order;
+    int perLeaf = bulkLoadNodeSlots(order - 1, fillFactor);
+    int perInternal = bulkLoadNodeSlots(order, fillFactor);
+    if (perInternal < 3 && order >= 3) perInternal = 3;
+
+    int levelSize = bulkLoadNodeCount((int)total, perLeaf);
+    SupplierPostingNode **level = (SupplierPostingNode**)malloc(sizeof(SupplierPostingNode*) * levelSize);
+    SupplierPosting *lowKeys = (SupplierPosting*)malloc(sizeof(SupplierPosting) * levelSize);
+    if (!level || !lowKeys) {
+        free(level);
+        free(lowKeys);
+        free(sorted);
+        return false;
+    }
+
+    SupplierPostingLeafNode *prev = NULL;
+    long next = 0;
+    for (int i = 0; i < levelSize; i++) {
+        int take = (int)(total / levelSize + (i < total % levelSize));
+        SupplierPostingNode *node = createSupplierPostingNode(postings, true);
+        SupplierPostingLeafNode *leaf = &(node->leaf);
+
+        memcpy(leaf->entries, &sorted[next], take * sizeof(SupplierPosting));
+        next += take;
+        leaf->cursize = take;
+        leaf->prev = prev;
+        if (prev) prev->next = leaf;
+        else postings->leftmost_leaf = leaf;
+        prev = leaf;
+
+        level[i] = node;
+        lowKeys[i] = leaf->entries[0];
+    }
+
+    while (levelSize > 1) {
+        int parents = bulkLoadNodeCount(levelSize, perInternal);
+        int consumed = 0;
+        for (int i = 0; i < parents; i++) {
+            int take = levelSize / parents + (i < levelSize % parents);
+            SupplierPostingNode *node = createSupplierPostingNode(postings, false);
+            SupplierPostingInternalNode *internal = &(node->internal);
+            SupplierPosting lowKey = lowKeys[consumed];
+
+            for (int j = 0; j < take; j++, consumed++) {
+                SupplierPostingNode *child = level[consumed];
+                internal->children[j] = child;
+                if (j > 0) internal->keys[j - 1] = lowKeys[consumed];
+                if (child->isLeaf) child->leaf.parent = internal;
+                else child->internal.parent = internal;
+            }
+            internal->cursize = take - 1;
+
+            level[i] = node;
+            lowKeys[i] = lowKey;
+        }
+        levelSize = parents;
+    }
+    postings->root = level[0];
+
+    free(level);
+    free(lowKeys);
+    free(sorted);
+    return true;
+}
+
+// Calls visit for every medication the supplier provides, in medication ID order.
+// Returns the number of medications visited.
+int findMedicationsBySupplier(MedicationBPlusTree *tree, unsigned long supplierID,
+                              void (*visit)(MedicationData *medication, void *context), void *context) {
+    SupplierPosting key = { supplierID, 0, NULL };
+    SupplierPostingNode *leafNode = findSupplierPostingLeaf(&tree->postings, &key);
+    if (!leafNode) return 0;
+
+    SupplierPostingLeafNode *leaf = &(leafNode->leaf);
+    int pos = supplierPostingLowerBound(leaf, &key);
+    int found = 0;
+
+    for (; leaf; leaf = leaf->next, pos = 0) {
+        for (; pos < leaf->cursize; pos++) {
+            if (leaf->entries[pos].supplierID != supplierID) return found;
+            found++;
+            if (visit) visit(leaf->entries[pos].medication, context);
+        }
+    }
+    return found;
+}
+
+//==============================================================================
+// Low-stock set: updated wherever stock or a record changes, so alerts cost
+// O(alerts) instead of a pass over the whole catalogue.
+
+static bool isLowStock(const MedicationData *record) {
+    return (long)record->Quantity_in_stock <= (long)record->Reorderlevel;
+}
+
+// First position whose record ID is >= id.
+static int lowStockPosition(const LowStockSet *set, unsigned long id) {
+    int low = 0, high = set->count;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (set->records[mid]->Medication_ID < id) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+static bool lowStockReserve(LowStockSet *set, int capacity) {
+    if (capacity <= set->capacity) return true;
+    int newCapacity = set->capacity ? set->capacity : 16;
+    while (newCapacity < capacity) newCapacity *= 2;
+    MedicationData **records = (MedicationData**)realloc(set->records, newCapacity * sizeof(MedicationData*));
+    if (!records) return false;
+    set->records = records;
+    set->capacity = newCapacity;
+    return true;
+}
+
+// Adds or drops record to match its current stock and reorder level.
+void lowStockUpdate(LowStockSet *set, MedicationData *record) {
+    int pos = lowStockPosition(set, record->Medication_ID);
+    bool present = pos < set->count && set->records[pos] == record;
+    bool low = isLowStock(record);
+    if (low == present) return;
+
+    if (low) {
+        if (!lowStockReserve(set, set->count + 1)) return;
+        memmove(&set->records[pos + 1], &set->records[pos], (set->count - pos) * sizeof(MedicationData*));
+        set->records[pos] = record;
+        set->count++;
+    } else {
+        memmove(&set->records[pos], &set->records[pos + 1], (set->count - pos - 1) * sizeof(MedicationData*));
+        set->count--;
+    }
+}
+
+void lowStockRemove(LowStockSet *set, const MedicationData *record) {
+    int pos = lowStockPosition(set, record->Medication_ID);
+    if (pos == set->count || set->records[pos] != record) return;
+    memmove(&set->records[pos], &set->records[pos + 1], (set->count - pos - 1) * sizeof(MedicationData*));
+    set->count--;
+}
+
+// Fills an empty set from records already sorted by ID.
+bool lowStockBuild(LowStockSet *set, MedicationData **records, int count) {
+    int low = 0;
+    for (int i = 0; i < count; i++) low += isLowStock(records[i]);
+    if (!lowStockReserve(set, set->count + low)) return false;
+
+    for (int i = 0; i < count; i++) {
+        if (isLowStock(records[i])) set->records[set->count++] = records[i];
+    }
+    return true;
+}
+
+// Number of medications at or below their reorder level.
+int lowStockCount(const MedicationBPlusTree *tree) {
+    return tree->lowStock.count;
+}
+
+//==============================================================================
+// Worker pool and parallel leaf scans
+//
+// Reports that read every medication split the leaf chain into runs, one per
+// subtree a few levels below the root, and hand the runs to a pool of worker
+// threads. Each run fills its own partial result and the caller merges the
+// partials in run order, which is key order. Scans only read the tree; like
+// the other whole-tree reports they expect no writer to be running.
+
+#define SCAN_RUNS_PER_THREAD 4                 // Spare runs even out subtrees of different sizes
+#define SCAN_MAX_RUNS 1024
+
+int workerThreadCount = 0;                     // --threads, counting the caller; 0 uses every online core
+
+typedef struct WorkerPool {
+    pthread_mutex_t lock;
+    pthread_cond_t wake;                       // Workers wait here for tasks
+    pthread_cond_t done;                       // The caller waits here for the last one to finish
+    pthread_t *threads;
+    int threadCount;                           // Workers, not counting the caller
+    void (*task)(void *context, int index);
+    void *context;
+    int taskCount;
+    int nextTask;                              // Next index to hand out
+    int unfinished;                            // Tasks handed out or waiting
+    bool stopping;
+} WorkerPool;
+
+static WorkerPool *workerPool = NULL;
+
+int scanThreadCount(void) {
+    if (workerThreadCount > 0) return workerThreadCount;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return cores > 0 ? (int)cores : 1;
+}
+
+static void* workerPoolMain(void *arg) {
+    WorkerPool *pool = (WorkerPool*)arg;
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->stopping && pool->nextTask >= pool->taskCount) {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+        if (pool->stopping) break;
+
+        int index = pool->nextTask++;
+        pthread_mutex_unlock(&pool->lock);
+        pool->task(pool->context, index);
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->unfinished == 0) pthread_cond_signal(&pool->done);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+// Starts threadCount workers; the thread that runs tasks on the pool joins in too.
+WorkerPool* startWorkerPool(int threadCount) {
+    WorkerPool *pool = (WorkerPool*)calloc(1, sizeof(WorkerPool));
+    if (!pool) return NULL;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    pool->threads = (pthread_t*)malloc(sizeof(pthread_t) * (threadCount ? threadCount : 1));
+    for (int i = 0; pool->threads && i < threadCount; i++) {
+        if (pthread_create(&pool->threads[i], NULL, workerPoolMain, pool) != 0) break;
+        pool->threadCount++;
+    }
+    return pool;
+}
+
+void stopWorkerPool(WorkerPool *pool) {
+    if (!pool) return;
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 0; i < pool->threadCount; i++) pthread_join(pool->threads[i], NULL);
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->wake);
+    pthread_cond_destroy(&pool->done);
+    free(pool->threads);
+    free(pool);
+}
+
+// Runs task(context, i) for every i below count and returns once all are done.
+// The shared pool is started on first use, and restarted if --threads changed.
+void runOnWorkerPool(void (*task)(void *context, int index), void *context, int count) {
+    int threads = scanThreadCount();
+    if (threads > 1 && workerPool && workerPool->threadCount != threads - 1) {
+        stopWorkerPool(workerPool);
+        workerPool = NULL;
+    }
+    if (threads > 1 && count > 1 && !workerPool) workerPool = startWorkerPool(threads - 1);
+    WorkerPool *pool = workerPool;
+    if (threads == 1 || count < 2 || !pool) {
+        for (int i = 0; i < count; i++) task(context, i);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->context = context;
+    pool->taskCount = count;
+    pool->nextTask = 0;
+    pool->unfinished = count;
+    pthread_cond_broadcast(&pool->wake);
+
+    // The caller takes tasks as well, so a pool that failed to start still finishes
+    while (pool->nextTask < pool->taskCount) {
+        int index = pool->nextTask++;
+        pthread_mutex_unlock(&pool->lock);
+        task(context, index);
+        pthread_mutex_lock(&pool->lock);
+        pool->unfinished--;
+    }
+    while (pool->unfinished > 0) pthread_cond_wait(&pool->done, &pool->lock);
+    pool->taskCount = 0;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+// Splits the leaf chain into at most maxRuns runs, each the leaves of one
+// subtree, by opening up whole levels below the root until there are about
+// wantedRuns subtrees. starts[i] is the first leaf of run i, which ends where
+// run i + 1 starts (the last one at the end of the chain). Returns the run count.
+int partitionMedicationLeaves(MedicationBPlusTree *tree, int wantedRuns, MedicationLeafNode **starts, int maxRuns) {
+    if (!tree->root || maxRuns < 1) return 0;
+    MedicationNode *levels[2][SCAN_MAX_RUNS];
+    MedicationNode **level = levels[0];
+    int count = 1;
+    level[0] = tree->root;
+    if (maxRuns > SCAN_MAX_RUNS) maxRuns = SCAN_MAX_RUNS;
+
+    // Every node on a level has the same kind, so one check covers the level
+    while (count < wantedRuns && !level[0]->isLeaf) {
+        int children = 0;
+        for (int i = 0; i < count; i++) children += level[i]->internal.cursize + 1;
+        if (children > maxRuns) break;
+
+        MedicationNode **next = (level == levels[0]) ? levels[1] : levels[0];
+        children = 0;
+        for (int i = 0; i < count; i++) {
+            MedicationInternalNode *node = &(level[i]->internal);
+            for (int j = 0; j <= node->cursize; j++) next[children++] = node->children[j];
+        }
+        level = next;
+        count = children;
+    }
+
+    for (int i = 0; i < count; i++) {
+        MedicationNode *node = level[i];
+        while (!node->isLeaf) node = node->internal.children[0];
+        starts[i] = &(node->leaf);
+    }
+    return count;
+}
+
+typedef struct MedicationScanJob {
+    MedicationLeafNode *starts[SCAN_MAX_RUNS + 1];
+    MedicationRunScan scan;
+    void *context;
+    char *partials;
+    size_t partialSize;
+} MedicationScanJob;
+
+static void medicationScanTask(void *context, int index) {
+    MedicationScanJob *job = (MedicationScanJob*)context;
+    job->scan(job->starts[index], job->starts[index + 1], job->partials + job->partialSize * index, job->context);
+}
+
+// Calls scan(first, end, partial, context) for every run of the leaf chain on
+// the worker pool, each with its own zeroed partialSize-byte partial result.
+// *partials gets the partials in key order for the caller to merge and free.
+// Returns the run count, 0 for an empty tree, or -1 if out of memory.
+int scanMedicationsParallel(MedicationBPlusTree *tree, MedicationRunScan scan, void *context, size_t partialSize, void **partials) {
+    *partials = NULL;
+    MedicationScanJob *job = (MedicationScanJob*)malloc(sizeof(MedicationScanJob));
+    if (!job) return -1;
+
+    int runs = partitionMedicationLeaves(tree, scanThreadCount() * SCAN_RUNS_PER_THREAD, job->starts, SCAN_MAX_RUNS);
+    job->starts[runs] = NULL;
+    job->scan = scan;
+    job->context = context;
+    job->partialSize = partialSize;
+    job->partials = (char*)calloc(runs ? runs : 1, partialSize ? partialSize : 1);
+    if (!job->partials) {
+        free(job);
+        return -1;
+    }
+
+    runOnWorkerPool(medicationScanTask, job, runs);
+    *partials = job->partials;
+    free(job);
+    return runs;
+}
+
+static void summarizeMedicationRun(MedicationLeafNode *first, MedicationLeafNode *end, void *partial, void *context) {
+    CatalogSummary *summary = (CatalogSummary*)partial;
+    int today = *(const int*)context;
+    for (MedicationLeafNode *leaf = first; leaf != end; leaf = leaf->next) {
+        for (int i = 0; i < leaf->cursize; i++) {
+            const MedicationData *medication = leaf->values[i];
+            summary->medications++;
+            summary->stockUnits += medication->Quantity_in_stock;
+            summary->stockValue += (unsigned long)medication->Quantity_in_stock * medication->Price_per_Unit;
+            summary->unitsSold += medication->Batch_details.Total_sales;
+            summary->revenue += (long)medication->Batch_details.Total_sales * (long)medication->Price_per_Unit;
+            if (isLowStock(medication)) summary->lowStock++;
+            if (medication->Quantity_in_stock == 0) summary->outOfStock++;
+            if (today && medication->Batch_details.Expiration_Date.dayNumber < today) summary->expired++;
+        }
+    }
+}
+
+// Totals over the whole catalog. Expired medications are counted against
+// today (a daysFromCivil day number), or not at all if today is 0.
+bool summarizeMedications(MedicationBPlusTree *tree, int today, CatalogSummary *summary) {
+    memset(summary, 0, sizeof(*summary));
+    void *partials;
+    int runs = scanMedicationsParallel(tree, summarizeMedicationRun, &today, sizeof(CatalogSummary), &partials);
+    if (runs < 0) return false;
+
+    for (int i = 0; i < runs; i++) {
+        const CatalogSummary *part = (const CatalogSummary*)partials + i;
+        summary->medications += part->medications;
+        summary->stockUnits += part->stockUnits;
+        summary->stockValue += part->stockValue;
+        summary->unitsSold += part->unitsSold;
+        summary->revenue += part->revenue;
+        summary->lowStock += part->lowStock;
+        summary->outOfStock += part->outOfStock;
+        summary->expired += part->expired;
+    }
+    free(partials);
+    return true;
+}
+
+// =================================================================================================================================
+
+void checkStockAlerts(MedicationBPlusTree* pharmacy){
+    if (!pharmacy || !pharmacy->root) {
+        printf("The medication B+ tree is empty.\n");
+        return;
+    }
+
+    const LowStockSet *lowStock = &pharmacy->lowStock;
+    printf("\nStock Alerts (%d at or below reorder level):\n", lowStockCount(pharmacy));
+
+    for (int i = 0; i < lowStock->count; i++) {
+        const MedicationData *medication = lowStock->records[i];
+        if (medication->Quantity_in_stock > 0) {
+            printf("Medication ID: %lu, Name: %s, Stock: %u\n",
+                   medication->Medication_ID,
+                   medication->Medicine_Name,
+                   medication->Quantity_in_stock);
+        } else {
+            printf("NO STOCK LEFT FOR MEDICATION ID: %lu, Name: %s\n",
+                   medication->Medication_ID,
+                   medication->Medicine_Name);
+        }
+    }
+}
+
+//====================================================================================================================
+
+// Alerts cover medications expiring within this many days
+#define EXPIRY_ALERT_DAYS 30
+
+// Lists medications that have expired or expire within withinDays of the given
+// date. The expiration tree is in date order, so the scan starts at the first
+// leaf and stops at the first entry past the cutoff.
+void checkExpirationDates(int day, int month, int year, int withinDays, MedicationBPlusTree* pharmacy) {
+    if (!pharmacy || !pharmacy->root) {
+        printf("The medication B+ tree is empty.\n");
+        return;
+    }
+
+    int today = daysFromCivil(day, month, year);
+    printf("\nMedicines that are expired or will expire soon:\n");
+
+    for (ExpirationLeafNode* current = expirationTree ? expirationTree->leftmost_leaf : NULL; current; current = current->next) {
+        for (int i = 0; i < current->cursize; i++) {
+            // Earlier dates have already expired; later ones count down to the cutoff
+            int result = expirationKeyDay(current->keys[i]) - today;
+            if (result > withinDays) return;
+
+            int date = expirationKeyDate(current->keys[i]);
+            int eday = date % 100;
+            int emonth = date / 100 % 100;
+            int eyear = date / 10000;
+
+            const ExpirationIndexData *entry = &current->values[i];
+            printf("\n==================== ALERT ====================\n");
+            printf("Medication ID: %lu\n", entry->medicationID);
+            printf("Name: %s\n", entry->medicineName);
+            printf("Expiration Date: %02d/%02d/%04d\n", eday, emonth, eyear);
+
+            if (result <= 0) {
+                printf("Status: Medication Already Expired\n");
+            } else {
+                printf("Status: %d Days Remaining Until Expiration\n", result);
+            }
+            printf("===============================================\n");
+        }
+    }
+}
+
+
+//====================================================================================================================
+
+
+static void printRankedSupplier(const UniqueSupplierData *supplier, void *context) {
+    (void)context;
+    printf("Supplier ID: %lu\n", supplier->Supplier_ID);
+    printf("  Name: %s\n", supplier->Supplier_Name);
+    printf("  Number of Unique Medicines: %u\n", supplier->noOfUniqueMedicines);
+    printf("  Total Turnover: %lu\n", supplier->turnoverProduced);
+    printf("----------------------------------------\n");
+}
+
+// Prints the top k suppliers by turnover or by number of unique medicines.
+void printTopSuppliers(UniqueSupplierBPlusTree *tree, bool byTurnover, int k) {
+    if (!tree || !tree->root) {
+        printf("The Unique Supplier B+ Tree is empty.\n");
+        return;
+    }
+
+    printf("\nTop %d Suppliers:\n", k);
+    printf("======================================================\n");
+    topUniqueSuppliers(tree, byTurnover, k, printRankedSupplier, NULL);
+    printf("======================================================\n");
+}
+
+//=====================================================================================================================
+
+bool deleteMedication(MedicationBPlusTree **Btree) {
+    unsigned long id;
+    printf("Enter the Medication ID to delete: ");
+    scanf("%lu", &id);
+
+    return deleteMedicationByID(*Btree, id);
+}
+
+static inline void setMedicationParent(MedicationNode *node, MedicationInternalNode *parent) {
+    if (node->isLeaf) node->leaf.parent = parent;
+    else node->internal.parent = parent;
+}
+
+// Restores minimum occupancy after a delete left the node at the end of the
+// path underfull. path and pathIndices hold the internal nodes and child
+// slots taken from the root down. An underfull node borrows a key from an
+// adjacent sibling that can spare one; otherwise it merges with that sibling,
+// which removes a key from the parent, and the check repeats one level up.
+// The root may hold fewer keys than the minimum and is replaced by its only
+// child once it has no keys left, so the tree shrinks in height under deletes
+// the same way it grows under splits. The path and the node are locked by the
+// caller; siblings are locked here while they change, and nodes that leave
+// the tree go to retired for the caller to free after unlocking.
+static void rebalanceMedicationTree(MedicationBPlusTree *tree, MedicationInternalNode **path, int *pathIndices, int pathLen, MedicationNode **retired, int *retiredCount) {
+    int minKeys = (tree->order - 1) / 2;
+
+    while (pathLen > 0) {
+        MedicationInternalNode *parent = path[pathLen - 1];
+        int childIndex = pathIndices[pathLen - 1];
+        MedicationNode *node = parent->children[childIndex];
+        MedicationNode *left = childIndex > 0 ? parent->children[childIndex - 1] : NULL;
+        MedicationNode *right = childIndex < parent->cursize ? parent->children[childIndex + 1] : NULL;
+
+        // The pair that merges is always (left, node) or (node, right);
+        // the right one of the two is folded into the left one and freed
+        int separator = left ? childIndex - 1 : childIndex;
+        MedicationNode *into = left ? left : node;
+        MedicationNode *gone = left ? node : right;
+        MedicationNode *sibling = left ? left : right;
+
+        if (node->isLeaf) {
+            MedicationLeafNode *leaf = &(node->leaf);
+            if (leaf->cursize >= minKeys) return;
+
+            if (left && left->leaf.cursize > minKeys) {
+                MedicationLeafNode *from = &(left->leaf);
+                olcWriteLock(&left->version);
+                from->cursize--;
+                memmove(&leaf->keys[1], &leaf->keys[0], leaf->cursize * sizeof(unsigned long));
+                memmove(&leaf->values[1], &leaf->values[0], leaf->cursize * sizeof(MedicationData*));
+                leaf->keys[0] = from->keys[from->cursize];
+                leaf->values[0] = from->values[from->cursize];
+                leaf->cursize++;
+                parent->keys[childIndex - 1] = leaf->keys[0];
+                STAT_ADD(STAT_BORROWS, 1);
+                STAT_MOVE(leaf->cursize, leaf->cursize * (sizeof(unsigned long) + sizeof(MedicationData*)));
+                olcWriteUnlock(&left->version);
+                return;
+            }
+            if (right && right->leaf.cursize > minKeys) {
+                MedicationLeafNode *from = &(right->leaf);
+                olcWriteLock(&right->version);
+                leaf->keys[leaf->cursize] = from->keys[0];
+                leaf->values[leaf->cursize] = from->values[0];
+                leaf->cursize++;
+                from->cursize--;
+                memmove(&from->keys[0], &from->keys[1], from->cursize * sizeof(unsigned long));
+                memmove(&from->values[0], &from->values[1], from->cursize * sizeof(MedicationData*));
+                parent->keys[childIndex] = from->keys[0];
+                STAT_ADD(STAT_BORROWS, 1);
+                STAT_MOVE(from->cursize + 1, (from->cursize + 1) * (sizeof(unsigned long) + sizeof(MedicationData*)));
+                olcWriteUnlock(&right->version);
+                return;
+            }
+
+            MedicationLeafNode *to = &(into->leaf);
+            MedicationLeafNode *from = &(gone->leaf);
+            olcWriteLock(&sibling->version);
+            memcpy(&to->keys[to->cursize], from->keys, from->cursize * sizeof(unsigned long));
+            memcpy(&to->values[to->cursize], from->values, from->cursize * sizeof(MedicationData*));
+            to->cursize += from->cursize;
+            STAT_ADD(STAT_MERGES, 1);
+            STAT_MOVE(from->cursize, from->cursize * (sizeof(unsigned long) + sizeof(MedicationData*)));
+            to->next = from->next;
+            if (from->next) from->next->prev = to;
+            retireMedicationNode(retired, retiredCount, gone);
+            olcWriteUnlock(&sibling->version);
+        } else {
+            MedicationInternalNode *internal = &(node->internal);
+            if (internal->cursize >= minKeys) return;
+
+            // Borrowing rotates a key through the parent and moves one child across
+            if (left && left->internal.cursize > minKeys) {
+                MedicationInternalNode *from = &(left->internal);
+                olcWriteLock(&left->version);
+                memmove(&internal->keys[1], &internal->keys[0], internal->cursize * sizeof(unsigned long));
+                memmove(&internal->children[1], &internal->children[0], (internal->cursize + 1) * sizeof(MedicationNode*));
+                internal->keys[0] = parent->keys[childIndex - 1];
+                internal->children[0] = from->children[from->cursize];
+                setMedicationParent(internal->children[0], internal);
+                internal->cursize++;
+                parent->keys[childIndex - 1] = from->keys[from->cursize - 1];
+                from->cursize--;
+                STAT_ADD(STAT_BORROWS, 1);
+                STAT_MOVE(internal->cursize, internal->cursize * (sizeof(unsigned long) + sizeof(MedicationNode*)));
+                olcWriteUnlock(&left->version);
+                return;
+            }
+            if (right && right->internal.cursize > minKeys) {
+                MedicationInternalNode *from = &(right->internal);
+                olcWriteLock(&right->version);
+                internal->keys[internal->cursize] = parent->keys[childIndex];
+                internal->children[internal->cursize + 1] = from->children[0];
+                setMedicationParent(from->children[0], internal);
+                internal->cursize++;
+                parent->keys[childIndex] = from->keys[0];
+                memmove(&from->keys[0], &from->keys[1], (from->cursize - 1) * sizeof(unsigned long));
+                memmove(&from->children[0], &from->children[1], from->cursize * sizeof(MedicationNode*));
+                from->cursize--;
+                STAT_ADD(STAT_BORROWS, 1);
+                STAT_MOVE(from->cursize + 1, (from->cursize + 1) * (sizeof(unsigned long) + sizeof(MedicationNode*)));
+                olcWriteUnlock(&right->version);
+                return;
+            }
+
+            // Merging pulls the separator down between the two halves
+            MedicationInternalNode *to = &(into->internal);
+            MedicationInternalNode *from = &(gone->internal);
+            olcWriteLock(&sibling->version);
+            to->keys[to->cursize] = parent->keys[separator];
+            memcpy(&to->keys[to->cursize + 1], from->keys, from->cursize * sizeof(unsigned long));
+            memcpy(&to->children[to->cursize + 1], from->children, (from->cursize + 1) * sizeof(MedicationNode*));
+            for (int i = 0; i <= from->cursize; i++) {
+                setMedicationParent(from->children[i], to);
+            }
+            to->cursize += from->cursize + 1;
+            STAT_ADD(STAT_MERGES, 1);
+            STAT_MOVE(from->cursize + 1, (from->cursize + 1) * (sizeof(unsigned long) + sizeof(MedicationNode*)));
+            retireMedicationNode(retired, retiredCount, gone);
+            olcWriteUnlock(&sibling->version);
+        }
+
+        // Drop the separator and the freed child from the parent
+        int tail = parent->cursize - separator - 1;
+        memmove(&parent->keys[separator], &parent->keys[separator + 1], tail * sizeof(unsigned long));
+        memmove(&parent->children[separator + 1], &parent->children[separator + 2], tail * sizeof(MedicationNode*));
+        STAT_MOVE(tail, tail * (sizeof(unsigned long) + sizeof(MedicationNode*)));
+        parent->cursize--;
+        pathLen--;
+
+        // A root left with one child hands the tree to that child
+        if (pathLen == 0 && parent->cursize == 0) {
+            tree->root = parent->children[0];
+            setMedicationParent(tree->root, NULL);
+            retireMedicationNode(retired, retiredCount, NODE_FROM_MEMBER(parent, MedicationNode));
+        }
+    }
+}
+
+// The body of deleteMedicationByID, run with the path to leafNode locked.
+static bool deleteMedicationLocked(MedicationBPlusTree *tree, unsigned long id, MedicationNode *leafNode, MedicationWritePath *path) {
+    if (!leafNode) {
+        return false; // Tree is empty
+    }
+
+    // Now we're at the leaf node
+    MedicationLeafNode *leaf = &(leafNode->leaf);
+
+    // Find the key in the leaf node
+    int keyIndex = findKeyIndex(leaf->keys, leaf->cursize, id);
+
+    if (keyIndex == -1) {
+        return false; // Key not found
+    }
+    walLogDelete(id);
+
+    // Release the record (and its supplier tree) and close the gap in the leaf
+    nameIndexRemove(&tree->names, leaf->values[keyIndex]);
+    lowStockRemove(&tree->lowStock, leaf->values[keyIndex]);
+    deleteFromExpirationTree(expirationTree, medicationExpirationKey(leaf->values[keyIndex]));
+    releaseSupplierBPlusTree(tree, leaf->values[keyIndex]->Suppliers);
+    poolFree(&tree->records, leaf->values[keyIndex]);
+    int tail = leaf->cursize - keyIndex - 1;
+    memmove(&leaf->keys[keyIndex], &leaf->keys[keyIndex + 1], tail * sizeof(unsigned long));
+    memmove(&leaf->values[keyIndex], &leaf->values[keyIndex + 1], tail * sizeof(MedicationData*));
+    STAT_MOVE(tail, tail * (sizeof(unsigned long) + sizeof(MedicationData*)));
+    leaf->cursize--;
+
+    // Leaf node is the root: it may run down to empty
+    if (path->length == 0) {
+        if (leaf->cursize == 0) {
+            // Tree becomes empty
+            retireMedicationNode(path->retired, &path->retiredCount, tree->root);
+            tree->root = NULL;
+            tree->leftmost_leaf = NULL;
+        }
+        return true;
+    }
+
+    // Only the locked end of the path can change
+    rebalanceMedicationTree(tree, path->nodes + path->lockedFrom, path->indices + path->lockedFrom,
+                            path->length - path->lockedFrom, path->retired, &path->retiredCount);
+    return true;
+}
+
+bool deleteMedicationByID(MedicationBPlusTree *tree, unsigned long id) {
+    if (!tree) return false;
+
+    STAT_TIMER_START(delete);
+    MedicationWritePath path;
+    pthread_mutex_lock(&tree->writer);
+    MedicationNode *leafNode = lockMedicationPath(tree, id, false, &path);
+    bool result = deleteMedicationLocked(tree, id, leafNode, &path);
+    unlockMedicationPath(tree, &path, leafNode);
+    pthread_mutex_unlock(&tree->writer);
+    STAT_TIMER_STOP(delete, STAT_DELETE);
+    return result;
+}
+
+void printMedicationDetails(MedicationData* medication) {
+    printf("\n=== MEDICATION DETAILS ===\n");
+    printf("ID: %lu\n", medication->Medication_ID);
+    printf("Name: %s\n", medication->Medicine_Name);
+    printf("Quantity in stock: %u\n", medication->Quantity_in_stock);
+    printf("Price per unit: $%u\n", medication->Price_per_Unit);
+    printf("Reorder level: %d\n", medication->Reorderlevel);
+    printf("Batch: %s\n", medication->Batch_details.Batch);
+    printf("Expiration date: %d-%d-%d\n", 
+           medication->Batch_details.Expiration_Date.day,
+           medication->Batch_details.Expiration_Date.month,
+           medication->Batch_details.Expiration_Date.year);
+    printf("Total sales: %d\n", medication->Batch_details.Total_sales);
+}
+
+void printSupplier(SupplierData* supplier) {
+    printf("  - Supplier ID: %lu\n", supplier->Supplier_ID);
+    printf("    Name: %s\n", supplier->Supplier_Name);
+    printf("    Quantity: %u\n", supplier->Quantity_of_stock_bysupplier);
+    printf("    Contact: %s\n", supplier->Contact);
+}
+
+void printAllSuppliers(SupplierBPlusTree* tree) {
+    if (!tree || !tree->root) {
+        printf("  No suppliers for this medication.\n");
+        return;
+    }
+    
+    printf("\n  --- SUPPLIERS ---\n");
+    
+    // Start at the leftmost leaf
+    SupplierLeafNode* current = tree->leftmost_leaf;
+    
+    // Traverse all leaf nodes
+    while (current != NULL) {
+        for (int i = 0; i < current->cursize; i++) {
+            printSupplier(&current->values[i]);
+            printf("\n");
+        }
+        current = current->next;
+    }
+}
+
+
+void printMedicationBPlusTree(MedicationBPlusTree* tree) {
+    if (!tree || !tree->root) {
+        printf("The medication B+ tree is empty.\n");
+        return;
+    }
+    
+    printf("\n======================================================\n");
+    printf("           MEDICATION B+ TREE (Order: %d)              \n", tree->order);
+    printf("======================================================\n");
+    
+    // Start from the leftmost leaf
+    MedicationLeafNode* current = tree->leftmost_leaf;
+
+    // Traverse all leaf nodes
+    while (current != NULL) {
+        for (int i = 0; i < current->cursize; i++) {
+            printf("\nMedication %d:\n", i + 1);
+            printMedicationDetails(current->values[i]);
+            printAllSuppliers(current->values[i]->Suppliers);
+        }
+        current = current->next; // Move to the next leaf node
+    }
+
+    CatalogSummary summary;
+    if (summarizeMedications(tree, 0, &summary)) {
+        printf("\n%ld medications, %lu units in stock worth $%lu, %ld units sold for $%ld\n",
+               summary.medications, summary.stockUnits, summary.stockValue, summary.unitsSold, summary.revenue);
+        printf("%ld at or below reorder level, %ld out of stock\n", summary.lowStock, summary.outOfStock);
+    }
+    printf("\n======================================================\n");
+}
+
+bool deleteSupplier(SupplierBPlusTree **Btree) {
+    unsigned long id;
+    printf("Enter the Supplier ID to delete: ");
+    scanf("%lu", &id);
+
+    return deleteSupplierByID(*Btree, id);
+}
+
+static inline void setSupplierParent(SupplierNode *node, SupplierInternalNode *parent) {
+    if (node->isLeaf) node->leaf.parent = parent;
+    else node->internal.parent = parent;
+}
+
+// Borrow-or-merge walk up the delete path, as in rebalanceMedicationTree.
+static void rebalanceSupplierTree(SupplierBPlusTree *tree, SupplierInternalNode **path, int *pathIndices, int pathLen, SupplierNode **retired, int *retiredCount) {
+    int minKeys = (tree->order - 1) / 2;
+
+    while (pathLen > 0) {
+        SupplierInternalNode *parent = path[pathLen - 1];
+        int childIndex = pathIndices[pathLen - 1];
+        SupplierNode *node = parent->children[childIndex];
+        SupplierNode *left = childIndex > 0 ? parent->children[childIndex - 1] : NULL;
+        SupplierNode *right = childIndex < parent->cursize ? parent->children[childIndex + 1] : NULL;
+
+        // The pair that merges is always (left, node) or (node, right);
+        // the right one of the two is folded into the left one and freed
+        int separator = left ? childIndex - 1 : childIndex;
+        SupplierNode *into = left ? left : node;
+        SupplierNode *gone = left ? node : right;
+        SupplierNode *sibling = left ? left : right;
+
+        if (node->isLeaf) {
+            SupplierLeafNode *leaf = &(node->leaf);
+            if (leaf->cursize >= minKeys) return;
+
+            if (left && left->leaf.cursize > minKeys) {
+                SupplierLeafNode *from = &(left->leaf);
+                olcWriteLock(&left->version);
+                from->cursize--;
+                memmove(&leaf->keys[1], &leaf->keys[0], leaf->cursize * sizeof(unsigned long));
+                memmove(&leaf->values[1], &leaf->values[0], leaf->cursize * sizeof(SupplierData));
+                leaf->keys[0] = from->keys[from->cursize];
+                leaf->values[0] = from->values[from->cursize];
+                leaf->cursize++;
+                parent->keys[childIndex - 1] = leaf->keys[0];
+                olcWriteUnlock(&left->version);
+                return;
+            }
+            if (right && right->leaf.cursize > minKeys) {
+                SupplierLeafNode *from = &(right->leaf);
+                olcWriteLock(&right->version);
+                leaf->keys[leaf->cursize] = from->keys[0];
+                leaf->values[leaf->cursize] = from->values[0];
+                leaf->cursize++;
+                from->cursize--;
+                memmove(&from->keys[0], &from->keys[1], from->cursize * sizeof(unsigned long));
+                memmove(&from->values[0], &from->values[1], from->cursize * sizeof(SupplierData));
+                parent->keys[childIndex] = from->keys[0];
+                olcWriteUnlock(&right->version);
+                return;
+            }
+
+            SupplierLeafNode *to = &(into->leaf);
+            SupplierLeafNode *from = &(gone->leaf);
+            olcWriteLock(&sibling->version);
+            memcpy(&to->keys[to->cursize], from->keys, from->cursize * sizeof(unsigned long));
+            memcpy(&to->values[to->cursize], from->values, from->cursize * sizeof(SupplierData));
+            to->cursize += from->cursize;
+            to->next = from->next;
+            if (from->next) from->next->prev = to;
+            retireSupplierNode(retired, retiredCount, gone);
+            olcWriteUnlock(&sibling->version);
+        } else {
+            SupplierInternalNode *internal = &(node->internal);
+            if (internal->cursize >= minKeys) return;
+
+            // Borrowing rotates a key through the parent and moves one child across
+            if (left && left->internal.cursize > minKeys) {
+                SupplierInternalNode *from = &(left->internal);
+                olcWriteLock(&left->version);
+                memmove(&internal->keys[1], &internal->keys[0], internal->cursize * sizeof(unsigned long));
+                memmove(&internal->children[1], &internal->children[0], (internal->cursize + 1) * sizeof(SupplierNode*));
+                internal->keys[0] = parent->keys[childIndex - 1];
+                internal->children[0] = from->children[from->cursize];
+                setSupplierParent(internal->children[0], internal);
+                internal->cursize++;
+                parent->keys[childIndex - 1] = from->keys[from->cursize - 1];
+                from->cursize--;
+                olcWriteUnlock(&left->version);
+                return;
+            }
+            if (right && right->internal.cursize > minKeys) {
+                SupplierInternalNode *from = &(right->internal);
+                olcWriteLock(&right->version);
+                internal->keys[internal->cursize] = parent->keys[childIndex];
+                internal->children[internal->cursize + 1] = from->children[0];
+                setSupplierParent(from->children[0], internal);
+                internal->cursize++;
+                parent->keys[childIndex] = from->keys[0];
+                memmove(&from->keys[0], &from->keys[1], (from->cursize - 1) * sizeof(unsigned long));
+                memmove(&from->children[0], &from->children[1], from->cursize * sizeof(SupplierNode*));
+                from->cursize--;
+                olcWriteUnlock(&right->version);
+                return;
+            }
+
+            // Merging pulls the separator down between the two halves
+            SupplierInternalNode *to = &(into->internal);
+            SupplierInternalNode *from = &(gone->internal);
+            olcWriteLock(&sibling->version);
+            to->keys[to->cursize] = parent->keys[separator];
+            memcpy(&to->keys[to->cursize + 1], from->keys, from->cursize * sizeof(unsigned long));
+            memcpy(&to->children[to->cursize + 1], from->children, (from->cursize + 1) * sizeof(SupplierNode*));
+            for (int i = 0; i <= from->cursize; i++) {
+                setSupplierParent(from->children[i], to);
+            }
+            to->cursize += from->cursize + 1;
+            retireSupplierNode(retired, retiredCount, gone);
+            olcWriteUnlock(&sibling->version);
+        }
+
+        // Drop the separator and the freed child from the parent
+        int tail = parent->cursize - separator - 1;
+        memmove(&parent->keys[separator], &parent->keys[separator + 1], tail * sizeof(unsigned long));
+        memmove(&parent->children[separator + 1], &parent->children[separator + 2], tail * sizeof(SupplierNode*));
+        parent->cursize--;
+        pathLen--;
+
+        // A root left with one child hands the tree to that child
+        if (pathLen == 0 && parent->cursize == 0) {
+            tree->root = parent->children[0];
+            setSupplierParent(tree->root, NULL);
+            retireSupplierNode(retired, retiredCount, NODE_FROM_MEMBER(parent, SupplierNode));
+        }
+    }
+}
+
+// The body of deleteSupplierByID, run with the path to current locked.
+static bool deleteSupplierLocked(SupplierBPlusTree *tree, unsigned long id, SupplierNode *current, SupplierInternalNode **path, int *pathIndices, int pathLen, SupplierNode **retired, int *retiredCount) {
+    if (!current) {
+        return false; // Tree is empty
+    }
+
+    // Now we're at the leaf node
+    SupplierLeafNode *leaf = &(current->leaf);
+
+    // Find the key in the leaf node
+    int keyIndex = findKeyIndex(leaf->keys, leaf->cursize, id);
+
+    if (keyIndex == -1) {
+        return false; // Key not found
+    }
+
+    if (tree->postings) supplierPostingsRemove(tree->postings, id, tree->medication->Medication_ID);
+
+    // Delete the key from the leaf node
+    int tail = leaf->cursize - keyIndex - 1;
+    memmove(&leaf->keys[keyIndex], &leaf->keys[keyIndex + 1], tail * sizeof(unsigned long));
+    memmove(&leaf->values[keyIndex], &leaf->values[keyIndex + 1], tail * sizeof(SupplierData));
+    leaf->cursize--;
+
+    // Leaf node is the root: it may run down to empty
+    if (pathLen == 0) {
+        if (leaf->cursize == 0) {
+            retireSupplierNode(retired, retiredCount, tree->root);
+            tree->root = NULL;
+            tree->leftmost_leaf = NULL;
+        }
+        return true;
+    }
+
+    rebalanceSupplierTree(tree, path, pathIndices, pathLen, retired, retiredCount);
+    return true;
+}
+
+bool deleteSupplierByID(SupplierBPlusTree *tree, unsigned long id) {
+    if (!tree) return false;
+
+    // Track the path to the leaf node (for possible rebalancing)
+    SupplierInternalNode *path[SUPPLIER_MAX_HEIGHT];
+    int pathIndices[SUPPLIER_MAX_HEIGHT];
+    int pathLen;
+    SupplierNode *retired[SUPPLIER_MAX_HEIGHT + 1];
+    int retiredCount = 0;
+
+    SupplierNode *current = lockSupplierPath(tree, id, path, pathIndices, &pathLen);
+    bool result = deleteSupplierLocked(tree, id, current, path, pathIndices, pathLen, retired, &retiredCount);
+    unlockSupplierPath(tree, path, pathLen, current, retired, retiredCount);
+    return result;
+}
+
+bool searchSupplier(SupplierBPlusTree *Btree, unsigned long supplierID) {
+    if (!Btree || !Btree->root) {
+        return false; // Tree is empty
+    }
+
+    SupplierNode *current = Btree->root;
+
+    // Traverse to the leaf node where the supplier ID might be stored
+    while (!current->isLeaf) {
+        SupplierInternalNode *internal = &(current->internal);
+        int i = upperBoundKey(internal->keys, internal->cursize, supplierID);
+        current = internal->children[i];
+    }
+
+    // We are now at the leaf node
+    SupplierLeafNode *leaf = &(current->leaf);
+
+    return findKeyIndex(leaf->keys, leaf->cursize, supplierID) != -1;
+}
+
+void updateDetails(MedicationBPlusTree *tree, MedicationData *medication) {
+    printf("Enter the details you want to update:\n");
+    printf("1. Update Price\n2. Update Stock\n3. Update Supplier Information\n4. Update Name\n");
+    int ch;
+    scanf("%d", &ch);
+
+    switch (ch) {
+        case 1: {
+            printf("Enter the new price: \n");
+            scanf("%u", &medication->Price_per_Unit);
+            walLogMedication(WAL_UPDATE_MEDICATION, medication);
+            printf("Price updated successfully.\n");
+            break;
+        }
+        case 2: {
+            printf("Enter the new stock: \n");
+            scanf("%u", &medication->Quantity_in_stock);
+            lowStockUpdate(&tree->lowStock, medication);
+            walLogMedication(WAL_UPDATE_MEDICATION, medication);
+            printf("Stock updated successfully.\n");
+            break;
+        }
+        case 4: {
+            char name[NAME_SIZE];
+            printf("Enter the new name: \n");
+            scanf("%99s", name);
+            renameMedication(tree, medication->Medication_ID, name);
+            printf("Name updated successfully.\n");
+            break;
+        }
+        case 3: {
+            printf("Enter the details you want to update for suppliers:\n");
+            printf("1. Add New Supplier\n2. Update Supplier Details\n3. Delete Supplier\n4. Search Supplier\n5. Print All Suppliers\n");
+            int ch1;
+            scanf("%d", &ch1);
+            unsigned long id;
+
+            switch (ch1) {
+                case 1: {
+                    SupplierData suppl = initSupplier(medication->Suppliers, medication);
+                    insertSupplier(medication->Suppliers, suppl);
+                    lowStockUpdate(&tree->lowStock, medication);
+                    walLogMedication(WAL_SUPPLIER_CHANGE, medication);
+                    printf("New supplier added successfully.\n");
+                    break;
+                }
+                case 2: {
+                    printf("Enter the Supplier ID to update: \n");
+                    scanf("%lu", &id);
+                    SupplierNode* leaf2 = findSupplierLeafNode(medication->Suppliers, id);
+                    SupplierLeafNode* leaf = &(leaf2->leaf);
+                    if (leaf) {
+                        for (int i = 0; i < leaf->cursize; i++) {
+                            if (leaf->keys[i] == id) {
+                                printf("Enter details to update:\n");
+                                printf("1. Update Supplier Name\n2. Update Quantity\n3. Update Contact\n");
+                                int updateChoice;
+                                scanf("%d", &updateChoice);
+                                switch (updateChoice) {
+                                    case 1:
+                                        printf("Enter new Supplier Name: ");
+                                        scanf("%s", leaf->values[i].Supplier_Name);
+                                        break;
+                                    case 2:
+                                        printf("Enter new Quantity: ");
+                                        scanf("%u", &leaf->values[i].Quantity_of_stock_bysupplier);
+                                        break;
+                                    case 3:
+                                        printf("Enter new Contact: ");
+                                        scanf("%s", leaf->values[i].Contact);
+                                        break;
+                                    default:
+                                        printf("Invalid choice.\n");
+                                }
+                                walLogMedication(WAL_SUPPLIER_CHANGE, medication);
+                                printf("Supplier details updated successfully.\n");
+                                break;
+                            }
+                        }
+                    } else {
+                        printf("Supplier ID %lu not found.\n", id);
+                    }
+                    break;
+                }
+                case 3: {
+                    if (deleteSupplier(&medication->Suppliers)) {
+                        walLogMedication(WAL_SUPPLIER_CHANGE, medication);
+                        printf("Supplier deleted successfully.\n");
+                    } else {
+                        printf("Supplier not found.\n");
+                    }
+                    break;
+                }
+                case 4: {
+                    printf("Enter the Supplier ID to search: \n");
+                    scanf("%lu", &id);
+                    if (searchSupplier(medication->Suppliers, id)) {
+                        printf("Supplier ID %lu found.\n", id);
+                        printf("Details:\n");
+                        SupplierNode* leaf2 = findSupplierLeafNode(medication->Suppliers, id);
+                        SupplierLeafNode* leaf = &(leaf2->leaf);
+                        for (int i = 0; i < leaf->cursize; i++) {
+                            if (leaf->keys[i] == id) {
+                                printSupplier(&leaf->values[i]);
+                                break;
+                            }
+                        }
+                    } else {
+                        printf("Supplier ID %lu not found.\n", id);
+                    }
+                    break;
+                }
+                case 5: {
+                    printAllSuppliers(medication->Suppliers);
+                    break;
+                }
+                default:
+                    printf("Invalid choice.\n");
+            }
+            break;
+        }
+        default:
+            printf("Invalid choice. Please try again.\n");
+    }
+}
+
+//==============================================================================
+// Data file parsing: medication.txt is mapped and tokenized in place. Each
+// record is the ID, the name on a line of its own, stock, price, batch, the
+// expiry date as DD MM YYYY, the supplier count, "ID NAME QUANTITY CONTACT"
+// per supplier and the reorder level. Fields other than the name may be split
+// over lines any way, lines may end in CRLF, and records are separated by
+// blank lines.
+
+typedef struct DataFileScanner {
+    const char *cursor;
+    const char *end;
+    long line;                                 // Line of the cursor, from 1
+    const char *filename;
+    bool failed;                               // An error has been found
+    bool quiet;                                // Errors are flagged but not printed
+} DataFileScanner;
+
+static void dataFileError(DataFileScanner *scanner, const char *expected) {
+    if (!scanner->failed && !scanner->quiet) printf("%s:%ld: expected %s\n", scanner->filename, scanner->line, expected);
+    scanner->failed = true;
+}
+
+// Skips spaces, tabs, CRs and newlines; false at the end of the data.
+static bool dataFileSkipSpace(DataFileScanner *scanner) {
+    const char *p = scanner->cursor;
+    while (p < scanner->end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) {
+        if (*p == '\n') scanner->line++;
+        p++;
+    }
+    scanner->cursor = p;
+    return p < scanner->end;
+}
+
+// The next whitespace-delimited token, as a pointer into the mapping.
+static const char* dataFileToken(DataFileScanner *scanner, size_t *length) {
+    if (!dataFileSkipSpace(scanner)) return NULL;
+    const char *start = scanner->cursor;
+    const char *p = start;
+    while (p < scanner->end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') p++;
+    scanner->cursor = p;
+    *length = p - start;
+    return start;
+}
+
+static bool dataFileNumber(DataFileScanner *scanner, unsigned long max, unsigned long *value, const char *expected) {
+    size_t length;
+    const char *token = dataFileToken(scanner, &length);
+    unsigned long result = 0;
+    bool ok = token && length > 0 && length <= 20;
+    for (size_t i = 0; ok && i < length; i++) {
+        unsigned int digit = (unsigned char)token[i] - '0';
+        ok = digit <= 9 && result <= (max - digit) / 10;
+        result = result * 10 + digit;
+    }
+    if (!ok) {
+        dataFileError(scanner, expected);
+        return false;
+    }
+    *value = result;
+    return true;
+}
+
+static bool dataFileWord(DataFileScanner *scanner, char *out, size_t size, const char *expected) {
+    size_t length;
+    const char *token = dataFileToken(scanner, &length);
+    if (!token || length >= size) {
+        dataFileError(scanner, expected);
+        return false;
+    }
+    memcpy(out, token, length);
+    out[length] = '\0';
+    return true;
+}
+
+// The rest of the current line after leading blanks (the next line if this one
+// is empty), without its line ending.
+static bool dataFileLine(DataFileScanner *scanner, char *out, size_t size, const char *expected) {
+    if (!dataFileSkipSpace(scanner)) {
+        dataFileError(scanner, expected);
+        return false;
+    }
+    const char *start = scanner->cursor;
+    const char *p = memchr(start, '\n', scanner->end - start);
+    if (!p) p = scanner->end;
+    scanner->cursor = p;
+    while (p > start && (p[-1] == '\r' || p[-1] == ' ' || p[-1] == '\t')) p--;
+    if ((size_t)(p - start) >= size) {
+        dataFileError(scanner, expected);
+        return false;
+    }
+    memcpy(out, start, p - start);
+    out[p - start] = '\0';
+    return true;
+}
+
+// Parses one record into medication and suppliers (grown as needed). False at
+// the end of the data or on an error, which scanner->failed tells apart.
+static bool parseDataFileRecord(DataFileScanner *scanner, MedicationData *medication,
+                                SupplierData **suppliers, int *supplierCapacity, int *supplierCount) {
+    unsigned long id, stock, price, day, month, year, count, reorder;
+    if (!dataFileSkipSpace(scanner)) return false;
+
+    memset(medication, 0, sizeof(*medication));
+    if (!dataFileNumber(scanner, ULONG_MAX, &id, "a medication ID")) return false;
+    if (!dataFileLine(scanner, medication->Medicine_Name, NAME_SIZE, "a medication name of under 100 characters")) return false;
+    if (!dataFileNumber(scanner, UINT_MAX, &stock, "the quantity in stock")) return false;
+    if (!dataFileNumber(scanner, UINT_MAX, &price, "the price per unit")) return false;
+    if (!dataFileWord(scanner, medication->Batch_details.Batch, BATCH_SIZE, "a batch code")) return false;
+    if (!dataFileNumber(scanner, 31, &day, "an expiry day")) return false;
+    if (!dataFileNumber(scanner, 12, &month, "an expiry month")) return false;
+    if (!dataFileNumber(scanner, 9999, &year, "an expiry year")) return false;
+    if (day < 1 || (int)day > daysInMonth((int)month, (int)year)) {
+        dataFileError(scanner, "a valid expiry date");
+        return false;
+    }
+    if (!dataFileNumber(scanner, INT_MAX, &count, "the number of suppliers")) return false;
+
+    if ((int)count > *supplierCapacity) {
+        SupplierData *grown = (SupplierData*)realloc(*suppliers, sizeof(SupplierData) * count);
+        if (!grown) {
+            dataFileError(scanner, "fewer suppliers (out of memory)");
+            return false;
+        }
+        *suppliers = grown;
+        *supplierCapacity = (int)count;
+    }
+    for (unsigned long j = 0; j < count; j++) {
+        SupplierData *supplier = &(*suppliers)[j];
+        unsigned long quantity;
+        memset(supplier, 0, sizeof(*supplier));
+        if (!dataFileNumber(scanner, ULONG_MAX, &supplier->Supplier_ID, "a supplier ID")) return false;
+        if (!dataFileWord(scanner, supplier->Supplier_Name, NAME_SIZE, "a supplier name")) return false;
+        if (!dataFileNumber(scanner, UINT_MAX, &quantity, "the supplier's quantity")) return false;
+        if (!dataFileWord(scanner, supplier->Contact, CONTACT_SIZE, "a contact of at most 11 characters")) return false;
+        supplier->Quantity_of_stock_bysupplier = (unsigned int)quantity;
+    }
+    if (!dataFileNumber(scanner, INT_MAX, &reorder, "the reorder level")) return false;
+
+    medication->Medication_ID = id;
+    medication->Quantity_in_stock = (unsigned int)stock;
+    medication->Price_per_Unit = (unsigned int)price;
+    medication->Reorderlevel = (int)reorder;
+    setExpiryDate(&medication->Batch_details.Expiration_Date, (int)day, (int)month, (int)year);
+    *supplierCount = (int)count;
+    return true;
+}
+
+// Applies records from the scanner until the end of the data or an error.
+// Returns the number of records read.
+static int loadDataFileSequential(MedicationBPlusTree *tree, DataFileScanner *scanner) {
+    // An empty tree is built bottom-up once the whole file is read; otherwise
+    // the records are merged into it as one sorted batch.
+    bool bulkMedications = (tree->root == NULL);
+    bool bulkExpirations = (expirationTree->root == NULL);
+    MedicationData **records = NULL;
+    MedicationData *pending = NULL;
+    ExpirationIndexData *expiries = NULL;
+    int count = 0, capacity = 0;
+
+    SupplierData *suppliers = NULL;
+    int supplierCapacity = 0, supplierCount = 0;
+    MedicationData medication;
+
+    while (parseDataFileRecord(scanner, &medication, &suppliers, &supplierCapacity, &supplierCount)) {
+        // Grown before the record touches any tree, so running out of memory
+        // stops the load after the records already applied, as an error does
+        if (count == capacity) {
+            int grownCapacity = capacity ? capacity * 2 : 1024;
+            MedicationData **grownRecords = (MedicationData**)realloc(records, sizeof(MedicationData*) * grownCapacity);
+            if (grownRecords) records = grownRecords;
+            ExpirationIndexData *grownExpiries = (ExpirationIndexData*)realloc(expiries, sizeof(ExpirationIndexData) * grownCapacity);
+            if (grownExpiries) expiries = grownExpiries;
+            MedicationData *grownPending = pending;
+            if (!bulkMedications) {
+                grownPending = (MedicationData*)realloc(pending, sizeof(MedicationData) * grownCapacity);
+                if (grownPending) pending = grownPending;
+            }
+            if (!grownRecords || !grownExpiries || (!bulkMedications && !grownPending)) {
+                printf("Memory allocation failed while reading %s after %d records\n", scanner->filename, count);
+                scanner->failed = true;
+                break;
+            }
+            capacity = grownCapacity;
+        }
+
+        medication.Suppliers = createSupplierBPlusTree(tree);
+        for (int j = 0; j < supplierCount; j++) {
+            insertSupplier(medication.Suppliers, suppliers[j]);
+
+            // Adds the supplier, or bumps its medicine count and turnover if already present
+            unsigned long turnover = suppliers[j].Quantity_of_stock_bysupplier * medication.Price_per_Unit;
+            insertUniqueSupplier(uniqueSupplierTree, suppliers[j].Supplier_ID, suppliers[j].Supplier_Name, 1, turnover);
+        }
+
+        unsigned long long expirationKey = medicationExpirationKey(&medication);
+
+        if (bulkMedications) {
+            records[count] = (MedicationData*)poolAlloc(&tree->records);
+            *records[count] = medication;
+        } else {
+            pending[count] = medication;
+        }
+
+        if (bulkExpirations) {
+            expiries[count].expirationKey = expirationKey;
+            expiries[count].medicationID = medication.Medication_ID;
+            strcpy(expiries[count].medicineName, medication.Medicine_Name);
+        } else {
+            insertIntoExpirationTree(expirationTree, expirationKey, medication.Medication_ID, medication.Medicine_Name);
+        }
+        count++;
+    }
+    free(suppliers);
+
+    if (bulkMedications) {
+        bulkLoadMedications(tree, records, count, bulkLoadFillFactor);
+    } else {
+        insertMedicationBatch(tree, pending, count);
+    }
+    if (bulkExpirations) {
+        bulkLoadExpirationTree(expirationTree, expiries, count, bulkLoadFillFactor);
+    }
+
+    free(records);
+    free(pending);
+    free(expiries);
+    return count;
+}
+
+//------------------------------------------------------------------------------
+// Parallel loading: a file of at least PARALLEL_LOAD_MIN_BYTES loaded into
+// empty trees is cut into chunks at blank lines, which separate records, and
+// the chunks are parsed on the worker pool. Each chunk also orders its records
+// by ID and totals its rows per supplier. The caller then merges the chunks in
+// ID order into a bulk build of the medication tree, with each supplier tree
+// built in one batch, and merges the supplier totals into the unique-supplier
+// tree with one insert per supplier. Chunks only touch their own memory; the
+// trees and their pools are only changed by the caller. If any chunk fails to
+// parse, nothing has been applied and the file is loaded sequentially instead,
+// which reports the error with its line.
+
+#define PARALLEL_LOAD_MIN_BYTES (4L << 20)
+#define PARALLEL_LOAD_MIN_CHUNK_BYTES (1L << 20)
+
+// Rows of one supplier: medicines counts the rows and the name is taken from
+// row firstRow of the chunk, the earliest.
+typedef struct SupplierTotal {
+    unsigned long id;
+    int firstRow;
+    unsigned int medicines;
+    unsigned long turnover;
+} SupplierTotal;
+
+typedef struct ParsedChunk {
+    DataFileScanner scanner;
+    MedicationData *records;                   // File order; Suppliers is NULL
+    int *firstSupplier;                        // Record i's rows are firstSupplier[i] up to firstSupplier[i + 1]
+    int count;
+    int capacity;
+    SupplierData *suppliers;
+    int supplierCount;
+    int supplierCapacity;
+    BulkLoadEntry *byID;                       // Records by ID, ties in file order
+    SupplierTotal *totals;                     // By supplier ID
+    int totalCount;
+    bool failed;
+} ParsedChunk;
+
+static int compareSupplierTotals(const void *a, const void *b) {
+    const SupplierTotal *x = (const SupplierTotal*)a;
+    const SupplierTotal *y = (const SupplierTotal*)b;
+    if (x->id != y->id) return (x->id < y->id) ? -1 : 1;
+    return (x->firstRow > y->firstRow) - (x->firstRow < y->firstRow);
+}
+
+// The start of the first record after offset: just past the next blank line.
+static const char* nextRecordBoundary(const char *p, const char *end) {
+    while ((p = (const char*)memchr(p, '\n', end - p)) != NULL) {
+        const char *q = p + 1;
+        while (q < end && (*q == ' ' || *q == '\t' || *q == '\r')) q++;
+        if (q == end) return end;
+        if (*q == '\n') return q + 1;
+        p = q;
+    }
+    return end;
+}
+
+static bool parseChunkRecord(ParsedChunk *chunk, SupplierData **scratch, int *scratchCapacity) {
+    MedicationData medication;
+    int supplierCount;
+    if (!parseDataFileRecord(&chunk->scanner, &medication, scratch, scratchCapacity, &supplierCount)) return false;
+
+    if (chunk->count + 1 >= chunk->capacity) {
+        int capacity = chunk->capacity ? chunk->capacity * 2 : 1024;
+        MedicationData *records = (MedicationData*)realloc(chunk->records, sizeof(MedicationData) * capacity);
+        if (records) chunk->records = records;
+        int *firstSupplier = (int*)realloc(chunk->firstSupplier, sizeof(int) * capacity);
+        if (firstSupplier) chunk->firstSupplier = firstSupplier;
+        if (!records || !firstSupplier) return false;
+        chunk->capacity = capacity;
+    }
+    if (chunk->supplierCount + supplierCount > chunk->supplierCapacity) {
+        int capacity = chunk->supplierCapacity ? chunk->supplierCapacity * 2 : 4096;
+        while (capacity < chunk->supplierCount + supplierCount) capacity *= 2;
+        SupplierData *suppliers = (SupplierData*)realloc(chunk->suppliers, sizeof(SupplierData) * capacity);
+        if (!suppliers) return false;
+        chunk->suppliers = suppliers;
+        chunk->supplierCapacity = capacity;
+    }
+    chunk->records[chunk->count] = medication;
+    chunk->firstSupplier[chunk->count] = chunk->supplierCount;
+    memcpy(&chunk->suppliers[chunk->supplierCount], *scratch, sizeof(SupplierData) * supplierCount);
+    chunk->supplierCount += supplierCount;
+    chunk->count++;
+    return true;
+}
+
+static void parseChunkTask(void *context, int index) {
+    ParsedChunk *chunk = (ParsedChunk*)context + index;
+    SupplierData *scratch = NULL;
+    int scratchCapacity = 0;
+    while (parseChunkRecord(chunk, &scratch, &scratchCapacity)) {
+    }
+    free(scratch);
+    // Stopping anywhere but the end of the chunk is a parse error or lack of memory
+    chunk->failed = chunk->scanner.failed || dataFileSkipSpace(&chunk->scanner);
+    if (chunk->failed) return;
+    if (chunk->firstSupplier) chunk->firstSupplier[chunk->count] = chunk->supplierCount;
+
+    chunk->byID = (BulkLoadEntry*)malloc(sizeof(BulkLoadEntry) * (chunk->count ? chunk->count : 1));
+    chunk->totals = (SupplierTotal*)malloc(sizeof(SupplierTotal) * (chunk->supplierCount ? chunk->supplierCount : 1));
+    if (!chunk->byID || !chunk->totals) {
+        chunk->failed = true;
+        return;
+    }
+
+    bool sorted = true;
+    for (int i = 0; i < chunk->count; i++) {
+        BulkLoadEntry *entry = &chunk->byID[i];
+        entry->key = chunk->records[i].Medication_ID;
+        entry->seq = i;
+        entry->value = &chunk->records[i];
+        if (i > 0 && entry->key < entry[-1].key) sorted = false;
+    }
+    if (!sorted) qsort(chunk->byID, chunk->count, sizeof(BulkLoadEntry), compareBulkLoadEntries);
+
+    // One total per row, then sorted and folded per supplier
+    for (int i = 0; i < chunk->count; i++) {
+        for (int row = chunk->firstSupplier[i]; row < chunk->firstSupplier[i + 1]; row++) {
+            SupplierTotal *total = &chunk->totals[row];
+            total->id = chunk->suppliers[row].Supplier_ID;
+            total->firstRow = row;
+            total->medicines = 1;
+            total->turnover = chunk->suppliers[row].Quantity_of_stock_bysupplier * chunk->records[i].Price_per_Unit;
+        }
+    }
+    qsort(chunk->totals, chunk->supplierCount, sizeof(SupplierTotal), compareSupplierTotals);
+    int distinct = 0;
+    for (int row = 0; row < chunk->supplierCount; row++) {
+        if (distinct > 0 && chunk->totals[distinct - 1].id == chunk->totals[row].id) {
+            chunk->totals[distinct - 1].medicines++;
+            chunk->totals[distinct - 1].turnover += chunk->totals[row].turnover;
+        } else {
+            chunk->totals[distinct++] = chunk->totals[row];
+        }
+    }
+    chunk->totalCount = distinct;
+}
+
+static void freeParsedChunks(ParsedChunk *chunks, int count) {
+    for (int i = 0; i < count; i++) {
+        free(chunks[i].records);
+        free(chunks[i].firstSupplier);
+        free(chunks[i].suppliers);
+        free(chunks[i].byID);
+        free(chunks[i].totals);
+    }
+    free(chunks);
+}
+
+// Builds the three empty trees from chunks already parsed, merging the chunks'
+// ID orders and supplier totals. Equal keys are taken from earlier chunks
+// first, so duplicates resolve as they would reading the file in order.
+static int buildFromParsedChunks(MedicationBPlusTree *tree, ParsedChunk *chunks, int chunkCount) {
+    long total = 0;
+    for (int c = 0; c < chunkCount; c++) total += chunks[c].count;
+    MedicationData **records = (MedicationData**)malloc(sizeof(MedicationData*) * (total ? total : 1));
+    ExpirationIndexData *expiries = (ExpirationIndexData*)malloc(sizeof(ExpirationIndexData) * (total ? total : 1));
+    int *next = (int*)calloc(chunkCount, sizeof(int));
+    if (!records || !expiries || !next) {
+        printf("Memory allocation failed while building the trees\n");
+        exit(1);
+    }
+
+    for (long n = 0; n < total; n++) {
+        int from = -1;
+        for (int c = 0; c < chunkCount; c++) {
+            if (next[c] == chunks[c].count) continue;
+            if (from < 0 || chunks[c].byID[next[c]].key < chunks[from].byID[next[from]].key) from = c;
+        }
+        ParsedChunk *chunk = &chunks[from];
+        BulkLoadEntry *entry = &chunk->byID[next[from]++];
+        int i = entry->seq;
+
+        MedicationData *record = (MedicationData*)poolAlloc(&tree->records);
+        *record = chunk->records[i];
+        record->Suppliers = createSupplierBPlusTree(tree);
+        int first = chunk->firstSupplier[i];
+        insertSupplierBatch(record->Suppliers, &chunk->suppliers[first], chunk->firstSupplier[i + 1] - first);
+        records[n] = record;
+
+        expiries[n].expirationKey = medicationExpirationKey(record);
+        expiries[n].medicationID = record->Medication_ID;
+        strcpy(expiries[n].medicineName, record->Medicine_Name);
+    }
+    bulkLoadMedications(tree, records, (int)total, bulkLoadFillFactor);
+    bulkLoadExpirationTree(expirationTree, expiries, (int)total, bulkLoadFillFactor);
+    free(records);
+    free(expiries);
+
+    // Supplier totals, summed across chunks; the name comes from the first chunk with the supplier
+    memset(next, 0, sizeof(int) * chunkCount);
+    for (;;) {
+        int from = -1;
+        for (int c = 0; c < chunkCount; c++) {
+            if (next[c] == chunks[c].totalCount) continue;
+            if (from < 0 || chunks[c].totals[next[c]].id < chunks[from].totals[next[from]].id) from = c;
+        }
+        if (from < 0) break;
+
+        SupplierTotal sum = chunks[from].totals[next[from]];
+        const char *name = chunks[from].suppliers[sum.firstRow].Supplier_Name;
+        next[from]++;
+        for (int c = from + 1; c < chunkCount; c++) {
+            if (next[c] < chunks[c].totalCount && chunks[c].totals[next[c]].id == sum.id) {
+                sum.medicines += chunks[c].totals[next[c]].medicines;
+                sum.turnover += chunks[c].totals[next[c]].turnover;
+                next[c]++;
+            }
+        }
+        insertUniqueSupplier(uniqueSupplierTree, sum.id, name, sum.medicines, sum.turnover);
+    }
+    free(next);
+    return (int)total;
+}
+
+// Parses text on the worker pool and builds the trees from it. Returns false,
+// having changed nothing, if a chunk could not be parsed.
+static bool loadDataFileParallel(MedicationBPlusTree *tree, const char *text, size_t size, const char *filename, int *loaded) {
+    int chunkCount = scanThreadCount() * SCAN_RUNS_PER_THREAD;
+    if ((long)size / chunkCount < PARALLEL_LOAD_MIN_CHUNK_BYTES) chunkCount = (int)(size / PARALLEL_LOAD_MIN_CHUNK_BYTES);
+    if (chunkCount > SCAN_MAX_RUNS) chunkCount = SCAN_MAX_RUNS;
+    if (chunkCount < 2) return false;
+
+    ParsedChunk *chunks = (ParsedChunk*)calloc(chunkCount, sizeof(ParsedChunk));
+    if (!chunks) return false;
+    const char *end = text + size;
+    const char *start = text;
+    for (int c = 0; c < chunkCount; c++) {
+        const char *stop = (c == chunkCount - 1) ? end : nextRecordBoundary(text + size / chunkCount * (c + 1), end);
+        if (stop < start) stop = start;
+        DataFileScanner scanner = { start, stop, 1, filename, false, true };  // Errors are reported by the sequential retry
+        chunks[c].scanner = scanner;
+        start = stop;
+    }
+
+    runOnWorkerPool(parseChunkTask, chunks, chunkCount);
+
+    for (int c = 0; c < chunkCount; c++) {
+        if (chunks[c].failed) {
+            freeParsedChunks(chunks, chunkCount);
+            return false;
+        }
+    }
+    *loaded = buildFromParsedChunks(tree, chunks, chunkCount);
+    freeParsedChunks(chunks, chunkCount);
+    return true;
+}
+
+// Loads filename into tree. Records are only applied once fully parsed, so a
+// malformed record stops the load after the records before it, with the line
+// of the problem reported.
+void ReadFileAndStoreData(const char* filename , MedicationBPlusTree *tree) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        printf("Unable to open file %s\n", filename);
+        return;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        printf("Unable to read file %s\n", filename);
+        close(fd);
+        return;
+    }
+    size_t size = st.st_size;
+    void *base = size ? mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0) : NULL;
+    close(fd);
+    if (base == MAP_FAILED) {
+        printf("Unable to map file %s\n", filename);
+        return;
+    }
+    if (base) madvise(base, size, MADV_SEQUENTIAL);
+    STAT_TIMER_START(load);
+    double start = nowSeconds();
+
+    const char *text = base ? (const char*)base : "";
+    DataFileScanner scanner = { text, text + size, 1, filename, false, false };
+    int count = 0;
+    bool parallel = size >= PARALLEL_LOAD_MIN_BYTES && scanThreadCount() > 1 && !tree->root
+                 && !expirationTree->root && !uniqueSupplierTree->root
+                 && loadDataFileParallel(tree, text, size, filename, &count);
+    if (parallel) {
+        scanner.cursor = scanner.end;
+    } else {
+        count = loadDataFileSequential(tree, &scanner);
+    }
+    size_t consumed = scanner.cursor - text;
+    if (base) munmap(base, size);
+    STAT_TIMER_STOP(load, STAT_LOAD);
+
+    double elapsed = nowSeconds() - start;
+    printf("Loaded %d medications (%.1f MB) from %s in %.3f s, %.1f MB/s%s%s\n", count, consumed / 1e6, filename,
+           elapsed, elapsed > 0 ? consumed / 1e6 / elapsed : 0.0, parallel ? " in parallel" : "",
+           scanner.failed ? "; stopped at the error above" : "");
+}
+//==============================================================================
+// Binary snapshot: a checksummed image of all four trees that is mapped at
+// startup and only turned back into tree nodes when the first write needs them.
+
+#define SNAPSHOT_MAGIC "PHSNAP1"
+#define SNAPSHOT_VERSION 4
+
+typedef struct SnapshotHeader {
+    char magic[8];
+    unsigned int version;
+    unsigned int headerSize;                   // Record sizes guard against layout changes
+    unsigned int medicationSize;
+    unsigned int supplierSize;
+    unsigned int uniqueSupplierSize;
+    unsigned int expirationSize;
+    unsigned long medicationCount;
+    unsigned long supplierCount;
+    unsigned long uniqueSupplierCount;
+    unsigned long expirationCount;
+    unsigned long payloadBytes;                // Everything after the header
+    unsigned long checksum;                    // Over the payload
+    unsigned long lastLsn;                     // Last write-ahead log record already applied
+} SnapshotHeader;
+
+// Medications are stored in ID order; each owns a run of the supplier section.
+typedef struct SnapshotMedication {
+    MedicationData data;                       // Suppliers is NULL on disk
+    unsigned long firstSupplier;
+    unsigned long supplierCount;
+} SnapshotMedication;
+
+typedef struct Snapshot {
+    void *base;
+    size_t size;
+    const SnapshotHeader *header;
+    const SnapshotMedication *medications;
+    const SupplierData *suppliers;
+    const UniqueSupplierData *uniqueSuppliers;
+    const ExpirationIndexData *expirations;
+} Snapshot;
+
+// Mapped snapshot that has not been materialized yet, if any
+Snapshot *activeSnapshot = NULL;
+
+// Word-at-a-time FNV-1a; every record size is a multiple of 8 bytes.
+static unsigned long snapshotChecksum(unsigned long hash, const void *data, size_t bytes) {
+    const unsigned long *words = (const unsigned long*)data;
+    for (size_t i = 0; i < bytes / sizeof(unsigned long); i++) {
+        hash = (hash ^ words[i]) * 0x100000001b3UL;
+    }
+    return hash;
+}
+
+static bool writeSnapshotBlock(FILE *file, const void *data, size_t bytes, unsigned long *hash) {
+    *hash = snapshotChecksum(*hash, data, bytes);
+    return fwrite(data, 1, bytes, file) == bytes;
+}
+
+// Writes the trees to filename (via a temporary file, so a crash leaves the old snapshot intact).
+// lastLsn marks how much of the write-ahead log the snapshot already contains.
+bool saveSnapshot(const char *filename, MedicationBPlusTree *tree, unsigned long lastLsn) {
+    char tempName[512];
+    snprintf(tempName, sizeof(tempName), "%s.tmp", filename);
+
+    FILE *file = fopen(tempName, "wb");
+    if (!file) {
+        printf("Unable to open file %s for writing.\n", tempName);
+        return false;
+    }
+
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.headerSize = sizeof(SnapshotHeader);
+    header.medicationSize = sizeof(SnapshotMedication);
+    header.supplierSize = sizeof(SupplierData);
+    header.uniqueSupplierSize = sizeof(UniqueSupplierData);
+    header.expirationSize = sizeof(ExpirationIndexData);
+    header.lastLsn = lastLsn;
+
+    // Header is rewritten with the counts and checksum at the end
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    unsigned long hash = 0xcbf29ce484222325UL;
+
+    // Medications, counting supplier runs as we go
+    for (MedicationLeafNode *leaf = tree->leftmost_leaf; ok && leaf; leaf = leaf->next) {
+        for (int i = 0; ok && i < leaf->cursize; i++) {
+            SnapshotMedication entry;
+            memset(&entry, 0, sizeof(entry));
+            entry.data = *leaf->values[i];
+            entry.data.Suppliers = NULL;
+            entry.firstSupplier = header.supplierCount;
+
+            SupplierBPlusTree *suppliers = leaf->values[i]->Suppliers;
+            for (SupplierLeafNode *s = suppliers ? suppliers->leftmost_leaf : NULL; s; s = s->next) {
+                entry.supplierCount += s->cursize;
+            }
+            header.supplierCount += entry.supplierCount;
+
+            ok = writeSnapshotBlock(file, &entry, sizeof(entry), &hash);
+            header.medicationCount++;
+        }
+    }
+
+    for (MedicationLeafNode *leaf = tree->leftmost_leaf; ok && leaf; leaf = leaf->next) {
+        for (int i = 0; ok && i < leaf->cursize; i++) {
+            SupplierBPlusTree *suppliers = leaf->values[i]->Suppliers;
+            for (SupplierLeafNode *s = suppliers ? suppliers->leftmost_leaf : NULL; ok && s; s = s->next) {
+                ok = writeSnapshotBlock(file, s->values, sizeof(SupplierData) * s->cursize, &hash);
+            }
+        }
+    }
+
+    for (UniqueSupplierLeafNode *leaf = uniqueSupplierTree->leftmost_leaf; ok && leaf; leaf = leaf->next) {
+        ok = writeSnapshotBlock(file, leaf->values, sizeof(UniqueSupplierData) * leaf->cursize, &hash);
+        header.uniqueSupplierCount += leaf->cursize;
+    }
+
+    for (ExpirationLeafNode *leaf = expirationTree->leftmost_leaf; ok && leaf; leaf = leaf->next) {
+        ok = writeSnapshotBlock(file, leaf->values, sizeof(ExpirationIndexData) * leaf->cursize, &hash);
+        header.expirationCount += leaf->cursize;
+    }
+
+    header.payloadBytes = header.medicationCount * sizeof(SnapshotMedication)
+                        + header.supplierCount * sizeof(SupplierData)
+                        + header.uniqueSupplierCount * sizeof(UniqueSupplierData)
+                        + header.expirationCount * sizeof(ExpirationIndexData);
+    header.checksum = hash;
+
+    if (ok) {
+        ok = fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1;
+    }
+    if (fclose(file) != 0) ok = false;
+
+    if (!ok || rename(tempName, filename) != 0) {
+        printf("Failed to write snapshot %s\n", filename);
+        remove(tempName);
+        return false;
+    }
+    return true;
+}
+
+// Maps filename and checks its header and checksum. Returns NULL (with a message)
+// if the file is missing, truncated, from another version or corrupt.
+Snapshot* openSnapshot(const char *filename) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SnapshotHeader)) {
+        printf("Snapshot %s is truncated.\n", filename);
+        close(fd);
+        return NULL;
+    }
+
+    void *base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        printf("Unable to map snapshot %s\n", filename);
+        return NULL;
+    }
+
+    const SnapshotHeader *header = (const SnapshotHeader*)base;
+    const char *problem = NULL;
+    if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) != 0) {
+        problem = "is not a snapshot";
+    } else if (header->version != SNAPSHOT_VERSION || header->headerSize != sizeof(SnapshotHeader)
+               || header->medicationSize != sizeof(SnapshotMedication) || header->supplierSize != sizeof(SupplierData)
+               || header->uniqueSupplierSize != sizeof(UniqueSupplierData) || header->expirationSize != sizeof(ExpirationIndexData)) {
+        problem = "was written by an incompatible version";
+    } else if (header->payloadBytes != st.st_size - sizeof(SnapshotHeader)
+               || header->payloadBytes != header->medicationCount * sizeof(SnapshotMedication)
+                                        + header->supplierCount * sizeof(SupplierData)
+                                        + header->uniqueSupplierCount * sizeof(UniqueSupplierData)
+                                        + header->expirationCount * sizeof(ExpirationIndexData)) {
+        problem = "is truncated";
+    } else if (snapshotChecksum(0xcbf29ce484222325UL, header + 1, header->payloadBytes) != header->checksum) {
+        problem = "failed its checksum";
+    }
+    if (problem) {
+        printf("Snapshot %s %s.\n", filename, problem);
+        munmap(base, st.st_size);
+        return NULL;
+    }
+
+    Snapshot *snapshot = (Snapshot*)malloc(sizeof(Snapshot));
+    snapshot->base = base;
+    snapshot->size = st.st_size;
+    snapshot->header = header;
+    snapshot->medications = (const SnapshotMedication*)(header + 1);
+    snapshot->suppliers = (const SupplierData*)(snapshot->medications + header->medicationCount);
+    snapshot->uniqueSuppliers = (const UniqueSupplierData*)(snapshot->suppliers + header->supplierCount);
+    snapshot->expirations = (const ExpirationIndexData*)(snapshot->uniqueSuppliers + header->uniqueSupplierCount);
+    return snapshot;
+}
+
+void closeSnapshot(Snapshot *snapshot) {
+    if (!snapshot) return;
+    munmap(snapshot->base, snapshot->size);
+    free(snapshot);
+}
+
+// Binary search over the mapped medications; the record is read-only.
+const MedicationData* findSnapshotMedication(const Snapshot *snapshot, unsigned long id) {
+    long low = 0, high = (long)snapshot->header->medicationCount - 1;
+    while (low <= high) {
+        long mid = low + (high - low) / 2;
+        unsigned long key = snapshot->medications[mid].data.Medication_ID;
+        if (key == id) return &snapshot->medications[mid].data;
+        if (key < id) low = mid + 1;
+        else high = mid - 1;
+    }
+    return NULL;
+}
+
+// Builds the in-memory trees from the active snapshot and unmaps it.
+// A no-op once done, so every write path can call it unconditionally.
+bool materializeSnapshot(MedicationBPlusTree *tree) {
+    Snapshot *snapshot = activeSnapshot;
+    if (!snapshot) return true;
+
+    const SnapshotHeader *header = snapshot->header;
+    int count = (int)header->medicationCount;
+    MedicationData **records = (MedicationData**)malloc(sizeof(MedicationData*) * (count ? count : 1));
+    if (!records) return false;
+
+    for (int i = 0; i < count; i++) {
+        const SnapshotMedication *entry = &snapshot->medications[i];
+        MedicationData *record = (MedicationData*)poolAlloc(&tree->records);
+        *record = entry->data;
+        record->Suppliers = createSupplierBPlusTree(tree);
+        for (unsigned long j = 0; j < entry->supplierCount; j++) {
+            insertSupplier(record->Suppliers, snapshot->suppliers[entry->firstSupplier + j]);
+        }
+        records[i] = record;
+    }
+    bool ok = bulkLoadMedications(tree, records, count, bulkLoadFillFactor);
+    free(records);
+
+    for (unsigned long i = 0; i < header->uniqueSupplierCount; i++) {
+        const UniqueSupplierData *s = &snapshot->uniqueSuppliers[i];
+        insertUniqueSupplier(uniqueSupplierTree, s->Supplier_ID, s->Supplier_Name, s->noOfUniqueMedicines, s->turnoverProduced);
+    }
+
+    // The expiration loader copies out of its input, so the mapping can be used directly
+    ok = ok && bulkLoadExpirationTree(expirationTree, (ExpirationIndexData*)snapshot->expirations,
+                                      (int)header->expirationCount, bulkLoadFillFactor);
+
+    activeSnapshot = NULL;
+    closeSnapshot(snapshot);
+    return ok;
+}
+
+//==============================================================================
+// Write-ahead log: each mutation is appended as it is applied and replayed over
+// the snapshot at startup. Checkpoints write a fresh snapshot from a forked child
+// and then drop the log records it covers.
+
+#define WAL_MAGIC "PHWAL02"
+#define WAL_GROUP_COMMIT_RECORDS 64
+#define WAL_GROUP_COMMIT_SECONDS 0.01
+#define WAL_DEFAULT_CHECKPOINT_BYTES (64L << 20)
+
+typedef struct WalRecordHeader {
+    unsigned int type;                         // WalRecordType
+    unsigned int length;                       // Payload bytes, a multiple of 8
+    unsigned long lsn;                         // Log sequence number, increasing across checkpoints
+    unsigned long checksum;                    // Over type, length, lsn and the payload
+} WalRecordHeader;
+
+// Insert, update and supplier records carry the medication as it is after the change.
+typedef struct WalMedicationImage {
+    MedicationData data;                       // Suppliers is NULL in the log
+    unsigned long supplierCount;               // SupplierData entries that follow
+} WalMedicationImage;
+
+typedef struct WalSale {
+    unsigned long id;
+    long quantity;
+} WalSale;
+
+typedef struct Wal {
+    char *path;
+    int fd;
+    WalDurability durability;
+    unsigned long nextLsn;
+    off_t size;                                // Bytes in the log file
+    int unsyncedRecords;                       // Written but not yet fdatasync'ed (group mode)
+    int batchDepth;                            // Open walBeginBatch calls; syncing waits for the last walEndBatch
+    double lastSync;
+    char *buffer;                              // Record being assembled
+    size_t bufferSize;
+
+    MedicationBPlusTree *tree;                 // What checkpoints write out
+    const char *snapshotPath;
+    long checkpointBytes;                      // Log size that triggers a checkpoint
+    pid_t checkpointPid;                       // Running checkpoint child, or 0
+    off_t checkpointOffset;                    // Log size when that child forked
+} Wal;
+
+Wal *activeWal = NULL;
+
+static unsigned long walRecordChecksum(const WalRecordHeader *header, const void *payload) {
+    unsigned long hash = snapshotChecksum(0xcbf29ce484222325UL, header, offsetof(WalRecordHeader, checksum));
+    return snapshotChecksum(hash, payload, header->length);
+}
+
+static bool writeFully(int fd, const void *data, size_t bytes) {
+    const char *p = (const char*)data;
+    while (bytes > 0) {
+        ssize_t n = write(fd, p, bytes);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        bytes -= n;
+    }
+    return true;
+}
+
+static void walSync(Wal *wal) {
+    if (wal->unsyncedRecords == 0) return;
+    fdatasync(wal->fd);
+    wal->unsyncedRecords = 0;
+    wal->lastSync = nowSeconds();
+}
+
+// Returns room for a payload of length bytes after the record header.
+static void* walReserve(Wal *wal, size_t length) {
+    size_t needed = sizeof(WalRecordHeader) + length;
+    if (needed > wal->bufferSize) {
+        wal->buffer = (char*)realloc(wal->buffer, needed);
+        wal->bufferSize = needed;
+    }
+    return wal->buffer + sizeof(WalRecordHeader);
+}
+
+static void walPollCheckpoint(Wal *wal, bool wait);
+bool walCheckpoint(Wal *wal);
+
+// Appends the reserved payload as one record and applies the durability mode.
+static void walCommit(Wal *wal, WalRecordType type, size_t length) {
+    WalRecordHeader *header = (WalRecordHeader*)wal->buffer;
+    header->type = type;
+    header->length = (unsigned int)length;
+    header->lsn = wal->nextLsn++;
+    header->checksum = walRecordChecksum(header, header + 1);
+
+    size_t bytes = sizeof(WalRecordHeader) + length;
+    if (!writeFully(wal->fd, wal->buffer, bytes)) {
+        printf("Error: unable to append to write-ahead log %s\n", wal->path);
+        return;
+    }
+    wal->size += bytes;
+    wal->unsyncedRecords++;
+
+    // Records inside a batch are synced together by walEndBatch
+    if (wal->batchDepth == 0 && wal->durability == WAL_SYNC_EACH) {
+        walSync(wal);
+    } else if (wal->batchDepth == 0 && wal->durability == WAL_SYNC_GROUP) {
+        if (wal->unsyncedRecords >= WAL_GROUP_COMMIT_RECORDS || nowSeconds() - wal->lastSync >= WAL_GROUP_COMMIT_SECONDS) {
+            walSync(wal);
+        }
+    }
+
+    walPollCheckpoint(wal, false);
+    if (wal->size >= wal->checkpointBytes && wal->checkpointPid == 0 && wal->tree) {
+        walCheckpoint(wal);
+    }
+}
+
+void walLogMedication(WalRecordType type, const MedicationData *record) {
+    Wal *wal = activeWal;
+    if (!wal) return;
+
+    unsigned long supplierCount = 0;
+    SupplierBPlusTree *suppliers = record->Suppliers;
+    for (SupplierLeafNode *s = suppliers ? suppliers->leftmost_leaf : NULL; s; s = s->next) {
+        supplierCount += s->cursize;
+    }
+
+    size_t length = sizeof(WalMedicationImage) + supplierCount * sizeof(SupplierData);
+    WalMedicationImage *image = (WalMedicationImage*)walReserve(wal, length);
+    image->data = *record;
+    image->data.Suppliers = NULL;
+    image->supplierCount = supplierCount;
+
+    SupplierData *out = (SupplierData*)(image + 1);
+    for (SupplierLeafNode *s = suppliers ? suppliers->leftmost_leaf : NULL; s; s = s->next) {
+        memcpy(out, s->values, s->cursize * sizeof(SupplierData));
+        out += s->cursize;
+    }
+    walCommit(wal, type, length);
+}
+
+void walLogDelete(unsigned long id) {
+    if (!activeWal) return;
+    unsigned long *payload = (unsigned long*)walReserve(activeWal, sizeof(unsigned long));
+    *payload = id;
+    walCommit(activeWal, WAL_DELETE_MEDICATION, sizeof(unsigned long));
+}
+
+void walLogSale(unsigned long id, int quantity) {
+    if (!activeWal) return;
+    WalSale *sale = (WalSale*)walReserve(activeWal, sizeof(WalSale));
+    sale->id = id;
+    sale->quantity = quantity;
+    walCommit(activeWal, WAL_SALE, sizeof(WalSale));
+}
+
+void walLogBasket(const SaleItem *items, int count) {
+    if (!activeWal || count <= 0) return;
+    WalSale *sales = (WalSale*)walReserve(activeWal, count * sizeof(WalSale));
+    for (int i = 0; i < count; i++) {
+        sales[i].id = items[i].id;
+        sales[i].quantity = items[i].quantity;
+    }
+    walCommit(activeWal, WAL_SALE_BASKET, count * sizeof(WalSale));
+}
+
+// Logs the supplier's current totals; a zero medicine count means it was removed.
+void walLogUniqueSupplier(unsigned long supplierID) {
+    if (!activeWal) return;
+    UniqueSupplierData *data = (UniqueSupplierData*)walReserve(activeWal, sizeof(UniqueSupplierData));
+    memset(data, 0, sizeof(UniqueSupplierData));
+    data->Supplier_ID = supplierID;
+
+    UniqueSupplierNode *leaf2 = findUniqueSupplierLeafNode(uniqueSupplierTree, supplierID);
+    if (leaf2) {
+        int i = findKeyIndex(leaf2->leaf.keys, leaf2->leaf.cursize, supplierID);
+        if (i != -1) *data = leaf2->leaf.values[i];
+    }
+    walCommit(activeWal, WAL_UNIQUE_SUPPLIER, sizeof(UniqueSupplierData));
+}
+
+static SupplierBPlusTree* supplierTreeFromImage(MedicationBPlusTree *tree, const WalMedicationImage *image) {
+    SupplierBPlusTree *suppliers = createSupplierBPlusTree(tree);
+    const SupplierData *entries = (const SupplierData*)(image + 1);
+    for (unsigned long i = 0; i < image->supplierCount; i++) {
+        insertSupplier(suppliers, entries[i]);
+    }
+    return suppliers;
+}
+
+// Re-applies one logged mutation through the same functions the menu uses.
+static bool walApply(MedicationBPlusTree *tree, const WalRecordHeader *header, const void *payload) {
+    switch (header->type) {
+        case WAL_INSERT_MEDICATION: {
+            const WalMedicationImage *image = (const WalMedicationImage*)payload;
+            if (header->length != sizeof(WalMedicationImage) + image->supplierCount * sizeof(SupplierData)) return false;
+            MedicationData data = image->data;
+            data.Suppliers = supplierTreeFromImage(tree, image);
+            insertIntoExpirationTree(expirationTree, medicationExpirationKey(&data), data.Medication_ID, data.Medicine_Name);
+            insertMedication(tree, data);
+            return true;
+        }
+        case WAL_UPDATE_MEDICATION:
+        case WAL_SUPPLIER_CHANGE: {
+            const WalMedicationImage *image = (const WalMedicationImage*)payload;
+            if (header->length != sizeof(WalMedicationImage) + image->supplierCount * sizeof(SupplierData)) return false;
+            MedicationData *record = findMedication(tree, image->data.Medication_ID);
+            if (record) {
+                MedicationData data = image->data;
+                data.Suppliers = supplierTreeFromImage(tree, image);
+                replaceMedicationRecord(tree, record, &data);
+            }
+            return true;
+        }
+        case WAL_DELETE_MEDICATION:
+            if (header->length != sizeof(unsigned long)) return false;
+            deleteMedicationByID(tree, *(const unsigned long*)payload);
+            return true;
+        case WAL_SALE: {
+            if (header->length != sizeof(WalSale)) return false;
+            const WalSale *sale = (const WalSale*)payload;
+            sellMedication(tree, sale->id, (int)sale->quantity);
+            return true;
+        }
+        case WAL_SALE_BASKET: {
+            if (header->length == 0 || header->length % sizeof(WalSale) != 0) return false;
+            const WalSale *sales = (const WalSale*)payload;
+            int count = (int)(header->length / sizeof(WalSale));
+            SaleItem *items = (SaleItem*)malloc(count * sizeof(SaleItem));
+            if (!items) return false;
+            for (int i = 0; i < count; i++) {
+                items[i].id = sales[i].id;
+                items[i].quantity = (int)sales[i].quantity;
+            }
+            sellBasket(tree, items, count, NULL);
+            free(items);
+            return true;
+        }
+        case WAL_UNIQUE_SUPPLIER: {
+            if (header->length != sizeof(UniqueSupplierData)) return false;
+            const UniqueSupplierData *data = (const UniqueSupplierData*)payload;
+            UniqueSupplierNode *leaf2 = findUniqueSupplierLeafNode(uniqueSupplierTree, data->Supplier_ID);
+            int i = leaf2 ? findKeyIndex(leaf2->leaf.keys, leaf2->leaf.cursize, data->Supplier_ID) : -1;
+            if (data->noOfUniqueMedicines == 0) {
+                deleteUniqueSupplier(uniqueSupplierTree, data->Supplier_ID);
+            } else if (i != -1) {
+                UniqueSupplierData *held = &leaf2->leaf.values[i];
+                setUniqueSupplierTotals(uniqueSupplierTree, held, data->noOfUniqueMedicines, data->turnoverProduced);
+                strcpy(held->Supplier_Name, data->Supplier_Name);
+            } else {
+                insertUniqueSupplier(uniqueSupplierTree, data->Supplier_ID, data->Supplier_Name, data->noOfUniqueMedicines, data->turnoverProduced);
+            }
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+// Replays every record newer than afterLsn. A torn or corrupt tail (from a crash
+// mid-append) is cut off so that new records follow the last good one.
+static bool walReplay(Wal *wal, unsigned long afterLsn) {
+    struct stat st;
+    if (fstat(wal->fd, &st) != 0) return false;
+
+    if (st.st_size < (off_t)sizeof(WAL_MAGIC)) {
+        // New (or empty) log
+        if (ftruncate(wal->fd, 0) != 0 || !writeFully(wal->fd, WAL_MAGIC, sizeof(WAL_MAGIC))) return false;
+        fdatasync(wal->fd);
+        wal->size = sizeof(WAL_MAGIC);
+        wal->nextLsn = afterLsn + 1;
+        return true;
+    }
+
+    char *data = (char*)malloc(st.st_size);
+    if (!data || pread(wal->fd, data, st.st_size, 0) != st.st_size) {
+        free(data);
+        return false;
+    }
+    if (memcmp(data, WAL_MAGIC, sizeof(WAL_MAGIC)) != 0) {
+        printf("%s is not a write-ahead log.\n", wal->path);
+        free(data);
+        return false;
+    }
+
+    off_t offset = sizeof(WAL_MAGIC);
+    unsigned long lastLsn = afterLsn;
+    int replayed = 0;
+    while (offset + (off_t)sizeof(WalRecordHeader) <= st.st_size) {
+        const WalRecordHeader *header = (const WalRecordHeader*)(data + offset);
+        off_t end = offset + sizeof(WalRecordHeader) + header->length;
+        if (header->length % 8 != 0 || end > st.st_size || header->checksum != walRecordChecksum(header, header + 1)) {
+            break;
+        }
+        if (header->lsn > afterLsn) {
+            materializeSnapshot(wal->tree);
+            if (!walApply(wal->tree, header, header + 1)) break;
+            replayed++;
+        }
+        if (header->lsn > lastLsn) lastLsn = header->lsn;
+        offset = end;
+    }
+    free(data);
+
+    if (offset < st.st_size) {
+        printf("Write-ahead log %s: dropping %ld bytes of incomplete records.\n", wal->path, (long)(st.st_size - offset));
+        if (ftruncate(wal->fd, offset) != 0) return false;
+    }
+    if (replayed > 0) {
+        printf("Write-ahead log %s: replayed %d records.\n", wal->path, replayed);
+    }
+
+    wal->size = offset;
+    wal->nextLsn = lastLsn + 1;
+    return true;
+}
+
+// Opens (or creates) the log at path and replays it over tree. Records up to
+// snapshotLsn are already part of the loaded snapshot and are skipped.
+Wal* walOpen(const char *path, WalDurability durability, MedicationBPlusTree *tree, const char *snapshotPath, unsigned long snapshotLsn) {
+    Wal *wal = (Wal*)calloc(1, sizeof(Wal));
+    if (!wal) return NULL;
+
+    wal->path = strdup(path);
+    wal->durability = durability;
+    wal->tree = tree;
+    wal->snapshotPath = snapshotPath;
+    wal->checkpointBytes = WAL_DEFAULT_CHECKPOINT_BYTES;
+    wal->lastSync = nowSeconds();
+    wal->fd = open(path, O_RDWR | O_CREAT | O_APPEND, 0644);
+
+    if (wal->fd < 0 || !walReplay(wal, snapshotLsn)) {
+        printf("Unable to open write-ahead log %s\n", path);
+        if (wal->fd >= 0) close(wal->fd);
+        free(wal->path);
+        free(wal);
+        return NULL;
+    }
+    return wal;
+}
+
+// Rewrites the log without its first upTo bytes of records (the part the new
+// snapshot covers). The rename makes the switch atomic.
+static bool walCompact(Wal *wal, off_t upTo) {
+    char tempName[512];
+    snprintf(tempName, sizeof(tempName), "%s.tmp", wal->path);
+
+    int fd = open(tempName, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+
+    bool ok = writeFully(fd, WAL_MAGIC, sizeof(WAL_MAGIC));
+    off_t tail = wal->size - upTo;
+    char *buffer = (char*)malloc(tail > 0 ? tail : 1);
+    if (ok && tail > 0) {
+        ok = buffer && pread(wal->fd, buffer, tail, upTo) == tail && writeFully(fd, buffer, tail);
+    }
+    free(buffer);
+
+    if (ok) ok = fdatasync(fd) == 0 && rename(tempName, wal->path) == 0;
+    if (!ok) {
+        close(fd);
+        unlink(tempName);
+        return false;
+    }
+
+    close(wal->fd);
+    fcntl(fd, F_SETFL, O_APPEND);
+    wal->fd = fd;
+    wal->size = sizeof(WAL_MAGIC) + tail;
+    wal->unsyncedRecords = 0;
+    return true;
+}
+
+// Reaps a finished checkpoint child and compacts the log behind it.
+static void walPollCheckpoint(Wal *wal, bool wait) {
+    if (wal->checkpointPid == 0) return;
+
+    int status;
+    pid_t done = waitpid(wal->checkpointPid, &status, wait ? 0 : WNOHANG);
+    if (done == 0) return;
+
+    wal->checkpointPid = 0;
+    if (done < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        printf("Checkpoint failed; the write-ahead log is kept in full.\n");
+        return;
+    }
+    if (!walCompact(wal, wal->checkpointOffset)) {
+        printf("Checkpoint written, but the write-ahead log could not be compacted.\n");
+    }
+}
+
+// Starts a background checkpoint: a forked child writes the snapshot from its
+// copy-on-write view of the trees while this process keeps logging.
+bool walCheckpoint(Wal *wal) {
+    walPollCheckpoint(wal, false);
+    if (wal->checkpointPid != 0) return false;  // One at a time
+
+    materializeSnapshot(wal->tree);
+    walSync(wal);
+
+    unsigned long lastLsn = wal->nextLsn - 1;
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        printf("Checkpoint failed: unable to fork.\n");
+        return false;
+    }
+    if (pid == 0) {
+        _exit(saveSnapshot(wal->snapshotPath, wal->tree, lastLsn) ? 0 : 1);
+    }
+
+    wal->checkpointPid = pid;
+    wal->checkpointOffset = wal->size;
+    return true;
+}
+
+// Makes everything logged so far durable, e.g. before waiting for input.
+void walFlush(Wal *wal) {
+    if (wal) walSync(wal);
+}
+
+// Records logged between walBeginBatch and the matching walEndBatch share one
+// fdatasync, whatever the durability mode. Batches may nest.
+void walBeginBatch(void) {
+    if (activeWal) activeWal->batchDepth++;
+}
+
+void walEndBatch(void) {
+    Wal *wal = activeWal;
+    if (!wal || wal->batchDepth == 0) return;
+    if (--wal->batchDepth == 0 && wal->durability != WAL_SYNC_NONE) walSync(wal);
+}
+
+void walClose(Wal *wal) {
+    if (!wal) return;
+    walPollCheckpoint(wal, true);
+    walSync(wal);
+    close(wal->fd);
+    free(wal->buffer);
+    free(wal->path);
+    free(wal);
+}
+
+void searchMedicationByID(MedicationBPlusTree *tree, unsigned long id) {
+    printf("Searching for medication with ID %lu...\n", id);
+
+    // Served straight from the mapping until something forces materialization
+    if (activeSnapshot) {
+        const MedicationData *medication = findSnapshotMedication(activeSnapshot, id);
+        if (medication) {
+            printf("Medication found:\n");
+            printMedicationDetails((MedicationData*)medication);
+        } else {
+            printf("Medication ID %lu not found in the tree.\n", id);
+        }
+        return;
+    }
+
+    if (!tree || !tree->root) {
+        printf("The medication B+ tree is empty.\n");
+        return;
+    }
+
+    MedicationData *medication = findMedication(tree, id);
+    if (medication) {
+        printf("Medication found:\n");
+        printMedicationDetails(medication);
+        return;
+    }
+
+    // If the ID is not found in the leaf node
+    printf("Medication ID %lu not found in the tree.\n", id);
+}
+
+void printTreeStructure(MedicationNode *node, int level) {
+    if (!node) {
+        printf("Empty tree\n");
+        return;
+    }
+    
+    printf("Level %d: ", level);
+    if (node->isLeaf) {
+        printf("Leaf Node Keys: ");
+        for (int i = 0; i < node->leaf.cursize; i++) {
+            printf("%lu ", node->leaf.keys[i]);
+        }
+        printf("\n");
+    } else {
+        printf("Internal Node Keys: ");
+        for (int i = 0; i < node->internal.cursize; i++) {
+            printf("%lu ", node->internal.keys[i]);
+        }
+        printf("\n");
+        
+        // Recursively print children
+        for (int i = 0; i <= node->internal.cursize; i++) {
+            printTreeStructure(node->internal.children[i], level + 1);
+        }
+    }
+}
+
+//==============================================================================
+// Tree shape report: height, node counts and leaf fill for each tree. After
+// heavy deletes the heights should still track log(n) and no node other than
+// a root should sit below the minimum occupancy.
+
+static void addMedicationNodeShape(MedicationNode *node, int depth, int minKeys, TreeShape *shape) {
+    int keys = node->isLeaf ? node->leaf.cursize : node->internal.cursize;
+    if (depth > shape->height) shape->height = depth;
+    if (depth > 1 && keys < minKeys) shape->underfull++;
+
+    if (node->isLeaf) {
+        shape->leaves++;
+        shape->keys += keys;
+        shape->leafSlots += node->leaf.order - 1;
+        return;
+    }
+    shape->internalNodes++;
+    for (int i = 0; i <= keys; i++) {
+        addMedicationNodeShape(node->internal.children[i], depth + 1, minKeys, shape);
+    }
+}
+
+static void addSupplierNodeShape(SupplierNode *node, int depth, int minKeys, TreeShape *shape) {
+    int keys = node->isLeaf ? node->leaf.cursize : node->internal.cursize;
+    if (depth > shape->height) shape->height = depth;
+    if (depth > 1 && keys < minKeys) shape->underfull++;
+
+    if (node->isLeaf) {
+        shape->leaves++;
+        shape->keys += keys;
+        shape->leafSlots += node->leaf.order - 1;
+        return;
+    }
+    shape->internalNodes++;
+    for (int i = 0; i <= keys; i++) {
+        addSupplierNodeShape(node->internal.children[i], depth + 1, minKeys, shape);
+    }
+}
+
+static void addUniqueSupplierNodeShape(UniqueSupplierNode *node, int depth, int minKeys, TreeShape *shape) {
+    int keys = node->isLeaf ? node->leaf.cursize : node->internal.cursize;
+    if (depth > shape->height) shape->height = depth;
+    if (depth > 1 && keys < minKeys) shape->underfull++;
+
+    if (node->isLeaf) {
+        shape->leaves++;
+        shape->keys += keys;
+        shape->leafSlots += node->leaf.order - 1;
+        return;
+    }
+    shape->internalNodes++;
+    for (int i = 0; i <= keys; i++) {
+        addUniqueSupplierNodeShape(node->internal.children[i], depth + 1, minKeys, shape);
+    }
+}
+
+static void addExpirationNodeShape(ExpirationNode *node, int depth, int minKeys, TreeShape *shape) {
+    int keys = node->isLeaf ? node->leaf.cursize : node->internal.cursize;
+    if (depth > shape->height) shape->height = depth;
+    if (depth > 1 && keys < minKeys) shape->underfull++;
+
+    if (node->isLeaf) {
+        shape->leaves++;
+        shape->keys += keys;
+        shape->leafSlots += node->leaf.order - 1;
+        return;
+    }
+    shape->internalNodes++;
+    for (int i = 0; i <= keys; i++) {
+        addExpirationNodeShape(node->internal.children[i], depth + 1, minKeys, shape);
+    }
+}
+
+void printTreeShape(const char *name, const TreeShape *shape) {
+    double fill = shape->leafSlots ? 100.0 * shape->keys / shape->leafSlots : 0.0;
+    printf("%-16s %7d %7d %10ld %10ld %12ld %7.1f%% %10ld\n", name, shape->trees, shape->height,
+           shape->leaves, shape->internalNodes, shape->keys, fill, shape->underfull);
+}
+
+static void addSupplierShapeRun(MedicationLeafNode *first, MedicationLeafNode *end, void *partial, void *context) {
+    TreeShape *shape = (TreeShape*)partial;
+    int minKeys = *(const int*)context;
+    for (MedicationLeafNode *leaf = first; leaf != end; leaf = leaf->next) {
+        for (int i = 0; i < leaf->cursize; i++) {
+            SupplierBPlusTree *supplierTree = leaf->values[i]->Suppliers;
+            if (!supplierTree || !supplierTree->root) continue;
+            shape->trees++;
+            addSupplierNodeShape(supplierTree->root, 1, minKeys, shape);
+        }
+    }
+}
+
+void printTreeShapeReport(MedicationBPlusTree *pharmacy) {
+    TreeShape medications = {0}, suppliers = {0}, uniqueSuppliers = {0}, expirations = {0};
+    int minKeys = (pharmacy->order - 1) / 2;
+
+    if (pharmacy->root) {
+        medications.trees = 1;
+        addMedicationNodeShape(pharmacy->root, 1, minKeys, &medications);
+    }
+    // One supplier tree per medication, walked in parallel and summed
+    void *partials;
+    int runs = scanMedicationsParallel(pharmacy, addSupplierShapeRun, &minKeys, sizeof(TreeShape), &partials);
+    for (int i = 0; i < runs; i++) {
+        const TreeShape *part = (const TreeShape*)partials + i;
+        suppliers.trees += part->trees;
+        if (part->height > suppliers.height) suppliers.height = part->height;
+        suppliers.leaves += part->leaves;
+        suppliers.internalNodes += part->internalNodes;
+        suppliers.keys += part->keys;
+        suppliers.leafSlots += part->leafSlots;
+        suppliers.underfull += part->underfull;
+    }
+    free(partials);
+    if (uniqueSupplierTree && uniqueSupplierTree->root) {
+        uniqueSuppliers.trees = 1;
+        addUniqueSupplierNodeShape(uniqueSupplierTree->root, 1, (uniqueSupplierTree->order - 1) / 2, &uniqueSuppliers);
+    }
+    if (expirationTree && expirationTree->root) {
+        expirations.trees = 1;
+        addExpirationNodeShape(expirationTree->root, 1, (expirationTree->order - 1) / 2, &expirations);
+    }
+
+    printf("\n%-16s %7s %7s %10s %10s %12s %8s %10s\n", "tree", "trees", "height", "leaves", "internal", "keys", "fill", "underfull");
+    printTreeShape("medication", &medications);
+    printTreeShape("supplier", &suppliers);
+    printTreeShape("unique supplier", &uniqueSuppliers);
+    printTreeShape("expiration", &expirations);
+}
+
+void SaveDataToFile(const char* filename, MedicationBPlusTree* tree) {
+    if (!tree || !tree->root) {
+        printf("The medication B+ tree is empty. Nothing to save.\n");
+        return;
+    }
+
+    FILE* file = fopen(filename, "w");
+    if (!file) {
+        printf("Unable to open file %s for writing.\n", filename);
+        return;
+    }
+    STAT_TIMER_START(save);
+
+    printf("Saving data to file: %s\n", filename);
+
+    // Start from the leftmost leaf
+    MedicationLeafNode* current = tree->leftmost_leaf;
+
+    // Traverse all leaf nodes
+    while (current != NULL) {
+        for (int i = 0; i < current->cursize; i++) {
+            MedicationData* medication = current->values[i];
+
+            // Write medication details
+            fprintf(file, "%lu\n", medication->Medication_ID);
+            fprintf(file, "%s\n", medication->Medicine_Name);
+            fprintf(file, "%u\n", medication->Quantity_in_stock);
+            fprintf(file, "%u\n", medication->Price_per_Unit);
+            fprintf(file, "%s\n", medication->Batch_details.Batch);
+            fprintf(file, "%d %d %d\n", 
+                medication->Batch_details.Expiration_Date.day,
+                medication->Batch_details.Expiration_Date.month,
+                medication->Batch_details.Expiration_Date.year);
+
+            // Write supplier details
+            SupplierBPlusTree* suppliers = medication->Suppliers;
+            if (suppliers && suppliers->root) {
+                SupplierLeafNode* supplierLeaf = suppliers->leftmost_leaf;
+                int supplierCount = 0;
+
+                // Count the number of suppliers
+                while (supplierLeaf != NULL) {
+                    supplierCount += supplierLeaf->cursize;
+                    supplierLeaf = supplierLeaf->next;
+                }
+
+                fprintf(file, "%d\n", supplierCount);
+
+                // Write supplier details
+                supplierLeaf = suppliers->leftmost_leaf;
+                while (supplierLeaf != NULL) {
+                    for (int j = 0; j < supplierLeaf->cursize; j++) {
+                        SupplierData* supplier = &supplierLeaf->values[j];
+                        fprintf(file, "%lu\n", supplier->Supplier_ID);
+                        fprintf(file, "%s\n", supplier->Supplier_Name);
+                        fprintf(file, "%u\n", supplier->Quantity_of_stock_bysupplier);
+                        fprintf(file, "%s\n", supplier->Contact);
+                    }
+                    supplierLeaf = supplierLeaf->next;
+                }
+            } else {
+                fprintf(file, "0\n"); // No suppliers
+            }
+
+            // Reorder level follows the suppliers, matching ReadFileAndStoreData
+            fprintf(file, "%d\n\n", medication->Reorderlevel);
+        }
+        current = current->next; // Move to the next leaf node
+    }
+
+    fclose(file);
+    STAT_TIMER_STOP(save, STAT_SAVE);
+    printf("Data successfully saved to file: %s\n", filename);
+}
+
+void supplierManagement(MedicationBPlusTree *tree, MedicationData *medication){
+
+    printf("Supplier Management...\n");
+    unsigned long id;
+    printf("Enter the Supplier ID to update: \n");
+    scanf("%lu", &id);
+    int choice;
+    printf("1. Add Supplier\n2. Update Supplier\n3. Delete Supplier\n4. Search Supplier\n5. Print All Suppliers\n0. Exit\n");
+    scanf("%d", &choice);
+
+    switch (choice) {
+        case 1:
+            printf("Adding new supplier...\n");
+            SupplierData suppl = initSupplier(medication->Suppliers, medication);
+            insertSupplier(medication->Suppliers, suppl);
+            lowStockUpdate(&tree->lowStock, medication);
+            walLogMedication(WAL_SUPPLIER_CHANGE, medication);
+            printf("\nNew supplier added successfully.\n");
+            break;
+        case 2:
+        {
+            SupplierNode *leaf2 = findSupplierLeafNode(medication->Suppliers, id);
+            SupplierLeafNode *leaf = &(leaf2->leaf);
+            if (leaf) {
+                for (int i = 0; i < leaf->cursize; i++) {
+                    if (leaf->keys[i] == id) {
+                        printf("Enter details to update:\n");
+                        printf("1. Update Supplier Name\n2. Update Quantity\n3. Update Contact\n");
+                        int updateChoice;
+                        scanf("%d", &updateChoice);
+                        switch (updateChoice) {
+                            case 1:
+                                printf("Enter new Supplier Name: ");
+                                scanf("%s", leaf->values[i].Supplier_Name);
+                                break;
+                            case 2: {
+                                unsigned int oldQuantity = leaf->values[i].Quantity_of_stock_bysupplier;
+                                printf("Enter new Quantity: ");
+                                scanf("%u", &leaf->values[i].Quantity_of_stock_bysupplier);
+
+                                // Update the unique supplier tree
+                                updateUniqueSupplierTreeAfterInsert(
+                                    leaf->keys[i],
+                                    leaf->values[i].Supplier_Name,
+                                    leaf->values[i].Quantity_of_stock_bysupplier - oldQuantity,
+                                    (leaf->values[i].Quantity_of_stock_bysupplier - oldQuantity) * medication->Price_per_Unit
+                                );
+                                
+                                // Update the medication's stock
+                                medication->Quantity_in_stock += (leaf->values[i].Quantity_of_stock_bysupplier - oldQuantity);
+                                lowStockUpdate(&tree->lowStock, medication);
+                                break;
+                            }
+                            case 3:
+                                printf("Enter new Contact: ");
+                                scanf("%s", leaf->values[i].Contact);
+                                break;
+                            default:
+                                printf("Invalid choice.\n");
+                        }
+                        walLogMedication(WAL_SUPPLIER_CHANGE, medication);
+                        printf("Supplier details updated successfully.\n");
+                        break;
+                    }
+                }
+            } else {
+                printf("Supplier ID %lu not found.\n", id);
+            }
+            break;
+        }
+        
+    case 3: {
+        unsigned long deleteId;
+        printf("Enter the Supplier ID to delete: ");
+        scanf("%lu", &deleteId);
+        if (deleteSupplierByID(medication->Suppliers, deleteId)) {
+            walLogMedication(WAL_SUPPLIER_CHANGE, medication);
+            printf("Supplier deleted successfully.\n");
+        } else {
+            printf("Supplier not found.\n");
+        }
+        break;
+    }
+    case 4: {
+        printf("Enter the Supplier ID to search: \n");
+        scanf("%lu", &id);
+        if (searchSupplier(medication->Suppliers, id)) {
+            printf("Supplier ID %lu found.\n", id);
+            printf("Details:\n");
+            SupplierNode *leaf2 = findSupplierLeafNode(medication->Suppliers, id);
+            SupplierLeafNode *leaf = &(leaf2->leaf);
+            for (int i = 0; i < leaf->cursize; i++) {
+                if (leaf->keys[i] == id) {
+                    printSupplier(&leaf->values[i]);
+                    break;
+                }
+            }
+        } else {
+            printf("Supplier ID %lu not found.\n", id);
+        }
+        break;
+    }
+    case 5: {
+        printAllSuppliers(medication->Suppliers);
+        break;
+    }
+    case 0:
+        printf("Exiting supplier management.\n");
+        break;
+    default:
+        printf("Invalid choice.\n");
+    
+    }
+    return;
+}
+
+// Records a sale of quantity units; fails without changing anything if stock is short.
+bool sellMedication(MedicationBPlusTree *tree, unsigned long id, int quantity) {
+    STAT_TIMER_START(sell);
+    pthread_mutex_lock(&tree->writer);
+    MedicationNode *leafNode = lockMedicationLeaf(tree, id);
+    int i = leafNode ? findKeyIndex(leafNode->leaf.keys, leafNode->leaf.cursize, id) : -1;
+    MedicationData *medication = (i == -1) ? NULL : leafNode->leaf.values[i];
+    bool sold = medication && quantity >= 0 && (unsigned int)quantity <= medication->Quantity_in_stock;
+    if (sold) {
+        medication->Batch_details.Total_sales += quantity;
+        medication->Quantity_in_stock -= quantity;
+    }
+    if (leafNode) olcWriteUnlock(&leafNode->version);
+
+    if (sold) {
+        lowStockUpdate(&tree->lowStock, medication);
+        walLogSale(id, quantity);
+    }
+    pthread_mutex_unlock(&tree->writer);
+    STAT_TIMER_STOP(sell, STAT_SELL);
+    return sold;
+}
+
+#define SALE_BASKET_INLINE_ITEMS 32
+
+// Sells every line of a basket or none of them. Each line is found through the
+// tree; a line whose medication is unknown or short of stock (after the lines
+// before it) undoes the ones already applied and, if failedItem is given, is
+// reported there. The basket is logged as a single record. Each record is
+// changed with its leaf locked, so concurrent lookups see whole lines.
+bool sellBasket(MedicationBPlusTree *tree, const SaleItem *items, int count, int *failedItem) {
+    MedicationData *inlineRecords[SALE_BASKET_INLINE_ITEMS];
+    MedicationData **records = inlineRecords;
+    if (count > SALE_BASKET_INLINE_ITEMS) {
+        records = (MedicationData**)malloc(count * sizeof(MedicationData*));
+        if (!records) return false;
+    }
+
+    STAT_TIMER_START(basket);
+    pthread_mutex_lock(&tree->writer);
+    int applied = 0;
+    for (; applied < count; applied++) {
+        MedicationNode *leafNode = lockMedicationLeaf(tree, items[applied].id);
+        if (!leafNode) break;
+        int i = findKeyIndex(leafNode->leaf.keys, leafNode->leaf.cursize, items[applied].id);
+        MedicationData *medication = (i == -1) ? NULL : leafNode->leaf.values[i];
+        int quantity = items[applied].quantity;
+        if (!medication || quantity < 0 || (unsigned int)quantity > medication->Quantity_in_stock) {
+            olcWriteUnlock(&leafNode->version);
+            break;
+        }
+        medication->Quantity_in_stock -= quantity;
+        medication->Batch_details.Total_sales += quantity;
+        olcWriteUnlock(&leafNode->version);
+        records[applied] = medication;
+    }
+
+    bool sold = (applied == count);
+    if (sold) {
+        for (int i = 0; i < count; i++) lowStockUpdate(&tree->lowStock, records[i]);
+        walLogBasket(items, count);
+    } else {
+        if (failedItem) *failedItem = applied;
+        while (applied-- > 0) {
+            MedicationNode *leafNode = lockMedicationLeaf(tree, items[applied].id);
+            records[applied]->Quantity_in_stock += items[applied].quantity;
+            records[applied]->Batch_details.Total_sales -= items[applied].quantity;
+            olcWriteUnlock(&leafNode->version);
+        }
+    }
+    pthread_mutex_unlock(&tree->writer);
+    STAT_TIMER_STOP(basket, STAT_SELL_BASKET);
+
+    if (records != inlineRecords) free(records);
+    return sold;
+}
+
+// Replays a point-of-sale transaction file: one basket per line, written as
+// "ID QTY" pairs ("101 2 205 1"). Blank lines and lines starting with '#' are
+// skipped. Each basket goes through sellBasket, so a basket that cannot be
+// filled leaves stock untouched.
+bool replayPosFile(MedicationBPlusTree *tree, const char *filename) {
+    FILE *file = fopen(filename, "rb");
+    if (!file) {
+        printf("Error: unable to open POS file %s\n", filename);
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char *text = (char*)malloc(size + 1);
+    if (!text || fread(text, 1, size, file) != (size_t)size) {
+        printf("Error: unable to read POS file %s\n", filename);
+        free(text);
+        fclose(file);
+        return false;
+    }
+    fclose(file);
+    text[size] = '\0';
+
+    int capacity = SALE_BASKET_INLINE_ITEMS;
+    SaleItem *items = (SaleItem*)malloc(capacity * sizeof(SaleItem));
+    if (!items) {
+        printf("Memory allocation failed while reading %s\n", filename);
+        free(text);
+        return false;
+    }
+    long baskets = 0, lines = 0, rejected = 0, malformed = 0, itemCount = 0;
+    double start = nowSeconds();
+
+    char *p = text;
+    while (*p) {
+        char *end = p;
+        while (*end && *end != '\n') end++;
+        char *nextLine = *end ? end + 1 : end;
+        lines++;
+
+        int count = 0;
+        bool valid = true, outOfMemory = false;
+        char *cursor = p;
+        while (cursor < end) {
+            while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\r')) cursor++;
+            if (cursor == end || *cursor == '#') break;
+
+            char *after;
+            unsigned long id = strtoul(cursor, &after, 10);
+            if (after == cursor) { valid = false; break; }
+            cursor = after;
+            long quantity = strtol(cursor, &after, 10);
+            if (after == cursor || after > end) { valid = false; break; }
+            if (quantity <= 0 || quantity > INT_MAX) { valid = false; break; }
+            cursor = after;
+
+            if (count == capacity) {
+                SaleItem *grown = (SaleItem*)realloc(items, capacity * 2 * sizeof(SaleItem));
+                if (!grown) { outOfMemory = true; break; }
+                items = grown;
+                capacity *= 2;
+            }
+            items[count].id = id;
+            items[count].quantity = (int)quantity;
+            count++;
+        }
+
+        if (outOfMemory) {
+            printf("Memory allocation failed while reading %s\n", filename);
+            malformed++;
+            break;
+        } else if (!valid) {
+            printf("%s:%ld: expected \"ID QTY\" pairs with quantities from 1 to %d\n", filename, lines, INT_MAX);
+            malformed++;
+        } else if (count > 0) {
+            baskets++;
+            itemCount += count;
+            if (!sellBasket(tree, items, count, NULL)) rejected++;
+        }
+        p = nextLine;
+    }
+
+    double elapsed = nowSeconds() - start;
+    printf("Replayed %ld baskets (%ld items) from %s in %.3f s, %.0f baskets/sec; %ld rejected, %ld malformed lines.\n",
+           baskets, itemCount, filename, elapsed, elapsed > 0 ? baskets / elapsed : 0.0, rejected, malformed);
+
+    free(items);
+    free(text);
+    return malformed == 0;
+}
+
+static int compareSupplierFeedRows(const void *a, const void *b) {
+    const SupplierFeedRow *x = (const SupplierFeedRow*)a;
+    const SupplierFeedRow *y = (const SupplierFeedRow*)b;
+    if (x->medicationID != y->medicationID) return (x->medicationID < y->medicationID) ? -1 : 1;
+    if (x->supplier.Supplier_ID != y->supplier.Supplier_ID) return (x->supplier.Supplier_ID < y->supplier.Supplier_ID) ? -1 : 1;
+    return (x->line > y->line) - (x->line < y->line);
+}
+
+static int compareSupplierIDs(const void *a, const void *b) {
+    unsigned long x = *(const unsigned long*)a, y = *(const unsigned long*)b;
+    return (x > y) - (x < y);
+}
+
+// Looks id up starting from the leaf in *finger, which is left on the leaf where
+// id belongs. Ascending lookups mostly stay in that leaf or the next one, so
+// they only descend from the root when they jump further.
+static MedicationData* findMedicationFrom(MedicationBPlusTree *tree, MedicationLeafNode **finger, unsigned long id) {
+    MedicationLeafNode *leaf = *finger;
+    if (leaf && leaf->cursize > 0 && id >= leaf->keys[0]) {
+        if (leaf->next && leaf->next->cursize > 0 && id >= leaf->next->keys[0]) leaf = leaf->next;
+        if (leaf->next && leaf->next->cursize > 0 && id >= leaf->next->keys[0]) leaf = NULL;
+    } else {
+        leaf = NULL;
+    }
+    if (!leaf) {
+        if (!tree->root) return NULL;
+        leaf = &(findLeafNode(tree, id)->leaf);
+    }
+
+    *finger = leaf;
+    int i = findKeyIndex(leaf->keys, leaf->cursize, id);
+    return (i == -1) ? NULL : leaf->values[i];
+}
+
+// Applies feed rows sorted by medication, supplier and line. A row sets that
+// supplier's entry for the medication, adding it if it is new, and moves the
+// medication's stock and the supplier's turnover by the change in quantity; where
+// a pair repeats the last row wins. Each medication's suppliers are merged with one
+// insertSupplierBatch call and logged once, the totals of every supplier touched
+// are logged once at the end, and the whole feed shares one WAL sync.
+// Returns the rows applied; *unknown counts rows naming no stored medication.
+long applySupplierFeed(MedicationBPlusTree *tree, const SupplierFeedRow *rows, long count, long *unknown) {
+    SupplierData *batch = (SupplierData*)malloc(sizeof(SupplierData) * (count > 0 ? count : 1));
+    unsigned long *touched = (unsigned long*)malloc(sizeof(unsigned long) * (count > 0 ? count : 1));
+    if (!batch || !touched) {
+        free(batch);
+        free(touched);
+        return 0;
+    }
+
+    long applied = 0, touchedCount = 0;
+    *unknown = 0;
+    MedicationLeafNode *finger = NULL;
+
+    walBeginBatch();
+    long start = 0;
+    while (start < count) {
+        long end = start;
+        while (end < count && rows[end].medicationID == rows[start].medicationID) end++;
+
+        MedicationData *medication = findMedicationFrom(tree, &finger, rows[start].medicationID);
+        if (!medication) {
+            *unknown += end - start;
+            start = end;
+            continue;
+        }
+        if (!medication->Suppliers) {
+            medication->Suppliers = createSupplierBPlusTree(tree);
+            attachSupplierTree(tree, medication);
+        }
+
+        // Walk the existing suppliers alongside the rows to find each one's old quantity
+        SupplierLeafNode *existing = medication->Suppliers->leftmost_leaf;
+        int e = 0, n = 0;
+        long stock = medication->Quantity_in_stock;
+        for (long r = start; r < end; r++) {
+            if (r + 1 < end && rows[r + 1].supplier.Supplier_ID == rows[r].supplier.Supplier_ID) continue;
+            const SupplierData *row = &rows[r].supplier;
+            unsigned long id = row->Supplier_ID;
+
+            while (existing && (e >= existing->cursize || existing->keys[e] < id)) {
+                if (e >= existing->cursize) {
+                    existing = existing->next;
+                    e = 0;
+                } else {
+                    e++;
+                }
+            }
+            bool known = existing && existing->keys[e] == id;
+            long previous = known ? (long)existing->values[e].Quantity_of_stock_bysupplier : 0;
+            long delta = (long)row->Quantity_of_stock_bysupplier - previous;
+            stock += delta;
+
+            // A new pair adds a medicine to the supplier; a known one only moves its turnover
+            UniqueSupplierNode *unique = known ? findUniqueSupplierLeafNode(uniqueSupplierTree, id) : NULL;
+            int u = unique ? findKeyIndex(unique->leaf.keys, unique->leaf.cursize, id) : -1;
+            if (u != -1) {
+                UniqueSupplierData *held = &unique->leaf.values[u];
+                setUniqueSupplierTotals(uniqueSupplierTree, held, held->noOfUniqueMedicines,
+                                        held->turnoverProduced + delta * (long)medication->Price_per_Unit);
+            } else {
+                insertUniqueSupplier(uniqueSupplierTree, id, row->Supplier_Name, 1,
+                                     (unsigned long)row->Quantity_of_stock_bysupplier * medication->Price_per_Unit);
+            }
+
+            touched[touchedCount++] = id;
+            batch[n++] = *row;
+        }
+
+        medication->Quantity_in_stock = (stock < 0) ? 0 : (unsigned int)stock;
+        insertSupplierBatch(medication->Suppliers, batch, n);
+        lowStockUpdate(&tree->lowStock, medication);
+        walLogMedication(WAL_SUPPLIER_CHANGE, medication);
+
+        applied += end - start;
+        start = end;
+    }
+
+    qsort(touched, touchedCount, sizeof(unsigned long), compareSupplierIDs);
+    for (long i = 0; i < touchedCount; i++) {
+        if (i == 0 || touched[i] != touched[i - 1]) walLogUniqueSupplier(touched[i]);
+    }
+    walEndBatch();
+
+    free(batch);
+    free(touched);
+    return applied;
+}
+
+// Imports a supplier feed file: one supplier per line, written as
+// "MEDICATION_ID SUPPLIER_ID NAME QUANTITY CONTACT". Blank lines and lines
+// starting with '#' are skipped. The rows are sorted and applied together
+// through applySupplierFeed.
+bool importSupplierFeed(MedicationBPlusTree *tree, const char *filename) {
+    FILE *file = fopen(filename, "rb");
+    if (!file) {
+        printf("Error: unable to open supplier feed %s\n", filename);
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char *text = (char*)malloc(size + 1);
+    if (!text || fread(text, 1, size, file) != (size_t)size) {
+        printf("Error: unable to read supplier feed %s\n", filename);
+        free(text);
+        fclose(file);
+        return false;
+    }
+    fclose(file);
+    text[size] = '\0';
+
+    long capacity = 1024, count = 0, lines = 0, malformed = 0;
+    SupplierFeedRow *rows = (SupplierFeedRow*)malloc(capacity * sizeof(SupplierFeedRow));
+    if (!rows) {
+        printf("Memory allocation failed while reading supplier feed %s\n", filename);
+        free(text);
+        return false;
+    }
+    double start = nowSeconds();
+
+    char *p = text;
+    while (*p) {
+        char *end = p;
+        while (*end && *end != '\n') end++;
+        char *nextLine = *end ? end + 1 : end;
+        *end = '\0';
+        lines++;
+
+        char *cursor = p;
+        while (*cursor == ' ' || *cursor == '\t' || *cursor == '\r') cursor++;
+        if (*cursor == '\0' || *cursor == '#') {
+            p = nextLine;
+            continue;
+        }
+
+        if (count == capacity) {
+            SupplierFeedRow *grown = (SupplierFeedRow*)realloc(rows, capacity * 2 * sizeof(SupplierFeedRow));
+            if (!grown) {
+                // Nothing has been applied yet, so the feed is dropped as a whole
+                printf("Memory allocation failed while reading supplier feed %s\n", filename);
+                free(rows);
+                free(text);
+                return false;
+            }
+            rows = grown;
+            capacity *= 2;
+        }
+        SupplierFeedRow *row = &rows[count];
+        int consumed = 0;
+        if (sscanf(cursor, "%lu %lu %99s %u %11s %n", &row->medicationID, &row->supplier.Supplier_ID,
+                   row->supplier.Supplier_Name, &row->supplier.Quantity_of_stock_bysupplier,
+                   row->supplier.Contact, &consumed) != 5 || cursor[consumed] != '\0') {
+            printf("%s:%ld: expected \"MEDICATION_ID SUPPLIER_ID NAME QUANTITY CONTACT\"\n", filename, lines);
+            malformed++;
+        } else {
+            row->line = (int)lines;
+            count++;
+        }
+        p = nextLine;
+    }
+
+    qsort(rows, count, sizeof(SupplierFeedRow), compareSupplierFeedRows);
+    long unknown;
+    long applied = applySupplierFeed(tree, rows, count, &unknown);
+
+    double elapsed = nowSeconds() - start;
+    printf("Imported %ld supplier rows from %s in %.3f s, %.0f rows/sec; %ld for unknown medications, %ld malformed lines.\n",
+           applied, filename, elapsed, elapsed > 0 ? count / elapsed : 0.0, unknown, malformed);
+
+    free(rows);
+    free(text);
+    return malformed == 0;
+}
+
+void salesTracking(MedicationBPlusTree* pharmacy){
+    if (!pharmacy || !pharmacy->root) {
+        printf("The medication B+ tree is empty.\n");
+        return;
+    }
+
+    printf("\nEnter the id of the medication to track sales: ");
+    unsigned long id;
+    scanf("%lu", &id);
+
+    MedicationData *medication = findMedication(pharmacy, id);
+    if (!medication) {
+        printf("Medication ID %lu not found.\n", id);
+        return;
+    }
+
+    int sales;
+    printf("\nEnter the number of sales for %s: ", medication->Medicine_Name);
+    scanf("%d", &sales);
+    if (sellMedication(pharmacy, id, sales)) {
+        printf("====Sales updated successfully===\n");
+    } else {
+        printf("\nNot enough stock available for this medication.");
+    }
+}
+
+static void printMatchedMedication(MedicationData *medication, void *context) {
+    (void)context;
+    printMedicationDetails(medication);
+}
+
+void searchPharmacyUsingName(MedicationBPlusTree* pharmacy) {
+    if (!pharmacy || !pharmacy->root) {
+        printf("The medication B+ tree is empty.\n");
+        return;
+    }
+    char name[NAME_SIZE];
+    printf("Enter the name of the medication to search: \n");
+    scanf("%99s", name);
+
+    int matchChoice;
+    printf("Match 1.Exact 2.Ignoring case 3.Prefix: \n");
+    scanf("%d", &matchChoice);
+    NameMatch match = (matchChoice == 2) ? NAME_MATCH_IGNORE_CASE
+                    : (matchChoice == 3) ? NAME_MATCH_PREFIX : NAME_MATCH_EXACT;
+
+    printf("\nSearching for medication with name: %s\n", name);
+
+    if (findMedicationsByName(pharmacy, name, match, printMatchedMedication, NULL) == 0) {
+        printf("No medication found with the name: %s\n", name);
+    }
+}
+
+void searchMedicationsUsingSupplier(MedicationBPlusTree* pharmacy, unsigned long supplierID) {
+    if (!pharmacy || !pharmacy->root) {
+        printf("The medication B+ tree is empty.\n");
+        return;
+    }
+
+    printf("\nSearching for medications supplied by Supplier ID %lu...\n", supplierID);
+
+    findMedicationsBySupplier(pharmacy, supplierID, printMatchedMedication, NULL);
+}
+
+void printUniqueSupplierBPlusTree(UniqueSupplierBPlusTree* tree) {
+    if (!tree || !tree->root) {
+        printf("The unique supplier B+ tree is empty.\n");
+        return;
+    }
 
-        // Try to borrow from right sibling
-        if (childIndex < parent->cursize) {
-            SupplierNode *rightSibling = parent->children[childIndex + 1];
-            
-            if (rightSibling->isLeaf) {
-                SupplierLeafNode *rightLeaf = &(rightSibling->leaf);
-                
-                if (rightLeaf->cursize > minKeys) {
-                    // Borrow from right sibling
-                    leaf->keys[leaf->cursize] = rightLeaf->keys[0];
-                    leaf->values[leaf->cursize] = rightLeaf->values[0];
-                    leaf->cursize++;
-                    
-                    for (int i = 0; i < rightLeaf->cursize - 1; i++) {
-                        rightLeaf->keys[i] = rightLeaf->keys[i + 1];
-                        rightLeaf->values[i] = rightLeaf->values[i + 1];
-                    }
-                    rightLeaf->cursize--;
-                    
-                    parent->keys[childIndex] = rightLeaf->keys[0];
-                    return true;
-                }
-            }
+    UniqueSupplierLeafNode* current = tree->leftmost_leaf;
+
+    printf("\n======================================================\n");
+    printf("           UNIQUE SUPPLIER B+ TREE (Order: %d)        \n", tree->order);
+    printf("======================================================\n");
+
+    while (current != NULL) {
+        for (int i = 0; i < current->cursize; i++) {
+            printf("Supplier ID: %lu\n   -> Name: %s\n   ->Turnover: %lu\n   ->Number of Unique Medicines: %d\n",
+                current->keys[i],
+                current->values[i].Supplier_Name,
+                current->values[i].turnoverProduced,
+                current->values[i].noOfUniqueMedicines);
         }
+        current = current->next;
+    }
 
-        // Merge with a sibling
-        if (childIndex > 0) {
-            SupplierNode *leftSibling = parent->children[childIndex - 1];
-            
-            if (leftSibling->isLeaf) {
-                SupplierLeafNode *leftLeaf = &(leftSibling->leaf);
-                
-                for (int i = 0; i < leaf->cursize; i++) {
-                    leftLeaf->keys[leftLeaf->cursize + i] = leaf->keys[i];
-                    leftLeaf->values[leftLeaf->cursize + i] = leaf->values[i];
-                }
-                leftLeaf->cursize += leaf->cursize;
-                leftLeaf->next = leaf->next;
-                
-                free(leaf->keys);
-                free(leaf->values);
-                free(current);
-                
-                for (int i = childIndex - 1; i < parent->cursize - 1; i++) {
-                    parent->keys[i] = parent->keys[i + 1];
-                    parent->children[i + 1] = parent->children[i + 2];
-                }
-                parent->cursize--;
-                return true;
+    printf("======================================================\n");
+}   
+
+//==============================================================================
+// Batch mode (--batch FILE): commands are read one per line from a file or
+// stdin instead of the menu, and answered with tab-separated lines for scripts.
+// Each command produces zero or more result rows followed by a status line,
+// "ok <line> <count>" or "err <line> <message>". Responses are assembled in a
+// buffer and written out in large blocks, after the WAL records behind them are
+// durable.
+
+#define BATCH_MAX_TOKENS 256
+#define BATCH_OUTPUT_FLUSH_BYTES (64 * 1024)
+#define BATCH_DEFAULT_ORDER 64
+
+typedef struct BatchOutput {
+    FILE *file;                                // Where flushes go; NULL leaves the bytes to the caller
+    char *data;
+    size_t length;
+    size_t capacity;
+} BatchOutput;
+
+typedef struct BatchSession {
+    MedicationBPlusTree *tree;
+    const char *snapshotPath;                  // Rewritten by "save", as with menu option 15
+    bool remote;                               // Commands come from socket clients, so "save" may not name a file
+    BatchOutput out;
+    long commands;
+    long errors;
+} BatchSession;
+
+static void batchOutputReserve(BatchOutput *out, size_t bytes) {
+    if (out->length + bytes <= out->capacity) return;
+    size_t capacity = out->capacity ? out->capacity : 4096;
+    while (capacity < out->length + bytes) capacity *= 2;
+    out->data = (char*)realloc(out->data, capacity);
+    out->capacity = capacity;
+}
+
+static void batchOutputBytes(BatchOutput *out, const char *text, size_t length) {
+    batchOutputReserve(out, length);
+    memcpy(out->data + out->length, text, length);
+    out->length += length;
+}
+
+// Starts a row with its tag; fields follow, each preceded by a tab.
+static void batchOutputTag(BatchOutput *out, const char *tag) {
+    batchOutputBytes(out, tag, strlen(tag));
+}
+
+static void batchOutputText(BatchOutput *out, const char *text) {
+    batchOutputBytes(out, "\t", 1);
+    batchOutputBytes(out, text, strlen(text));
+}
+
+static void batchOutputNumber(BatchOutput *out, long value) {
+    char digits[24];
+    int n = sizeof(digits);
+    unsigned long magnitude = (value < 0) ? 0UL - (unsigned long)value : (unsigned long)value;
+    do {
+        digits[--n] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+    if (value < 0) digits[--n] = '-';
+    digits[--n] = '\t';
+    batchOutputBytes(out, digits + n, sizeof(digits) - n);
+}
+
+static void batchOutputUnsigned(BatchOutput *out, unsigned long value) {
+    char digits[24];
+    int n = sizeof(digits);
+    do {
+        digits[--n] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+    digits[--n] = '\t';
+    batchOutputBytes(out, digits + n, sizeof(digits) - n);
+}
+
+// Dates are written as YYYY-MM-DD.
+static void batchOutputDate(BatchOutput *out, int day, int month, int year) {
+    char date[12] = { '\t',
+                      (char)('0' + year / 1000 % 10), (char)('0' + year / 100 % 10), (char)('0' + year / 10 % 10), (char)('0' + year % 10), '-',
+                      (char)('0' + month / 10 % 10), (char)('0' + month % 10), '-',
+                      (char)('0' + day / 10 % 10), (char)('0' + day % 10) };
+    batchOutputBytes(out, date, 11);
+}
+
+static void batchOutputEnd(BatchOutput *out) {
+    batchOutputBytes(out, "\n", 1);
+}
+
+// Writes out everything buffered. Responses may report changes, so the WAL is
+// synced first; in group mode that makes one fdatasync cover a whole block.
+// Without a file the bytes stay buffered for the caller to send.
+void batchOutputFlush(BatchOutput *out) {
+    walFlush(activeWal);
+    if (!out->file) return;
+    if (out->length > 0) {
+        fwrite(out->data, 1, out->length, out->file);
+        fflush(out->file);
+    }
+    out->length = 0;
+}
+
+// med ID NAME STOCK PRICE REORDER BATCH EXPIRY SALES
+static void batchOutputMedication(BatchOutput *out, const MedicationData *medication) {
+    const ExpiryDate *date = &medication->Batch_details.Expiration_Date;
+    batchOutputTag(out, "med");
+    batchOutputUnsigned(out, medication->Medication_ID);
+    batchOutputText(out, medication->Medicine_Name);
+    batchOutputUnsigned(out, medication->Quantity_in_stock);
+    batchOutputUnsigned(out, medication->Price_per_Unit);
+    batchOutputNumber(out, medication->Reorderlevel);
+    batchOutputText(out, medication->Batch_details.Batch);
+    batchOutputDate(out, date->day, date->month, date->year);
+    batchOutputNumber(out, medication->Batch_details.Total_sales);
+    batchOutputEnd(out);
+}
+
+static void batchVisitMedication(MedicationData *medication, void *context) {
+    batchOutputMedication((BatchOutput*)context, medication);
+}
+
+// Splits line in place at blanks; a '#' starts a comment. A token in double
+// quotes may hold blanks and '#', with \" and \\ for a quote and a backslash.
+// Returns the token count, -1 if there are more than max, or -2 if a quote is
+// not closed.
+static int splitBatchTokens(char *line, char **tokens, int max) {
+    int count = 0;
+    char *p = line;
+    while (*p) {
+        while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') p++;
+        if (*p == '\0' || *p == '#') break;
+        if (count == max) return -1;
+        if (*p == '"') {
+            char *out = ++p;
+            tokens[count++] = out;
+            while (*p && *p != '"') {
+                if (*p == '\\' && (p[1] == '"' || p[1] == '\\')) p++;
+                *out++ = *p++;
             }
+            if (*p != '"') return -2;
+            p++;
+            *out = '\0';
+            continue;
         }
+        tokens[count++] = p;
+        while (*p && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') p++;
+        if (*p) *p++ = '\0';
     }
+    return count;
+}
+
+// Joins tokens[first] up to tokens[count - 1] into tokens[first], one space
+// apart, so a trailing NAME may be written without quotes. The tokens lie in
+// order in one line, so each only moves towards the start.
+static const char* joinBatchTokens(char **tokens, int first, int count) {
+    char *out = tokens[first] + strlen(tokens[first]);
+    for (int i = first + 1; i < count; i++) {
+        size_t length = strlen(tokens[i]);
+        *out++ = ' ';
+        memmove(out, tokens[i], length);
+        out += length;
+    }
+    *out = '\0';
+    return tokens[first];
+}
+
+static bool parseBatchNumber(const char *text, long min, long max, long *value) {
+    char *end;
+    errno = 0;
+    long parsed = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || parsed < min || parsed > max) return false;
+    *value = parsed;
     return true;
 }
 
-bool searchSupplier(SupplierBPlusTree *Btree, unsigned long supplierID) {
-    if (!Btree || !Btree->root) {
-        return false; // Tree is empty
+static bool parseBatchID(const char *text, unsigned long *id) {
+    char *end;
+    errno = 0;
+    if (*text == '-') return false;
+    unsigned long parsed = strtoul(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE) return false;
+    *id = parsed;
+    return true;
+}
+
+static bool parseBatchDate(char **tokens, int *day, int *month, int *year) {
+    long d, m, y;
+    if (!parseBatchNumber(tokens[2], 1, 9999, &y) || !parseBatchNumber(tokens[1], 1, 12, &m)) return false;
+    if (!parseBatchNumber(tokens[0], 1, daysInMonth((int)m, (int)y), &d)) return false;
+    *day = (int)d;
+    *month = (int)m;
+    *year = (int)y;
+    return true;
+}
+
+static bool copyBatchName(char *target, size_t size, const char *text) {
+    if (strlen(text) >= size) return false;
+    strcpy(target, text);
+    return true;
+}
+
+// add ID NAME STOCK PRICE REORDER BATCH DD MM YYYY
+static const char* batchAdd(BatchSession *session, char **tokens, int count, long *rows) {
+    if (count != 10) return "usage: add ID NAME STOCK PRICE REORDER BATCH DD MM YYYY";
+
+    MedicationData data;
+    memset(&data, 0, sizeof(data));
+    long stock, price, reorder;
+    int day, month, year;
+    if (!parseBatchID(tokens[1], &data.Medication_ID)) return "bad medication ID";
+    if (!copyBatchName(data.Medicine_Name, NAME_SIZE, tokens[2])) return "name too long";
+    if (!parseBatchNumber(tokens[3], 0, UINT_MAX, &stock)) return "bad stock";
+    if (!parseBatchNumber(tokens[4], 0, UINT_MAX, &price)) return "bad price";
+    if (!parseBatchNumber(tokens[5], INT_MIN, INT_MAX, &reorder)) return "bad reorder level";
+    if (!copyBatchName(data.Batch_details.Batch, BATCH_SIZE, tokens[6])) return "batch too long";
+    if (!parseBatchDate(tokens + 7, &day, &month, &year)) return "bad expiry date";
+    if (findMedication(session->tree, data.Medication_ID)) return "medication ID exists";
+
+    data.Quantity_in_stock = (unsigned int)stock;
+    data.Price_per_Unit = (unsigned int)price;
+    data.Reorderlevel = (int)reorder;
+    setExpiryDate(&data.Batch_details.Expiration_Date, day, month, year);
+    data.Suppliers = createSupplierBPlusTree(session->tree);
+
+    insertIntoExpirationTree(expirationTree, medicationExpirationKey(&data), data.Medication_ID, data.Medicine_Name);
+    insertMedication(session->tree, data);
+    batchOutputMedication(&session->out, findMedication(session->tree, data.Medication_ID));
+    *rows = 1;
+    return NULL;
+}
+
+// update ID price|stock|reorder|batch VALUE, update ID name NAME, or update ID
+// expiry DD MM YYYY
+static const char* batchUpdate(BatchSession *session, char **tokens, int count, long *rows) {
+    const char *usage = "usage: update ID price|stock|reorder|name|batch VALUE, or update ID expiry DD MM YYYY";
+    if (count < 4) return usage;
+
+    unsigned long id;
+    if (!parseBatchID(tokens[1], &id)) return "bad medication ID";
+    MedicationData *record = findMedication(session->tree, id);
+    if (!record) return "no such medication";
+
+    MedicationData data = *record;
+    const char *field = tokens[2];
+    long value;
+    if (strcmp(field, "expiry") == 0) {
+        int day, month, year;
+        if (count != 6) return usage;
+        if (!parseBatchDate(tokens + 3, &day, &month, &year)) return "bad expiry date";
+        setExpiryDate(&data.Batch_details.Expiration_Date, day, month, year);
+    } else if (strcmp(field, "name") == 0) {
+        if (!copyBatchName(data.Medicine_Name, NAME_SIZE, joinBatchTokens(tokens, 3, count))) return "name too long";
+    } else if (count != 4) {
+        return usage;
+    } else if (strcmp(field, "price") == 0) {
+        if (!parseBatchNumber(tokens[3], 0, UINT_MAX, &value)) return "bad price";
+        data.Price_per_Unit = (unsigned int)value;
+    } else if (strcmp(field, "stock") == 0) {
+        if (!parseBatchNumber(tokens[3], 0, UINT_MAX, &value)) return "bad stock";
+        data.Quantity_in_stock = (unsigned int)value;
+    } else if (strcmp(field, "reorder") == 0) {
+        if (!parseBatchNumber(tokens[3], INT_MIN, INT_MAX, &value)) return "bad reorder level";
+        data.Reorderlevel = (int)value;
+    } else if (strcmp(field, "batch") == 0) {
+        if (!copyBatchName(data.Batch_details.Batch, BATCH_SIZE, tokens[3])) return "batch too long";
+    } else {
+        return usage;
     }
 
-    SupplierNode *current = Btree->root;
+    // The indexes follow the record through replaceMedicationRecord
+    replaceMedicationRecord(session->tree, record, &data);
+    walLogMedication(WAL_UPDATE_MEDICATION, record);
+    batchOutputMedication(&session->out, record);
+    *rows = 1;
+    return NULL;
+}
 
-    // Traverse to the leaf node where the supplier ID might be stored
-    while (!current->isLeaf) {
-        SupplierInternalNode *internal = &(current->internal);
-        int i;
-        for (i = 0; i < internal->cursize; i++) {
-            if (supplierID < internal->keys[i]) {  
-                break;
+// delete ID
+static const char* batchDelete(BatchSession *session, char **tokens, int count, long *rows) {
+    unsigned long id;
+    if (count != 2) return "usage: delete ID";
+    if (!parseBatchID(tokens[1], &id)) return "bad medication ID";
+    if (!deleteMedicationByID(session->tree, id)) return "no such medication";
+    *rows = 0;
+    return NULL;
+}
+
+// sell ID QTY [ID QTY ...], sold as one basket
+static const char* batchSell(BatchSession *session, char **tokens, int count, long *rows) {
+    static char message[64];
+    SaleItem items[BATCH_MAX_TOKENS / 2];
+    if (count < 3 || count % 2 == 0) return "usage: sell ID QTY [ID QTY ...]";
+
+    int itemCount = (count - 1) / 2;
+    for (int i = 0; i < itemCount; i++) {
+        long quantity;
+        if (!parseBatchID(tokens[1 + 2 * i], &items[i].id)) return "bad medication ID";
+        if (!parseBatchNumber(tokens[2 + 2 * i], 0, INT_MAX, &quantity)) return "bad quantity";
+        items[i].quantity = (int)quantity;
+    }
+
+    int failed = 0;
+    if (!sellBasket(session->tree, items, itemCount, &failed)) {
+        snprintf(message, sizeof(message), "cannot sell item %d (ID %lu)", failed + 1, items[failed].id);
+        return message;
+    }
+    *rows = 0;
+    return NULL;
+}
+
+// supplier MEDICATION_ID SUPPLIER_ID NAME QUANTITY CONTACT, as one supplier feed row
+static const char* batchSupplier(BatchSession *session, char **tokens, int count, long *rows) {
+    if (count != 6) return "usage: supplier MEDICATION_ID SUPPLIER_ID NAME QUANTITY CONTACT";
+
+    SupplierFeedRow row;
+    memset(&row, 0, sizeof(row));
+    long quantity;
+    if (!parseBatchID(tokens[1], &row.medicationID)) return "bad medication ID";
+    if (!parseBatchID(tokens[2], &row.supplier.Supplier_ID)) return "bad supplier ID";
+    if (!copyBatchName(row.supplier.Supplier_Name, NAME_SIZE, tokens[3])) return "name too long";
+    if (!parseBatchNumber(tokens[4], 0, UINT_MAX, &quantity)) return "bad quantity";
+    if (!copyBatchName(row.supplier.Contact, CONTACT_SIZE, tokens[5])) return "contact too long";
+    row.supplier.Quantity_of_stock_bysupplier = (unsigned int)quantity;
+
+    long unknown;
+    if (applySupplierFeed(session->tree, &row, 1, &unknown) == 0) return "no such medication";
+    batchOutputMedication(&session->out, findMedication(session->tree, row.medicationID));
+    *rows = 1;
+    return NULL;
+}
+
+// search id ID | name NAME | iname NAME | prefix PREFIX | supplier SUPPLIER_ID,
+// where NAME and PREFIX run to the end of the line
+static const char* batchSearch(BatchSession *session, char **tokens, int count, long *rows) {
+    const char *usage = "usage: search id|name|iname|prefix|supplier VALUE";
+    if (count < 3) return usage;
+
+    const char *by = tokens[1];
+    unsigned long id;
+    bool byName = strcmp(by, "name") == 0 || strcmp(by, "iname") == 0 || strcmp(by, "prefix") == 0;
+    if (count != 3 && !byName) return usage;
+    if (strcmp(by, "id") == 0) {
+        if (!parseBatchID(tokens[2], &id)) return "bad medication ID";
+        // Answered from a mapped snapshot without building the trees
+        const MedicationData *medication = activeSnapshot ? findSnapshotMedication(activeSnapshot, id)
+                                                          : findMedication(session->tree, id);
+        if (medication) batchOutputMedication(&session->out, medication);
+        *rows = (medication != NULL);
+    } else if (strcmp(by, "supplier") == 0) {
+        if (!parseBatchID(tokens[2], &id)) return "bad supplier ID";
+        *rows = findMedicationsBySupplier(session->tree, id, batchVisitMedication, &session->out);
+    } else {
+        NameMatch match;
+        if (strcmp(by, "name") == 0) match = NAME_MATCH_EXACT;
+        else if (strcmp(by, "iname") == 0) match = NAME_MATCH_IGNORE_CASE;
+        else if (strcmp(by, "prefix") == 0) match = NAME_MATCH_PREFIX;
+        else return usage;
+        *rows = findMedicationsByName(session->tree, joinBatchTokens(tokens, 2, count), match, batchVisitMedication, &session->out);
+    }
+    return NULL;
+}
+
+// alerts stock [LIMIT] | alerts expiry DD MM YYYY [DAYS]
+static const char* batchAlerts(BatchSession *session, char **tokens, int count, long *rows) {
+    const char *usage = "usage: alerts stock [LIMIT], or alerts expiry DD MM YYYY [DAYS]";
+    if ((count == 2 || count == 3) && strcmp(tokens[1], "stock") == 0) {
+        const LowStockSet *lowStock = &session->tree->lowStock;
+        long limit = lowStock->count;
+        if (count == 3 && !parseBatchNumber(tokens[2], 0, INT_MAX, &limit)) return "bad limit";
+        if (limit > lowStock->count) limit = lowStock->count;
+        for (int i = 0; i < limit; i++) batchOutputMedication(&session->out, lowStock->records[i]);
+        *rows = limit;
+        return NULL;
+    }
+    if (count < 5 || count > 6 || strcmp(tokens[1], "expiry") != 0) return usage;
+
+    int day, month, year;
+    long withinDays = EXPIRY_ALERT_DAYS;
+    if (!parseBatchDate(tokens + 2, &day, &month, &year)) return "bad date";
+    if (count == 6 && !parseBatchNumber(tokens[5], 0, INT_MAX, &withinDays)) return "bad day count";
+
+    // expiry ID NAME EXPIRY DAYS_LEFT, in date order as checkExpirationDates lists them
+    int today = daysFromCivil(day, month, year);
+    long found = 0;
+    for (ExpirationLeafNode *leaf = expirationTree ? expirationTree->leftmost_leaf : NULL; leaf; leaf = leaf->next) {
+        for (int i = 0; i < leaf->cursize; i++) {
+            int left = expirationKeyDay(leaf->keys[i]) - today;
+            if (left > withinDays) {
+                *rows = found;
+                return NULL;
             }
+            int date = expirationKeyDate(leaf->keys[i]);
+            batchOutputTag(&session->out, "expiry");
+            batchOutputUnsigned(&session->out, leaf->values[i].medicationID);
+            batchOutputText(&session->out, leaf->values[i].medicineName);
+            batchOutputDate(&session->out, date % 100, date / 100 % 100, date / 10000);
+            batchOutputNumber(&session->out, left);
+            batchOutputEnd(&session->out);
+            found++;
         }
-        current = internal->children[i];
     }
+    *rows = found;
+    return NULL;
+}
 
-    // We are now at the leaf node
-    SupplierLeafNode *leaf = &(current->leaf);
+static void batchVisitSupplier(const UniqueSupplierData *supplier, void *context) {
+    BatchOutput *out = (BatchOutput*)context;
+    batchOutputTag(out, "supplier");
+    batchOutputUnsigned(out, supplier->Supplier_ID);
+    batchOutputText(out, supplier->Supplier_Name);
+    batchOutputUnsigned(out, supplier->noOfUniqueMedicines);
+    batchOutputUnsigned(out, supplier->turnoverProduced);
+    batchOutputEnd(out);
+}
+
+// topk turnover|medicines K
+static const char* batchTopK(BatchSession *session, char **tokens, int count, long *rows) {
+    long k;
+    if (count != 3 || (strcmp(tokens[1], "turnover") != 0 && strcmp(tokens[1], "medicines") != 0)) {
+        return "usage: topk turnover|medicines K";
+    }
+    if (!parseBatchNumber(tokens[2], 0, INT_MAX, &k)) return "bad K";
+    bool sortByTurnover = strcmp(tokens[1], "turnover") == 0;
 
-    // Search for the supplierID in the leaf node
-    for (int i = 0; i < leaf->cursize; i++) {
-        if (leaf->keys[i] == supplierID) {  // Corrected comparison
-            return true; // Supplier found
+    // supplier ID NAME MEDICINES TURNOVER, largest first
+    *rows = uniqueSupplierTree ? topUniqueSuppliers(uniqueSupplierTree, sortByTurnover, (int)k, batchVisitSupplier, &session->out) : 0;
+    return NULL;
+}
+
+typedef struct BatchListRun {
+    BatchOutput out;                           // This run's rows, appended to the session's in key order
+    long rows;
+} BatchListRun;
+
+static void batchListRun(MedicationLeafNode *first, MedicationLeafNode *end, void *partial, void *context) {
+    BatchListRun *run = (BatchListRun*)partial;
+    long maxStock = *(const long*)context;
+    for (MedicationLeafNode *leaf = first; leaf != end; leaf = leaf->next) {
+        for (int i = 0; i < leaf->cursize; i++) {
+            if (maxStock >= 0 && leaf->values[i]->Quantity_in_stock > (unsigned long)maxStock) continue;
+            batchOutputMedication(&run->out, leaf->values[i]);
+            run->rows++;
         }
     }
+}
 
-    return false; // Supplier not found
+// list [MAXSTOCK]: every medication in ID order, or those with at most MAXSTOCK in stock.
+// Runs of the leaf chain are formatted in parallel.
+static const char* batchList(BatchSession *session, char **tokens, int count, long *rows) {
+    long maxStock = -1;
+    if (count > 2) return "usage: list [MAXSTOCK]";
+    if (count == 2 && !parseBatchNumber(tokens[1], 0, UINT_MAX, &maxStock)) return "bad stock";
+
+    void *partials;
+    int runs = scanMedicationsParallel(session->tree, batchListRun, &maxStock, sizeof(BatchListRun), &partials);
+    if (runs < 0) return "out of memory";
+    for (int i = 0; i < runs; i++) {
+        BatchListRun *run = (BatchListRun*)partials + i;
+        if (run->rows > 0) batchOutputBytes(&session->out, run->out.data, run->out.length);
+        *rows += run->rows;
+        free(run->out.data);
+    }
+    free(partials);
+    return NULL;
 }
 
-void updateDetails(MedicationData *medication) {
-    printf("Enter the details you want to update:\n");
-    printf("1. Update Price\n2. Update Stock\n3. Update Supplier Information\n");
-    int ch;
-    scanf("%d", &ch);
+// report DD MM YYYY
+static const char* batchReport(BatchSession *session, char **tokens, int count, long *rows) {
+    int day, month, year;
+    if (count != 4) return "usage: report DD MM YYYY";
+    if (!parseBatchDate(tokens + 1, &day, &month, &year)) return "bad date";
+
+    // report MEDICATIONS STOCK STOCK_VALUE SOLD REVENUE LOW_STOCK OUT_OF_STOCK EXPIRED
+    CatalogSummary summary;
+    if (!summarizeMedications(session->tree, daysFromCivil(day, month, year), &summary)) return "out of memory";
+    batchOutputTag(&session->out, "report");
+    batchOutputNumber(&session->out, summary.medications);
+    batchOutputUnsigned(&session->out, summary.stockUnits);
+    batchOutputUnsigned(&session->out, summary.stockValue);
+    batchOutputNumber(&session->out, summary.unitsSold);
+    batchOutputNumber(&session->out, summary.revenue);
+    batchOutputNumber(&session->out, summary.lowStock);
+    batchOutputNumber(&session->out, summary.outOfStock);
+    batchOutputNumber(&session->out, summary.expired);
+    batchOutputEnd(&session->out);
+    *rows = 1;
+    return NULL;
+}
 
-    switch (ch) {
-        case 1: {
-            printf("Enter the new price: \n");
-            scanf("%u", &medication->Price_per_Unit);
-            printf("Price updated successfully.\n");
-            break;
-        }
-        case 2: {
-            printf("Enter the new stock: \n");
-            scanf("%u", &medication->Quantity_in_stock);
-            printf("Stock updated successfully.\n");
-            break;
-        }
-        case 3: {
-            printf("Enter the details you want to update for suppliers:\n");
-            printf("1. Add New Supplier\n2. Update Supplier Details\n3. Delete Supplier\n4. Search Supplier\n5. Print All Suppliers\n");
-            int ch1;
-            scanf("%d", &ch1);
-            unsigned long id;
+// save [FILE], then checkpoint or snapshot as menu option 15 does
+static const char* batchSave(BatchSession *session, char **tokens, int count, long *rows) {
+    if (count > 2) return "usage: save [FILE]";
+    if (count == 2 && session->remote) return "save FILE is not allowed over the server";
+    SaveDataToFile(count == 2 ? tokens[1] : "updated_medication.txt", session->tree);
+    if (activeWal) {
+        walCheckpoint(activeWal);
+    } else if (session->snapshotPath && !saveSnapshot(session->snapshotPath, session->tree, 0)) {
+        return "snapshot not written";
+    }
+    *rows = 0;
+    return NULL;
+}
 
-            switch (ch1) {
-                case 1: {
-                    SupplierData suppl = initSupplier(medication->Suppliers, medication);
-                    insertSupplier(medication->Suppliers, suppl);
-                    printf("New supplier added successfully.\n");
-                    break;
-                }
-                case 2: {
-                    printf("Enter the Supplier ID to update: \n");
-                    scanf("%lu", &id);
-                    SupplierNode* leaf2 = findSupplierLeafNode(medication->Suppliers, id);
-                    SupplierLeafNode* leaf = &(leaf2->leaf);
-                    if (leaf) {
-                        for (int i = 0; i < leaf->cursize; i++) {
-                            if (leaf->keys[i] == id) {
-                                printf("Enter details to update:\n");
-                                printf("1. Update Supplier Name\n2. Update Quantity\n3. Update Contact\n");
-                                int updateChoice;
-                                scanf("%d", &updateChoice);
-                                switch (updateChoice) {
-                                    case 1:
-                                        printf("Enter new Supplier Name: ");
-                                        scanf("%s", leaf->values[i].Supplier_Name);
-                                        break;
-                                    case 2:
-                                        printf("Enter new Quantity: ");
-                                        scanf("%u", &leaf->values[i].Quantity_of_stock_bysupplier);
-                                        break;
-                                    case 3:
-                                        printf("Enter new Contact: ");
-                                        scanf("%s", leaf->values[i].Contact);
-                                        break;
-                                    default:
-                                        printf("Invalid choice.\n");
-                                }
-                                printf("Supplier details updated successfully.\n");
-                                break;
-                            }
-                        }
-                    } else {
-                        printf("Supplier ID %lu not found.\n", id);
-                    }
-                    break;
-                }
-                case 3: {
-                    if (deleteSupplier(&medication->Suppliers)) {
-                        printf("Supplier deleted successfully.\n");
-                    } else {
-                        printf("Supplier not found.\n");
-                    }
-                    break;
-                }
-                case 4: {
-                    printf("Enter the Supplier ID to search: \n");
-                    scanf("%lu", &id);
-                    if (searchSupplier(medication->Suppliers, id)) {
-                        printf("Supplier ID %lu found.\n", id);
-                        printf("Details:\n");
-                        SupplierNode* leaf2 = findSupplierLeafNode(medication->Suppliers, id);
-                        SupplierLeafNode* leaf = &(leaf2->leaf);
-                        for (int i = 0; i < leaf->cursize; i++) {
-                            if (leaf->keys[i] == id) {
-                                printSupplier(&leaf->values[i]);
-                                break;
-                            }
-                        }
-                    } else {
-                        printf("Supplier ID %lu not found.\n", id);
-                    }
-                    break;
-                }
-                case 5: {
-                    printAllSuppliers(medication->Suppliers);
-                    break;
-                }
-                default:
-                    printf("Invalid choice.\n");
-            }
-            break;
-        }
-        default:
-            printf("Invalid choice. Please try again.\n");
+// stats [reset]: "counter NAME VALUE" rows, then "latency NAME COUNT MEAN P50
+// P90 P99 P99.9 MAX" rows in nanoseconds. reset zeroes everything afterwards.
+static const char* batchStats(BatchSession *session, char **tokens, int count, long *rows) {
+    if (count > 2 || (count == 2 && strcmp(tokens[1], "reset") != 0)) return "usage: stats [reset]";
+    unsigned long counters[STAT_COUNTER_COUNT];
+    StatLatency latencies[STAT_TIMER_COUNT];
+    if (!readStats(counters, latencies)) return "statistics not compiled in";
+    for (int i = 0; i < STAT_COUNTER_COUNT; i++) {
+        batchOutputTag(&session->out, "counter");
+        batchOutputText(&session->out, statCounterNames[i]);
+        batchOutputUnsigned(&session->out, counters[i]);
+        batchOutputEnd(&session->out);
+    }
+    for (int t = 0; t < STAT_TIMER_COUNT; t++) {
+        StatLatency *latency = &latencies[t];
+        batchOutputTag(&session->out, "latency");
+        batchOutputText(&session->out, statTimerNames[t]);
+        batchOutputUnsigned(&session->out, latency->count);
+        batchOutputUnsigned(&session->out, latency->mean);
+        batchOutputUnsigned(&session->out, latency->p50);
+        batchOutputUnsigned(&session->out, latency->p90);
+        batchOutputUnsigned(&session->out, latency->p99);
+        batchOutputUnsigned(&session->out, latency->p999);
+        batchOutputUnsigned(&session->out, latency->max);
+        batchOutputEnd(&session->out);
+    }
+    if (count == 2) resetStats();
+    *rows = STAT_COUNTER_COUNT + STAT_TIMER_COUNT;
+    return NULL;
+}
+
+// Runs one command line; its rows and status line go to session->out.
+void runBatchCommand(BatchSession *session, char *line, long lineNumber) {
+    char *tokens[BATCH_MAX_TOKENS];
+    int count = splitBatchTokens(line, tokens, BATCH_MAX_TOKENS);
+    if (count == 0) return;
+
+    const char *error = NULL;
+    long rows = 0;
+    bool flush = false;
+    if (count == -1) {
+        error = "too many fields";
+    } else if (count < 0) {
+        error = "unterminated quote";
+    } else {
+        const char *command = tokens[0];
+        bool searchByID = strcmp(command, "search") == 0 && count > 1 && strcmp(tokens[1], "id") == 0;
+        if (!searchByID) materializeSnapshot(session->tree);
+
+        if (strcmp(command, "add") == 0) error = batchAdd(session, tokens, count, &rows);
+        else if (strcmp(command, "update") == 0) error = batchUpdate(session, tokens, count, &rows);
+        else if (strcmp(command, "delete") == 0) error = batchDelete(session, tokens, count, &rows);
+        else if (strcmp(command, "sell") == 0) error = batchSell(session, tokens, count, &rows);
+        else if (strcmp(command, "supplier") == 0) error = batchSupplier(session, tokens, count, &rows);
+        else if (strcmp(command, "search") == 0) error = batchSearch(session, tokens, count, &rows);
+        else if (strcmp(command, "alerts") == 0) error = batchAlerts(session, tokens, count, &rows);
+        else if (strcmp(command, "topk") == 0) error = batchTopK(session, tokens, count, &rows);
+        else if (strcmp(command, "list") == 0) error = batchList(session, tokens, count, &rows);
+        else if (strcmp(command, "report") == 0) error = batchReport(session, tokens, count, &rows);
+        else if (strcmp(command, "save") == 0) error = batchSave(session, tokens, count, &rows);
+        else if (strcmp(command, "stats") == 0) error = batchStats(session, tokens, count, &rows);
+        else if (strcmp(command, "flush") == 0) flush = true;
+        else error = "unknown command";
+    }
+
+    session->commands++;
+    if (error) {
+        session->errors++;
+        batchOutputTag(&session->out, "err");
+        batchOutputNumber(&session->out, lineNumber);
+        batchOutputText(&session->out, error);
+    } else {
+        batchOutputTag(&session->out, "ok");
+        batchOutputNumber(&session->out, lineNumber);
+        batchOutputNumber(&session->out, rows);
+    }
+    batchOutputEnd(&session->out);
+
+    // "flush" answers at once, e.g. for a script waiting on its reply
+    if (flush || session->out.length >= BATCH_OUTPUT_FLUSH_BYTES) {
+        batchOutputFlush(&session->out);
+    }
+}
+
+// Runs every command in filename ("-" for stdin), writing responses to output.
+// A summary goes to stdout, which batch mode points at stderr.
+bool runBatch(MedicationBPlusTree *tree, const char *filename, FILE *output, const char *snapshotPath) {
+    FILE *input = strcmp(filename, "-") == 0 ? stdin : fopen(filename, "r");
+    if (!input) {
+        printf("Error: unable to open batch file %s\n", filename);
+        return false;
+    }
+
+    BatchSession session;
+    memset(&session, 0, sizeof(session));
+    session.tree = tree;
+    session.snapshotPath = snapshotPath;
+    session.out.file = output;
+
+    char *line = NULL;
+    size_t lineCapacity = 0;
+    long lineNumber = 0;
+    double start = nowSeconds();
+    while (getline(&line, &lineCapacity, input) != -1) {
+        runBatchCommand(&session, line, ++lineNumber);
+    }
+    batchOutputFlush(&session.out);
+    double elapsed = nowSeconds() - start;
+
+    printf("Ran %ld batch commands in %.3f s, %.0f commands/sec; %ld failed.\n",
+           session.commands, elapsed, elapsed > 0 ? session.commands / elapsed : 0.0, session.errors);
+
+    free(line);
+    free(session.out.data);
+    if (input != stdin) fclose(input);
+    return true;
+}
+
+//==============================================================================
+// Server mode (--serve ADDRESS): keeps the trees resident and answers tills
+// over a Unix socket ("unix:PATH") or loopback TCP ("tcp:PORT"). Requests and
+// responses are frames of a 4-byte big-endian length followed by that many
+// bytes. A request holds one batch-mode command line and its response holds
+// that command's rows and status line, numbered by the request's position on
+// its connection. One epoll loop serves every connection. Responses produced
+// in one pass of the loop are sent after a single WAL sync.
+
+#define SERVER_MAX_FRAME (1 << 20)
+// Bytes buffered per connection; enough for one whole frame of the largest size
+#define SERVER_MAX_INPUT (SERVER_MAX_FRAME + 4)
+#define SERVER_MAX_EVENTS 256
+
+typedef struct ServerConnection {
+    int fd;
+    char *in;                                  // Bytes received, not yet a whole frame
+    size_t inLength;
+    size_t inCapacity;
+    char *out;                                 // Framed responses not yet sent
+    size_t outLength;
+    size_t outSent;
+    size_t outCapacity;
+    long requests;
+    bool closing;                              // Peer hung up or broke the protocol
+    bool waitingToWrite;                       // Registered for EPOLLOUT
+    bool listed;                               // In this pass's list of touched connections
+} ServerConnection;
+
+static volatile sig_atomic_t serverStopping = 0;
+
+static void stopServer(int signalNumber) {
+    (void)signalNumber;
+    serverStopping = 1;
+}
+
+// Fills in the socket address for "unix:PATH" or "tcp:PORT" (loopback only).
+static bool parseServerAddress(const char *address, struct sockaddr_storage *storage, socklen_t *length) {
+    memset(storage, 0, sizeof(*storage));
+    if (strncmp(address, "unix:", 5) == 0) {
+        struct sockaddr_un *un = (struct sockaddr_un*)storage;
+        if (strlen(address + 5) >= sizeof(un->sun_path)) return false;
+        un->sun_family = AF_UNIX;
+        strcpy(un->sun_path, address + 5);
+        *length = sizeof(struct sockaddr_un);
+        return true;
+    }
+    if (strncmp(address, "tcp:", 4) == 0) {
+        struct sockaddr_in *in = (struct sockaddr_in*)storage;
+        long port;
+        if (!parseBatchNumber(address + 4, 1, 65535, &port)) return false;
+        in->sin_family = AF_INET;
+        in->sin_port = htons((unsigned short)port);
+        in->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        *length = sizeof(struct sockaddr_in);
+        return true;
+    }
+    return false;
+}
+
+// Opens a listening or connected socket for address, or returns -1.
+static int openServerSocket(const char *address, bool listening) {
+    struct sockaddr_storage storage;
+    socklen_t length;
+    if (!parseServerAddress(address, &storage, &length)) {
+        printf("Error: bad address %s (expected unix:PATH or tcp:PORT)\n", address);
+        return -1;
+    }
+
+    int fd = socket(storage.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    int one = 1;
+    bool ok;
+    if (listening) {
+        if (storage.ss_family == AF_UNIX) unlink(((struct sockaddr_un*)&storage)->sun_path);
+        else setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        ok = bind(fd, (struct sockaddr*)&storage, length) == 0 && listen(fd, SOMAXCONN) == 0
+          && fcntl(fd, F_SETFL, O_NONBLOCK) == 0;
+    } else {
+        ok = connect(fd, (struct sockaddr*)&storage, length) == 0;
+    }
+    if (ok && storage.ss_family == AF_INET && !listening) {
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
     }
+    if (!ok) {
+        printf("Error: unable to %s %s: %s\n", listening ? "listen on" : "connect to", address, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void serverReserve(char **data, size_t *capacity, size_t needed) {
+    if (needed <= *capacity) return;
+    size_t newCapacity = *capacity ? *capacity : 4096;
+    while (newCapacity < needed) newCapacity *= 2;
+    *data = (char*)realloc(*data, newCapacity);
+    *capacity = newCapacity;
 }
 
-void ReadFileAndStoreData(const char* filename , MedicationBPlusTree *tree) {
-    
-    FILE *file = fopen(filename, "r");
-    if (!file) {
-        printf("Unable to open file %s\n", filename);
-        return;
+static void serverAppendFrame(ServerConnection *connection, const char *payload, size_t length) {
+    serverReserve(&connection->out, &connection->outCapacity, connection->outLength + 4 + length);
+    unsigned int header = htonl((unsigned int)length);
+    memcpy(connection->out + connection->outLength, &header, 4);
+    memcpy(connection->out + connection->outLength + 4, payload, length);
+    connection->outLength += 4 + length;
+}
+
+// Reads what the socket has and runs every complete request in it.
+static void serverReadRequests(ServerConnection *connection, BatchSession *session, char **line, size_t *lineCapacity) {
+    // Stops reading at SERVER_MAX_INPUT; epoll reports the rest again once the
+    // frames below have been taken out of the buffer.
+    while (connection->inLength < SERVER_MAX_INPUT) {
+        size_t wanted = connection->inLength + 16384;
+        serverReserve(&connection->in, &connection->inCapacity, wanted < SERVER_MAX_INPUT ? wanted : SERVER_MAX_INPUT);
+        size_t room = connection->inCapacity - connection->inLength;
+        if (room > SERVER_MAX_INPUT - connection->inLength) room = SERVER_MAX_INPUT - connection->inLength;
+        ssize_t n = recv(connection->fd, connection->in + connection->inLength, room, 0);
+        if (n > 0) {
+            connection->inLength += n;
+            continue;
+        }
+        if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) connection->closing = true;
+        if (n < 0 && errno == EINTR) continue;
+        break;
     }
 
-    // printf("reading from file...\n");
-    char Buffer[256];
+    size_t consumed = 0;
+    while (connection->inLength - consumed >= 4) {
+        unsigned int header;
+        memcpy(&header, connection->in + consumed, 4);
+        size_t length = ntohl(header);
+        if (length > SERVER_MAX_FRAME) {
+            connection->closing = true;
+            break;
+        }
+        if (connection->inLength - consumed - 4 < length) break;
+
+        // The command parser works in place on a NUL-terminated copy
+        serverReserve(line, lineCapacity, length + 1);
+        memcpy(*line, connection->in + consumed + 4, length);
+        (*line)[length] = '\0';
+        consumed += 4 + length;
 
-    while (fgets(Buffer, sizeof(Buffer), file)) {
+        session->out.length = 0;
+        runBatchCommand(session, *line, ++connection->requests);
+        serverAppendFrame(connection, session->out.data, session->out.length);
+    }
+    memmove(connection->in, connection->in + consumed, connection->inLength - consumed);
+    connection->inLength -= consumed;
+}
 
-        // printf("Entered into loop");
-       
-        if (Buffer[0] == '\n' || Buffer[0] == '\r') {
+static void serverWriteResponses(ServerConnection *connection) {
+    while (connection->outSent < connection->outLength) {
+        ssize_t n = send(connection->fd, connection->out + connection->outSent,
+                         connection->outLength - connection->outSent, MSG_NOSIGNAL);
+        if (n > 0) {
+            connection->outSent += n;
+        } else if (n < 0 && errno == EINTR) {
             continue;
+        } else {
+            if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                connection->closing = true;
+                connection->outSent = connection->outLength;
+            }
+            break;
         }
+    }
+    if (connection->outSent == connection->outLength) {
+        connection->outLength = 0;
+        connection->outSent = 0;
+    }
+}
 
-        MedicationData medication;
-        unsigned long medicationID;
-        char medicineName[NAME_SIZE];
-        unsigned int quantityInStock, pricePerUnit, reorderLevel;
-        char batch[BATCH_SIZE];
-        int day, month, year, totalSales, numSuppliers;
-
-        sscanf(Buffer, "%lu", &medicationID);
-        fscanf(file, "\n");
+static void closeServerConnection(int epollFd, ServerConnection *connection) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, connection->fd, NULL);
+    close(connection->fd);
+    free(connection->in);
+    free(connection->out);
+    free(connection);
+}
 
-        fgets(medicineName, sizeof(medicineName), file);
-        medicineName[strcspn(medicineName, "\n")] = 0;  // Remove newline
+// Serves requests until SIGINT or SIGTERM.
+bool runServer(MedicationBPlusTree *tree, const char *address, const char *snapshotPath) {
+    int listenFd = openServerSocket(address, true);
+    if (listenFd < 0) return false;
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event event = { .events = EPOLLIN, .data.ptr = NULL };
+    if (epollFd < 0 || epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event) != 0) {
+        printf("Error: unable to set up epoll: %s\n", strerror(errno));
+        close(listenFd);
+        if (epollFd >= 0) close(epollFd);
+        return false;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = stopServer;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    BatchSession session;
+    memset(&session, 0, sizeof(session));
+    session.tree = tree;
+    session.snapshotPath = snapshotPath;
+    session.remote = true;
+
+    struct epoll_event events[SERVER_MAX_EVENTS];
+    ServerConnection *touched[SERVER_MAX_EVENTS];
+    char *line = NULL;
+    size_t lineCapacity = 0;
+    long connections = 0;
+    printf("Serving on %s.\n", address);
+    fflush(stdout);
+
+    while (!serverStopping) {
+        int ready = epoll_wait(epollFd, events, SERVER_MAX_EVENTS, -1);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
 
-        fscanf(file, "%u", &quantityInStock);
-        fscanf(file, "%u", &pricePerUnit);
-        fscanf(file, "%s", batch);
+        int touchedCount = 0;
+        for (int i = 0; i < ready; i++) {
+            ServerConnection *connection = (ServerConnection*)events[i].data.ptr;
+            if (!connection) {
+                int fd;
+                while ((fd = accept(listenFd, NULL, NULL)) >= 0) {
+                    int one = 1;
+                    fcntl(fd, F_SETFD, FD_CLOEXEC);
+                    fcntl(fd, F_SETFL, O_NONBLOCK);
+                    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                    ServerConnection *accepted = (ServerConnection*)calloc(1, sizeof(ServerConnection));
+                    struct epoll_event add = { .events = EPOLLIN, .data.ptr = accepted };
+                    if (!accepted || epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &add) != 0) {
+                        free(accepted);
+                        close(fd);
+                        continue;
+                    }
+                    accepted->fd = fd;
+                    connections++;
+                }
+                continue;
+            }
 
-        fscanf(file, "%d %d %d", 
-            &day,
-            &month,
-            &year
-        );
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                serverReadRequests(connection, &session, &line, &lineCapacity);
+            }
+            if (!connection->listed) {
+                connection->listed = true;
+                touched[touchedCount++] = connection;
+            }
+        }
 
-        fscanf(file, "%d", &numSuppliers);
+        // Everything answered in this pass becomes durable with one sync, then goes out
+        walFlush(activeWal);
+        for (int i = 0; i < touchedCount; i++) {
+            ServerConnection *connection = touched[i];
+            connection->listed = false;
+            serverWriteResponses(connection);
+
+            bool pending = connection->outLength > 0;
+            if (connection->closing && !pending) {
+                closeServerConnection(epollFd, connection);
+            } else if (pending != connection->waitingToWrite) {
+                struct epoll_event modify = { .events = EPOLLIN | (pending ? EPOLLOUT : 0), .data.ptr = connection };
+                epoll_ctl(epollFd, EPOLL_CTL_MOD, connection->fd, &modify);
+                connection->waitingToWrite = pending;
+            }
+        }
+    }
 
-        medication.Suppliers = createSupplierBPlusTree(tree->order);
+    printf("Server stopped after %ld requests on %ld connections; %ld failed.\n", session.commands, connections, session.errors);
+    close(epollFd);
+    close(listenFd);
+    if (strncmp(address, "unix:", 5) == 0) unlink(address + 5);
+    free(line);
+    free(session.out.data);
+    return true;
+}
 
-        for (int j = 0; j < numSuppliers; j++) {
+//==============================================================================
+// Load generator (--loadgen ADDRESS): a closed-loop client for --serve. Each
+// connection keeps one request in flight; the mix is mostly ID lookups and
+// single-item sales, with occasional stock alerts and top-supplier queries.
+
+typedef struct LoadConnection {
+    int fd;
+    char *in;
+    size_t inLength;
+    size_t inCapacity;
+    double sentAt;
+} LoadConnection;
+
+static int compareLatencies(const void *a, const void *b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
 
-            SupplierData supplier; // Allocate new supplier node
-            unsigned long supplierID;
-            char supplierName[NAME_SIZE];
-            unsigned int quantityBySupplier;
-            char contact[CONTACT_SIZE];
+static bool loadSendRequest(LoadConnection *connection, unsigned long *state, unsigned long idRange) {
+    char frame[4 + 64];
+    unsigned long pick = benchRandom(state) % 100;
+    unsigned long id = benchRandom(state) % idRange + 1;
+    int length;
+    if (pick < 74) length = snprintf(frame + 4, sizeof(frame) - 4, "search id %lu", id);
+    else if (pick < 98) length = snprintf(frame + 4, sizeof(frame) - 4, "sell %lu 1", id);
+    else if (pick < 99) length = snprintf(frame + 4, sizeof(frame) - 4, "alerts stock 20");
+    else length = snprintf(frame + 4, sizeof(frame) - 4, "topk turnover 10");
+
+    unsigned int header = htonl((unsigned int)length);
+    memcpy(frame, &header, 4);
+    connection->sentAt = nowSeconds();
+    return writeFully(connection->fd, frame, 4 + length);
+}
 
-            fscanf(file, "%lu", &supplierID);
-            fscanf(file, "%s", supplierName);
-            fscanf(file, "%u", &quantityBySupplier);
-            fscanf(file, "%s", contact);
+// Sends requests over connections sockets until requests replies are back,
+// then prints throughput and latency percentiles.
+bool runLoadGenerator(const char *address, int connectionCount, long requests, unsigned long idRange) {
+    if (connectionCount < 1 || requests < connectionCount || idRange < 1) {
+        printf("Error: need at least one connection, one request per connection and one ID\n");
+        return false;
+    }
+
+    LoadConnection *connections = (LoadConnection*)calloc(connectionCount, sizeof(LoadConnection));
+    double *latencies = (double*)malloc(sizeof(double) * requests);
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (!connections || !latencies || epollFd < 0) {
+        free(connections);
+        free(latencies);
+        return false;
+    }
+
+    unsigned long state = 0x2545f4914f6cdd1dUL;
+    long sent = 0, completed = 0, errors = 0;
+    bool ok = true;
+    double start = nowSeconds();
+    for (int i = 0; i < connectionCount && ok; i++) {
+        connections[i].fd = openServerSocket(address, false);
+        struct epoll_event add = { .events = EPOLLIN, .data.ptr = &connections[i] };
+        ok = connections[i].fd >= 0 && epoll_ctl(epollFd, EPOLL_CTL_ADD, connections[i].fd, &add) == 0
+          && loadSendRequest(&connections[i], &state, idRange);
+        sent++;
+    }
+
+    struct epoll_event events[SERVER_MAX_EVENTS];
+    while (ok && completed < requests) {
+        int ready = epoll_wait(epollFd, events, SERVER_MAX_EVENTS, 5000);
+        if (ready <= 0) {
+            if (ready < 0 && errno == EINTR) continue;
+            printf("Error: no reply from %s\n", address);
+            ok = false;
+            break;
+        }
+        for (int i = 0; i < ready && ok; i++) {
+            LoadConnection *connection = (LoadConnection*)events[i].data.ptr;
+            serverReserve(&connection->in, &connection->inCapacity, connection->inLength + 16384);
+            ssize_t n = recv(connection->fd, connection->in + connection->inLength, connection->inCapacity - connection->inLength, 0);
+            if (n <= 0) {
+                if (n < 0 && errno == EINTR) continue;
+                printf("Error: %s closed the connection\n", address);
+                ok = false;
+                break;
+            }
+            connection->inLength += n;
+
+            // One request is in flight per connection, so a whole frame is its reply
+            unsigned int header;
+            if (connection->inLength < 4) continue;
+            memcpy(&header, connection->in, 4);
+            size_t length = ntohl(header);
+            if (connection->inLength < 4 + length) continue;
+
+            latencies[completed++] = nowSeconds() - connection->sentAt;
+            // The status line comes last, after any rows
+            const char *status = connection->in + 4 + (length ? length - 1 : 0);
+            while (status > connection->in + 4 && status[-1] != '\n') status--;
+            if (strncmp(status, "err\t", 4) == 0) errors++;
+            connection->inLength = 0;
+
+            if (sent < requests) {
+                ok = loadSendRequest(connection, &state, idRange);
+                sent++;
+            }
+        }
+    }
+    double elapsed = nowSeconds() - start;
 
-            supplier.Supplier_ID = supplierID;
-            strcpy(supplier.Supplier_Name, supplierName);
-            supplier.Quantity_of_stock_bysupplier = quantityBySupplier;
-            unsigned long z = quantityBySupplier;
-            strcpy(supplier.Contact, contact);
+    if (ok) {
+        qsort(latencies, completed, sizeof(double), compareLatencies);
+        printf("%ld requests over %d connections in %.3f s: %.0f requests/sec, %ld error replies\n",
+               completed, connectionCount, elapsed, completed / elapsed, errors);
+        printf("  latency us: p50 %.0f  p90 %.0f  p99 %.0f  p99.9 %.0f  max %.0f\n",
+               latencies[completed / 2] * 1e6, latencies[completed * 9 / 10] * 1e6, latencies[completed * 99 / 100] * 1e6,
+               latencies[completed * 999 / 1000] * 1e6, latencies[completed - 1] * 1e6);
+    }
 
-            insertSupplier(medication.Suppliers, supplier);
+    for (int i = 0; i < connectionCount; i++) {
+        if (connections[i].fd > 0) close(connections[i].fd);
+        free(connections[i].in);
+    }
+    close(epollFd);
+    free(connections);
+    free(latencies);
+    return ok;
+}
 
-            // if notfound fn return true else if found return false
-            unsigned long turnov = quantityBySupplier * pricePerUnit;
+//==============================================================================
+// Benchmarks (run with --bench)
 
-            if(checkUniqueSupplier(supplierID) == false){
-                // Update the existing supplier's quantity and turnover
-                UniqueSupplierNode* leaf2 = findUniqueSupplierLeafNode(uniqueSupplierTree, supplierID);
-                UniqueSupplierLeafNode* leaf = &(leaf2->leaf);
-                if (leaf) {
-                    for (int i = 0; i < leaf->cursize; i++) {
-                        if (leaf->keys[i] == supplierID) {
-                            leaf->values[i].turnoverProduced += turnov;
-                            leaf->values[i].noOfUniqueMedicines += 1;
-                            break;
-                        }
-                    }
-                }
-            }else{
-                insertUniqueSupplier(uniqueSupplierTree,supplierID, supplierName, 1, turnov);
-            }
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
 
-            // printf("before insertion of supplier ...\n");
+static unsigned long benchRandom(unsigned long *state) {
+    // xorshift64: cheap and reproducible across runs
+    unsigned long x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
 
-        }
+// A Zipf-like rank in [0, n): log-uniform, so rank r comes up with probability
+// close to 1 / ((r + 1) ln n), Zipf's law with s = 1. An octave [2^j, 2^(j+1))
+// is picked uniformly and a point x in it kept with probability 2^j / x, so no
+// libm is needed.
+static unsigned long benchZipfRank(unsigned long *state, unsigned long n) {
+    int octaves = 0;
+    while ((1UL << octaves) < n) octaves++;
+    if (octaves == 0) return 0;
+    for (;;) {
+        unsigned long low = 1UL << (benchRandom(state) % octaves);
+        unsigned long x = low + benchRandom(state) % low;
+        if (x <= n && benchRandom(state) % x < low) return x - 1;
+    }
+}
 
-        fscanf(file, "%d", &reorderLevel);
+static int medicationTreeHeight(MedicationBPlusTree *tree) {
+    int height = 0;
+    MedicationNode *current = tree->root;
+    while (current) {
+        height++;
+        current = current->isLeaf ? NULL : current->internal.children[0];
+    }
+    return height;
+}
 
-        medication.Medication_ID = medicationID;
-        strcpy(medication.Medicine_Name, medicineName);
-        medication.Quantity_in_stock = quantityInStock;
-        medication.Price_per_Unit = pricePerUnit;
-        strcpy(medication.Batch_details.Batch, batch);
-        medication.Batch_details.Expiration_Date.day = day;
-        medication.Batch_details.Expiration_Date.month = month;
-        medication.Batch_details.Expiration_Date.year = year;
-        medication.Batch_details.Total_sales = 0;
-        medication.Reorderlevel = reorderLevel;
+// Point lookups/sec on the medication tree for orders 4..1024.
+void benchmarkLookups(int keyCount, int lookupCount) {
+    int orders[] = { 4, 8, 16, 32, 64, 128, 256, 512, 1024 };
+    int numOrders = sizeof(orders) / sizeof(orders[0]);
 
-        printf("before insertion of medicatn ...\n");
+    printf("Medication tree lookups: %d keys, %d probes (half misses)\n", keyCount, lookupCount);
+    printf("%8s %8s %16s\n", "order", "height", "lookups/sec");
 
-        insertMedication(tree, medication);   
+    for (int o = 0; o < numOrders; o++) {
+        MedicationBPlusTree *tree = createMedicationBPlusTree(orders[o]);
+        MedicationData data;
+        memset(&data, 0, sizeof(data));
 
-        printf("end of iteration...\n");
+        // Even IDs are stored so odd probes exercise the miss path
+        for (int i = 0; i < keyCount; i++) {
+            data.Medication_ID = 2UL * i;
+            insertMedication(tree, data);
+        }
 
-        int expirationKey = year * 10000 + month * 100 + day + 100000000*medicationID;
+        unsigned long state = 88172645463325252UL;
+        unsigned long found = 0;
+        double start = nowSeconds();
+        for (int i = 0; i < lookupCount; i++) {
+            unsigned long id = benchRandom(&state) % (2UL * keyCount);
+            found += findMedication(tree, id) != NULL;
+        }
+        double elapsed = nowSeconds() - start;
 
-        insertIntoExpirationTree(expirationTree, expirationKey, medicationID, medicineName);
+        printf("%8d %8d %16.0f\n", orders[o], medicationTreeHeight(tree), lookupCount / elapsed);
+        if (found == 0) printf("(no hits)\n");
 
+        destroyMedicationBPlusTree(tree);
     }
+}
 
-    fclose(file);
+typedef struct BenchmarkLookupWorker {
+    MedicationBPlusTree *tree;
+    pthread_t thread;
+    int keyCount;
+    long count;                                // Lookups to run (readers) or writes done (writer)
+    unsigned long seed;
+    unsigned long found;
+    int *stop;                                 // Set when the readers are done, for the writer
+} BenchmarkLookupWorker;
+
+static void* benchmarkLookupReader(void *arg) {
+    BenchmarkLookupWorker *worker = (BenchmarkLookupWorker*)arg;
+    unsigned long state = 88172645463325252UL + worker->seed;
+    for (long i = 0; i < worker->count; i++) {
+        worker->found += lookupMedication(worker->tree, benchRandom(&state) % (2UL * worker->keyCount), NULL);
+    }
+    return NULL;
 }
 
-void searchMedicationByID(MedicationBPlusTree *tree, unsigned long id) {
-    printf("Searching for medication with ID %lu...\n", id);
-    if (!tree || !tree->root) {
-        printf("The medication B+ tree is empty.\n");
-        return;
+// Inserts and deletes odd IDs, which the readers' probes miss or hit by turns.
+static void* benchmarkLookupWriter(void *arg) {
+    BenchmarkLookupWorker *worker = (BenchmarkLookupWorker*)arg;
+    unsigned long state = 2463534242UL;
+    MedicationData data;
+    memset(&data, 0, sizeof(data));
+    data.Quantity_in_stock = 1;
+    while (!__atomic_load_n(worker->stop, __ATOMIC_RELAXED)) {
+        unsigned long id = 2UL * (benchRandom(&state) % worker->keyCount) + 1;
+        if (!deleteMedicationByID(worker->tree, id)) {
+            data.Medication_ID = id;
+            insertMedication(worker->tree, data);
+        }
+        worker->count++;
     }
+    return NULL;
+}
 
-    // Find the leaf node where the medication ID might be stored
-    MedicationNode *leaf2 = findLeafNode(tree, id);
-    MedicationLeafNode *leaf = &(leaf2->leaf);
-    if(leaf != NULL) {
-        printf("Leaf node found for ID %lu.\n", id);
-    } else {
-        printf("Leaf node not found for ID %lu.\n", id);
-        return;
-    }
+// Aggregate lookups/sec through lookupMedication as reader threads are added,
+// alone and with one thread inserting and deleting at the same time.
+void benchmarkConcurrentLookups(int keyCount, long lookupsPerThread) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int maxThreads = cores > 4 ? (int)cores : 4;
+    if (maxThreads > 64) maxThreads = 64;
+
+    MedicationBPlusTree *tree = createMedicationBPlusTree(64);
+    MedicationData data;
+    memset(&data, 0, sizeof(data));
+    data.Quantity_in_stock = 1;
+    for (int i = 0; i < keyCount; i++) {
+        data.Medication_ID = 2UL * i;
+        insertMedication(tree, data);
+    }
+
+    printf("Concurrent lookups: %d keys, order 64, %ld probes per reader, %ld cores online\n", keyCount, lookupsPerThread, cores);
+    printf("%8s %16s %8s %20s %14s\n", "readers", "lookups/sec", "speedup", "with writer", "writes/sec");
+
+    BenchmarkLookupWorker workers[64];
+    double single = 0;
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        double rate[2] = { 0, 0 };
+        long writes = 0;
+        for (int withWriter = 0; withWriter < 2; withWriter++) {
+            int stop = 0;
+            BenchmarkLookupWorker writer = { .tree = tree, .keyCount = keyCount, .stop = &stop };
+            if (withWriter) pthread_create(&writer.thread, NULL, benchmarkLookupWriter, &writer);
+
+            double start = nowSeconds();
+            for (int t = 0; t < threads; t++) {
+                workers[t] = (BenchmarkLookupWorker){ .tree = tree, .keyCount = keyCount, .count = lookupsPerThread, .seed = t };
+                pthread_create(&workers[t].thread, NULL, benchmarkLookupReader, &workers[t]);
+            }
+            for (int t = 0; t < threads; t++) pthread_join(workers[t].thread, NULL);
+            double elapsed = nowSeconds() - start;
 
-    // Search for the ID in the leaf node
-    for (int i = 0; i < leaf->cursize; i++) {
-        if (leaf->keys[i] == id) {
-            printf("Medication found:\n");
-            printMedicationDetails(&(leaf->values[i]));
-            return;
+            if (withWriter) {
+                __atomic_store_n(&stop, 1, __ATOMIC_RELAXED);
+                pthread_join(writer.thread, NULL);
+                writes = writer.count;
+            }
+            rate[withWriter] = threads * lookupsPerThread / elapsed;
+            if (workers[0].found == 0) printf("(no hits)\n");
+            if (withWriter) writes = (long)(writes / elapsed);
         }
+        if (threads == 1) single = rate[0];
+        printf("%8d %16.0f %7.2fx %20.0f %14ld\n", threads, rate[0], rate[0] / single, rate[1], writes);
     }
 
-    // If the ID is not found in the leaf node
-    printf("Medication ID %lu not found in the tree.\n", id);
+    destroyMedicationBPlusTree(tree);
 }
 
-void printTreeStructure(MedicationNode *node, int level) {
-    if (!node) {
-        printf("Empty tree\n");
-        return;
+// Insert and delete throughput for shuffled IDs at a single order.
+void benchmarkInsertDelete(int count, int order) {
+    unsigned long *ids = (unsigned long*)malloc(sizeof(unsigned long) * count);
+    unsigned long state = 2463534242UL;
+    for (int i = 0; i < count; i++) ids[i] = i + 1;
+    for (int i = count - 1; i > 0; i--) {
+        int j = benchRandom(&state) % (i + 1);
+        unsigned long tmp = ids[i]; ids[i] = ids[j]; ids[j] = tmp;
     }
-    
-    printf("Level %d: ", level);
-    if (node->isLeaf) {
-        printf("Leaf Node Keys: ");
-        for (int i = 0; i < node->leaf.cursize; i++) {
-            printf("%lu ", node->leaf.keys[i]);
-        }
-        printf("\n");
-    } else {
-        printf("Internal Node Keys: ");
-        for (int i = 0; i < node->internal.cursize; i++) {
-            printf("%lu ", node->internal.keys[i]);
-        }
-        printf("\n");
-        
-        // Recursively print children
-        for (int i = 0; i <= node->internal.cursize; i++) {
-            printTreeStructure(node->internal.children[i], level + 1);
-        }
+
+    MedicationBPlusTree *tree = createMedicationBPlusTree(order);
+    MedicationData data;
+    memset(&data, 0, sizeof(data));
+    strcpy(data.Medicine_Name, "Benchmark");
+    data.Quantity_in_stock = 1; // Above the reorder level, so these stay out of the low-stock set
+
+    double start = nowSeconds();
+    for (int i = 0; i < count; i++) {
+        data.Medication_ID = ids[i];
+        insertMedication(tree, data);
     }
-}
+    double insertTime = nowSeconds() - start;
 
-void SaveDataToFile(const char* filename, MedicationBPlusTree* tree) {
-    if (!tree || !tree->root) {
-        printf("The medication B+ tree is empty. Nothing to save.\n");
-        return;
+    // Delete in a different random order
+    for (int i = count - 1; i > 0; i--) {
+        int j = benchRandom(&state) % (i + 1);
+        unsigned long tmp = ids[i]; ids[i] = ids[j]; ids[j] = tmp;
     }
 
-    FILE* file = fopen(filename, "w");
-    if (!file) {
-        printf("Unable to open file %s for writing.\n", filename);
-        return;
+    int deleted = 0;
+    start = nowSeconds();
+    for (int i = 0; i < count / 2; i++) {
+        deleted += deleteMedicationByID(tree, ids[i]);
     }
+    double deleteTime = nowSeconds() - start;
 
-    printf("Saving data to file: %s\n", filename);
+    printf("Medication tree order %d, %d records\n", order, count);
+    printf("  insert: %12.0f ops/sec\n", count / insertTime);
+    printf("  delete: %12.0f ops/sec (%d of %d deleted)\n", (count / 2) / deleteTime, deleted, count / 2);
 
-    // Start from the leftmost leaf
-    MedicationLeafNode* current = tree->leftmost_leaf;
+    destroyMedicationBPlusTree(tree);
+    free(ids);
+}
 
-    // Traverse all leaf nodes
-    while (current != NULL) {
-        for (int i = 0; i < current->cursize; i++) {
-            MedicationData* medication = &current->values[i];
+static void benchmarkReportShape(const char *label, MedicationBPlusTree *tree, const unsigned long *live, int liveCount) {
+    TreeShape shape = {0};
+    if (tree->root) addMedicationNodeShape(tree->root, 1, (tree->order - 1) / 2, &shape);
 
-            // Write medication details
-            fprintf(file, "%lu\n", medication->Medication_ID);
-            fprintf(file, "%s\n", medication->Medicine_Name);
-            fprintf(file, "%u\n", medication->Quantity_in_stock);
-            fprintf(file, "%u\n", medication->Price_per_Unit);
-            fprintf(file, "%s\n", medication->Batch_details.Batch);
-            fprintf(file, "%d %d %d\n", 
-                medication->Batch_details.Expiration_Date.day,
-                medication->Batch_details.Expiration_Date.month,
-                medication->Batch_details.Expiration_Date.year);
-            fprintf(file, "%d\n", medication->Reorderlevel);
+    unsigned long state = 88172645463325252UL;
+    int probes = 1000000;
+    unsigned long found = 0;
+    double start = nowSeconds();
+    for (int i = 0; i < probes && liveCount > 0; i++) {
+        found += findMedication(tree, live[benchRandom(&state) % liveCount]) != NULL;
+    }
+    double elapsed = nowSeconds() - start;
 
-            // Write supplier details
-            SupplierBPlusTree* suppliers = medication->Suppliers;
-            if (suppliers && suppliers->root) {
-                SupplierLeafNode* supplierLeaf = suppliers->leftmost_leaf;
-                int supplierCount = 0;
+    printf("  %-14s %9ld keys, height %d, %8ld leaves, fill %5.1f%%, %ld underfull, %10.0f lookups/sec%s\n",
+           label, shape.keys, shape.height, shape.leaves,
+           shape.leafSlots ? 100.0 * shape.keys / shape.leafSlots : 0.0, shape.underfull,
+           liveCount ? probes / elapsed : 0.0, found == (unsigned long)(liveCount ? probes : 0) ? "" : " (MISSES)");
+}
 
-                // Count the number of suppliers
-                while (supplierLeaf != NULL) {
-                    supplierCount += supplierLeaf->cursize;
-                    supplierLeaf = supplierLeaf->next;
-                }
+// Shape and lookup speed of a medication tree as nearly every record is
+// deleted, then over rounds that insert and delete count / 2 records each.
+void benchmarkDeleteChurn(int count, int rounds, int order) {
+    int capacity = count + rounds * (count / 2);
+    unsigned long *live = (unsigned long*)malloc(sizeof(unsigned long) * capacity);
+    unsigned long state = 2463534242UL;
+    int liveCount = count;
+    unsigned long nextId = 1;
+    for (int i = 0; i < count; i++) live[i] = nextId++;
+    for (int i = count - 1; i > 0; i--) {
+        int j = benchRandom(&state) % (i + 1);
+        unsigned long tmp = live[i]; live[i] = live[j]; live[j] = tmp;
+    }
+
+    MedicationBPlusTree *tree = createMedicationBPlusTree(order);
+    MedicationData data;
+    memset(&data, 0, sizeof(data));
+    strcpy(data.Medicine_Name, "Benchmark");
+    data.Quantity_in_stock = 1; // Above the reorder level, so these stay out of the low-stock set
+    for (int i = 0; i < count; i++) {
+        data.Medication_ID = live[i];
+        insertMedication(tree, data);
+    }
+
+    printf("Medication tree delete churn, order %d\n", order);
+    benchmarkReportShape("loaded", tree, live, liveCount);
+
+    // Delete all but 1% in random order
+    long deletes = 0;
+    double start = nowSeconds();
+    while (liveCount > count / 100) {
+        int i = benchRandom(&state) % liveCount;
+        deletes += deleteMedicationByID(tree, live[i]);
+        live[i] = live[--liveCount];
+    }
+    double deleteTime = nowSeconds() - start;
+    benchmarkReportShape("after deletes", tree, live, liveCount);
+
+    for (int r = 0; r < rounds; r++) {
+        for (int i = 0; i < count / 2; i++) {
+            data.Medication_ID = nextId;
+            insertMedication(tree, data);
+            live[liveCount++] = nextId++;
+        }
+        start = nowSeconds();
+        for (int i = 0; i < count / 2; i++) {
+            int j = benchRandom(&state) % liveCount;
+            deletes += deleteMedicationByID(tree, live[j]);
+            live[j] = live[--liveCount];
+        }
+        deleteTime += nowSeconds() - start;
+    }
+    benchmarkReportShape("after churn", tree, live, liveCount);
+    destroyMedicationBPlusTree(tree);
 
-                fprintf(file, "%d\n", supplierCount);
+    // The same records inserted into a fresh tree, for comparison
+    tree = createMedicationBPlusTree(order);
+    for (int i = 0; i < liveCount; i++) {
+        data.Medication_ID = live[i];
+        insertMedication(tree, data);
+    }
+    benchmarkReportShape("fresh tree", tree, live, liveCount);
+    printf("  %ld deletes at %.0f ops/sec\n", deletes, deletes / deleteTime);
 
-                // Write supplier details
-                supplierLeaf = suppliers->leftmost_leaf;
-                while (supplierLeaf != NULL) {
-                    for (int j = 0; j < supplierLeaf->cursize; j++) {
-                        SupplierData* supplier = &supplierLeaf->values[j];
-                        fprintf(file, "%lu\n", supplier->Supplier_ID);
-                        fprintf(file, "%s\n", supplier->Supplier_Name);
-                        fprintf(file, "%u\n", supplier->Quantity_of_stock_bysupplier);
-                        fprintf(file, "%s\n", supplier->Contact);
-                    }
-                    supplierLeaf = supplierLeaf->next;
-                }
-            } else {
-                fprintf(file, "0\n"); // No suppliers
+    destroyMedicationBPlusTree(tree);
+    free(live);
+}
+
+// Building a tree of count records one insert at a time vs bottom-up.
+void benchmarkBulkLoad(int count, int order) {
+    unsigned long *ids = (unsigned long*)malloc(sizeof(unsigned long) * count);
+    MedicationData **records = (MedicationData**)malloc(sizeof(MedicationData*) * count);
+    MedicationData data;
+    memset(&data, 0, sizeof(data));
+    strcpy(data.Medicine_Name, "Benchmark");
+
+    printf("Medication tree build, order %d, %d records, fill factor %.2f\n", order, count, bulkLoadFillFactor);
+
+    for (int shuffled = 0; shuffled <= 1; shuffled++) {
+        unsigned long state = 2463534242UL;
+        for (int i = 0; i < count; i++) ids[i] = i + 1;
+        if (shuffled) {
+            for (int i = count - 1; i > 0; i--) {
+                int j = benchRandom(&state) % (i + 1);
+                unsigned long tmp = ids[i]; ids[i] = ids[j]; ids[j] = tmp;
             }
         }
-        current = current->next; // Move to the next leaf node
+
+        MedicationBPlusTree *tree = createMedicationBPlusTree(order);
+        double start = nowSeconds();
+        for (int i = 0; i < count; i++) {
+            data.Medication_ID = ids[i];
+            insertMedication(tree, data);
+        }
+        double insertTime = nowSeconds() - start;
+        destroyMedicationBPlusTree(tree);
+
+        tree = createMedicationBPlusTree(order);
+        start = nowSeconds();
+        for (int i = 0; i < count; i++) {
+            records[i] = (MedicationData*)poolAlloc(&tree->records);
+            *records[i] = data;
+            records[i]->Medication_ID = ids[i];
+        }
+        bulkLoadMedications(tree, records, count, bulkLoadFillFactor);
+        double bulkTime = nowSeconds() - start;
+
+        printf("  %-8s input: insert %7.3fs, bulk load %7.3fs, height %d\n",
+               shuffled ? "shuffled" : "sorted", insertTime, bulkTime, medicationTreeHeight(tree));
+        destroyMedicationBPlusTree(tree);
     }
 
-    fclose(file);
-    printf("Data successfully saved to file: %s\n", filename);
+    free(records);
+    free(ids);
 }
 
-void supplierManagement(MedicationData *medication){
+// Whole-catalog summary and batch "list" over 1..N scan threads.
+void benchmarkParallelScans(int count, int order) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int maxThreads = cores > 4 ? (int)cores : 4;
+    if (maxThreads > 64) maxThreads = 64;
+
+    MedicationBPlusTree *tree = createMedicationBPlusTree(order);
+    MedicationData **records = (MedicationData**)malloc(sizeof(MedicationData*) * count);
+    unsigned long state = 2463534242UL;
+    for (int i = 0; i < count; i++) {
+        records[i] = (MedicationData*)poolAlloc(&tree->records);
+        memset(records[i], 0, sizeof(MedicationData));
+        records[i]->Medication_ID = i + 1;
+        snprintf(records[i]->Medicine_Name, NAME_SIZE, "Medicine%d", i + 1);
+        records[i]->Quantity_in_stock = benchRandom(&state) % 500;
+        records[i]->Price_per_Unit = benchRandom(&state) % 100 + 1;
+        records[i]->Reorderlevel = 20;
+        records[i]->Batch_details.Total_sales = benchRandom(&state) % 1000;
+        setExpiryDate(&records[i]->Batch_details.Expiration_Date, 1, 1 + benchRandom(&state) % 12, 2025);
+    }
+    bulkLoadMedications(tree, records, count, bulkLoadFillFactor);
+    free(records);
+
+    BatchSession session;
+    memset(&session, 0, sizeof(session));
+    session.tree = tree;
+    char list[] = "list";
+    char *tokens[] = { list };
+    int today = daysFromCivil(1, 7, 2025);
+    int savedThreads = workerThreadCount;
+
+    printf("Parallel scans: %d medications, order %d, %ld cores online\n", count, order, cores);
+    printf("%8s %18s %18s %8s\n", "threads", "summary rec/sec", "list rec/sec", "speedup");
+    double single = 0;
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        workerThreadCount = threads;
+        CatalogSummary summary;
+        double start = nowSeconds();
+        for (int r = 0; r < 5; r++) summarizeMedications(tree, today, &summary);
+        double summaryRate = 5.0 * count / (nowSeconds() - start);
+
+        long rows = 0;
+        start = nowSeconds();
+        batchList(&session, tokens, 1, &rows);
+        double listRate = count / (nowSeconds() - start);
+        session.out.length = 0;
+
+        if (threads == 1) single = summaryRate;
+        if (summary.medications != count || rows != count) printf("(count mismatch)\n");
+        printf("%8d %18.0f %18.0f %7.2fx\n", threads, summaryRate, listRate, summaryRate / single);
+    }
+    workerThreadCount = savedThreads;
+
+    free(session.out.data);
+    destroyMedicationBPlusTree(tree);
+}
 
-    printf("Supplier Management...\n");
-    unsigned long id;
-    printf("Enter the Supplier ID to update: \n");
-    scanf("%lu", &id);
-    int choice;
-    printf("1. Add Supplier\n2. Update Supplier\n3. Delete Supplier\n4. Search Supplier\n5. Print All Suppliers\n0. Exit\n");
-    scanf("%d", &choice);
+// Turnover changes, which move a supplier in the rankings, and top-10 queries.
+void benchmarkTopSuppliers(int supplierCount, int updateCount, int queryCount) {
+    UniqueSupplierBPlusTree *tree = createUniqueSupplierBPlusTree(64);
+    unsigned long state = 88172645463325252UL;
+    for (int i = 0; i < supplierCount; i++) {
+        insertUniqueSupplier(tree, i, "Benchmark", 1 + benchRandom(&state) % 50, benchRandom(&state) % 1000000);
+    }
 
-    switch (choice) {
-        case 1:
-            printf("Adding new supplier...\n");
-            SupplierData suppl = initSupplier(medication->Suppliers, medication);
-            insertSupplier(medication->Suppliers, suppl);
-            printf("\nNew supplier added successfully.\n");
-            break;
-        case 2:
-        {
-            SupplierNode *leaf2 = findSupplierLeafNode(medication->Suppliers, id);
-            SupplierLeafNode *leaf = &(leaf2->leaf);
-            if (leaf) {
-                for (int i = 0; i < leaf->cursize; i++) {
-                    if (leaf->keys[i] == id) {
-                        printf("Enter details to update:\n");
-                        printf("1. Update Supplier Name\n2. Update Quantity\n3. Update Contact\n");
-                        int updateChoice;
-                        scanf("%d", &updateChoice);
-                        switch (updateChoice) {
-                            case 1:
-                                printf("Enter new Supplier Name: ");
-                                scanf("%s", leaf->values[i].Supplier_Name);
-                                break;
-                            case 2: {
-                                unsigned int oldQuantity = leaf->values[i].Quantity_of_stock_bysupplier;
-                                printf("Enter new Quantity: ");
-                                scanf("%u", &leaf->values[i].Quantity_of_stock_bysupplier);
+    double start = nowSeconds();
+    for (int i = 0; i < updateCount; i++) {
+        UniqueSupplierData *supplier = findUniqueSupplier(tree, benchRandom(&state) % supplierCount);
+        setUniqueSupplierTotals(tree, supplier, supplier->noOfUniqueMedicines, supplier->turnoverProduced + benchRandom(&state) % 1000);
+    }
+    double updateTime = nowSeconds() - start;
 
-                                // Update the unique supplier tree
-                                updateUniqueSupplierTreeAfterInsert(
-                                    leaf->keys[i],
-                                    leaf->values[i].Supplier_Name,
-                                    leaf->values[i].Quantity_of_stock_bysupplier - oldQuantity,
-                                    (leaf->values[i].Quantity_of_stock_bysupplier - oldQuantity) * medication->Price_per_Unit
-                                );
-                                
-                                // Update the medication's stock
-                                medication->Quantity_in_stock += (leaf->values[i].Quantity_of_stock_bysupplier - oldQuantity);
-                                break;
-                            }
-                            case 3:
-                                printf("Enter new Contact: ");
-                                scanf("%s", leaf->values[i].Contact);
-                                break;
-                            default:
-                                printf("Invalid choice.\n");
-                        }
-                        printf("Supplier details updated successfully.\n");
-                        break;
-                    }
-                }
-            } else {
-                printf("Supplier ID %lu not found.\n", id);
+    long found = 0;
+    start = nowSeconds();
+    for (int i = 0; i < queryCount; i++) {
+        found += topUniqueSuppliers(tree, i % 2 == 0, 10, NULL, NULL);
+    }
+    double queryTime = nowSeconds() - start;
+
+    printf("Supplier rankings, %d suppliers\n", supplierCount);
+    printf("  turnover updates: %12.0f ops/sec\n", updateCount / updateTime);
+    printf("  top-10 queries:   %12.0f queries/sec\n", queryCount / queryTime);
+    if (found == 0) printf("(no hits)\n");
+
+    destroyUniqueSupplierBPlusTree(tree);
+}
+
+// Name lookups through the name index vs the old full leaf scan.
+void benchmarkNameLookups(int count, int lookupCount) {
+    MedicationBPlusTree *tree = createMedicationBPlusTree(64);
+    MedicationData data;
+    memset(&data, 0, sizeof(data));
+    for (int i = 0; i < count; i++) {
+        data.Medication_ID = i + 1;
+        snprintf(data.Medicine_Name, NAME_SIZE, "Medicine%d", i);
+        insertMedication(tree, data);
+    }
+
+    unsigned long state = 88172645463325252UL;
+    char name[NAME_SIZE];
+    long found = 0;
+    double start = nowSeconds();
+    for (int i = 0; i < lookupCount; i++) {
+        snprintf(name, NAME_SIZE, "medicine%lu", benchRandom(&state) % count);
+        found += findMedicationsByName(tree, name, NAME_MATCH_IGNORE_CASE, NULL, NULL);
+    }
+    double indexTime = nowSeconds() - start;
+
+    // The scan is O(n), so it gets far fewer probes
+    int scanCount = lookupCount / 1000 + 1;
+    start = nowSeconds();
+    for (int i = 0; i < scanCount; i++) {
+        snprintf(name, NAME_SIZE, "Medicine%lu", benchRandom(&state) % count);
+        for (MedicationLeafNode *leaf = tree->leftmost_leaf; leaf; leaf = leaf->next) {
+            for (int j = 0; j < leaf->cursize; j++) {
+                found += strcmp(leaf->values[j]->Medicine_Name, name) == 0;
             }
-            break;
         }
-        
-    case 3: {
-        unsigned long deleteId;
-        printf("Enter the Supplier ID to delete: ");
-        scanf("%lu", &deleteId);
-        if (deleteSupplier(&medication->Suppliers)) {
-            printf("Supplier deleted successfully.\n");
-        } else {
-            printf("Supplier not found.\n");
+    }
+    double scanTime = nowSeconds() - start;
+
+    printf("Name lookups, %d medications\n", count);
+    printf("  index: %12.0f lookups/sec\n", lookupCount / indexTime);
+    printf("  scan:  %12.0f lookups/sec\n", scanCount / scanTime);
+    if (found == 0) printf("(no hits)\n");
+
+    destroyMedicationBPlusTree(tree);
+}
+
+// Supplier lookups through the postings vs the old walk over every supplier tree.
+void benchmarkSupplierLookups(int count, int supplierCount, int lookupCount) {
+    MedicationBPlusTree *tree = createMedicationBPlusTree(64);
+    unsigned long state = 88172645463325252UL;
+    MedicationData data;
+    SupplierData supplier;
+    memset(&data, 0, sizeof(data));
+    memset(&supplier, 0, sizeof(supplier));
+    for (int i = 0; i < count; i++) {
+        data.Medication_ID = i + 1;
+        data.Suppliers = createSupplierBPlusTree(tree);
+        for (int j = 0; j < 3; j++) {
+            supplier.Supplier_ID = benchRandom(&state) % supplierCount;
+            insertSupplier(data.Suppliers, supplier);
         }
-        break;
+        insertMedication(tree, data);
     }
-    case 4: {
-        printf("Enter the Supplier ID to search: \n");
-        scanf("%lu", &id);
-        if (searchSupplier(medication->Suppliers, id)) {
-            printf("Supplier ID %lu found.\n", id);
-            printf("Details:\n");
-            SupplierNode *leaf2 = findSupplierLeafNode(medication->Suppliers, id);
-            SupplierLeafNode *leaf = &(leaf2->leaf);
-            for (int i = 0; i < leaf->cursize; i++) {
-                if (leaf->keys[i] == id) {
-                    printSupplier(&leaf->values[i]);
-                    break;
+
+    long found = 0;
+    double start = nowSeconds();
+    for (int i = 0; i < lookupCount; i++) {
+        found += findMedicationsBySupplier(tree, benchRandom(&state) % supplierCount, NULL, NULL);
+    }
+    double indexTime = nowSeconds() - start;
+
+    int scanCount = lookupCount / 1000 + 1;
+    start = nowSeconds();
+    for (int i = 0; i < scanCount; i++) {
+        unsigned long supplierID = benchRandom(&state) % supplierCount;
+        for (MedicationLeafNode *leaf = tree->leftmost_leaf; leaf; leaf = leaf->next) {
+            for (int j = 0; j < leaf->cursize; j++) {
+                for (SupplierLeafNode *s = leaf->values[j]->Suppliers->leftmost_leaf; s; s = s->next) {
+                    for (int k = 0; k < s->cursize; k++) found += s->keys[k] == supplierID;
                 }
             }
-        } else {
-            printf("Supplier ID %lu not found.\n", id);
         }
-        break;
     }
-    case 5: {
-        printAllSuppliers(medication->Suppliers);
-        break;
+    double scanTime = nowSeconds() - start;
+
+    printf("Supplier lookups, %d medications, %d suppliers\n", count, supplierCount);
+    printf("  postings: %12.0f lookups/sec\n", lookupCount / indexTime);
+    printf("  scan:     %12.0f lookups/sec\n", scanCount / scanTime);
+    if (found == 0) printf("(no hits)\n");
+
+    destroyMedicationBPlusTree(tree);
+}
+
+// Append throughput of the write-ahead log in each durability mode.
+void benchmarkWal(int syncedCount, int count) {
+    const char *path = "pharmacy-bench.wal";
+    const char *names[] = { "fsync", "group", "none" };
+    WalDurability modes[] = { WAL_SYNC_EACH, WAL_SYNC_GROUP, WAL_SYNC_NONE };
+
+    printf("Write-ahead log appends (sale records, %zu bytes each)\n", sizeof(WalRecordHeader) + sizeof(WalSale));
+    for (int m = 0; m < 3; m++) {
+        int n = (modes[m] == WAL_SYNC_EACH) ? syncedCount : count;
+        unlink(path);
+        activeWal = walOpen(path, modes[m], NULL, NULL, 0);
+        if (!activeWal) return;
+        activeWal->checkpointBytes = LONG_MAX;
+
+        double start = nowSeconds();
+        for (int i = 0; i < n; i++) {
+            walLogSale(i, 1);
+        }
+        walFlush(activeWal);
+        double elapsed = nowSeconds() - start;
+
+        printf("  %-6s %12.0f ops/sec (%d records)\n", names[m], n / elapsed, n);
+        walClose(activeWal);
+        activeWal = NULL;
     }
-    case 0:
-        printf("Exiting supplier management.\n");
-        break;
-    default:
-        printf("Invalid choice.\n");
-    
+    unlink(path);
+}
+
+// One feed row applied on its own through the single-key calls the supplier
+// menu uses: the per-row baseline that applySupplierFeed is measured against.
+static void benchmarkApplyFeedRow(MedicationBPlusTree *tree, const SupplierFeedRow *row) {
+    MedicationData *medication = findMedication(tree, row->medicationID);
+    if (!medication) return;
+
+    unsigned long id = row->supplier.Supplier_ID;
+    SupplierNode *leaf2 = findSupplierLeafNode(medication->Suppliers, id);
+    int i = leaf2 ? findKeyIndex(leaf2->leaf.keys, leaf2->leaf.cursize, id) : -1;
+    long previous = (i == -1) ? 0 : (long)leaf2->leaf.values[i].Quantity_of_stock_bysupplier;
+    long delta = (long)row->supplier.Quantity_of_stock_bysupplier - previous;
+    long stock = (long)medication->Quantity_in_stock + delta;
+    medication->Quantity_in_stock = (stock < 0) ? 0 : (unsigned int)stock;
+    insertSupplier(medication->Suppliers, row->supplier);
+
+    UniqueSupplierNode *unique = (i != -1) ? findUniqueSupplierLeafNode(uniqueSupplierTree, id) : NULL;
+    int u = unique ? findKeyIndex(unique->leaf.keys, unique->leaf.cursize, id) : -1;
+    if (u != -1) {
+        UniqueSupplierData *held = &unique->leaf.values[u];
+        setUniqueSupplierTotals(uniqueSupplierTree, held, held->noOfUniqueMedicines, held->turnoverProduced + delta * (long)medication->Price_per_Unit);
+    } else {
+        insertUniqueSupplier(uniqueSupplierTree, id, row->supplier.Supplier_Name, 1,
+                             (unsigned long)row->supplier.Quantity_of_stock_bysupplier * medication->Price_per_Unit);
     }
-    return;
+
+    lowStockUpdate(&tree->lowStock, medication);
+    walLogMedication(WAL_SUPPLIER_CHANGE, medication);
+    walLogUniqueSupplier(id);
 }
 
-void salesTracking(MedicationBPlusTree* pharmacy){
-    if (!pharmacy || !pharmacy->root) {
-        printf("The medication B+ tree is empty.\n");
-        return;
+// count medications with even IDs and two suppliers each, and the matching
+// unique-supplier tree; odd IDs are left free for inserts.
+static MedicationBPlusTree* benchmarkFeedTree(int count, int order, unsigned long *state) {
+    MedicationBPlusTree *tree = createMedicationBPlusTree(order);
+    uniqueSupplierTree = createUniqueSupplierBPlusTree(order);
+    MedicationData *items = (MedicationData*)calloc(count, sizeof(MedicationData));
+    SupplierData supplier;
+    memset(&supplier, 0, sizeof(supplier));
+    strcpy(supplier.Supplier_Name, "Benchmark");
+
+    for (int i = 0; i < count; i++) {
+        items[i].Medication_ID = 2 * (unsigned long)(i + 1);
+        strcpy(items[i].Medicine_Name, "Benchmark");
+        items[i].Price_per_Unit = 10;
+        items[i].Suppliers = createSupplierBPlusTree(tree);
+        for (int j = 0; j < 2; j++) {
+            supplier.Supplier_ID = benchRandom(state) % 5000 + 1;
+            supplier.Quantity_of_stock_bysupplier = 50;
+            if (!checkSuppID(supplier.Supplier_ID, items[i].Suppliers)) continue;
+            insertSupplier(items[i].Suppliers, supplier);
+            insertUniqueSupplier(uniqueSupplierTree, supplier.Supplier_ID, supplier.Supplier_Name, 1, 500);
+            items[i].Quantity_in_stock += 50;
+        }
     }
+    insertMedicationBatch(tree, items, count);
+    free(items);
+    return tree;
+}
 
-    MedicationLeafNode* current = pharmacy->leftmost_leaf;
-    printf("\nEnter the id of the medication to track sales: ");
-    unsigned long id;
-    scanf("%lu", &id);
+static void benchmarkFeedTreeDestroy(MedicationBPlusTree *tree) {
+    destroyMedicationBPlusTree(tree);
+    destroyUniqueSupplierBPlusTree(uniqueSupplierTree);
+    uniqueSupplierTree = NULL;
+}
 
-    while (current != NULL) {
-        for (int i = 0; i < current->cursize; i++) {
-            if(current->keys[i] == id){
-                int sales;
-                printf("\nEnter the number of sales for %s: ", current->values[i].Medicine_Name);
-                scanf("%d", &sales);
-                if(sales > current->values[i].Quantity_in_stock){
-                    printf("\nNot enough stock available for this medication.");
-                }
-                else{
-                    current->values[i].Batch_details.Total_sales += sales;
-                    current->values[i].Quantity_in_stock -= sales;
-                    printf("====Sales updated successfully===\n");
-                }
+// Single-key calls against the batched API: medication inserts into a populated
+// tree, then a supplier feed with the WAL off and in group and fsync modes.
+void benchmarkBatchInserts(int count, int rows, int syncedRows) {
+    const char *path = "pharmacy-bench.wal";
+    unsigned long state = 0x9e3779b97f4a7c15UL;
+
+    MedicationData *items = (MedicationData*)calloc(rows, sizeof(MedicationData));
+    for (int i = 0; i < rows; i++) {
+        items[i].Medication_ID = 2 * (benchRandom(&state) % count) + 1;
+        strcpy(items[i].Medicine_Name, "Inserted");
+        items[i].Quantity_in_stock = 1;
+    }
+
+    printf("Batched inserts, %d medications\n", count);
+    MedicationBPlusTree *tree = benchmarkFeedTree(count, 64, &state);
+    double start = nowSeconds();
+    for (int i = 0; i < rows; i++) insertMedication(tree, items[i]);
+    double rowTime = nowSeconds() - start;
+    benchmarkFeedTreeDestroy(tree);
+
+    tree = benchmarkFeedTree(count, 64, &state);
+    start = nowSeconds();
+    insertMedicationBatch(tree, items, rows);
+    double batchTime = nowSeconds() - start;
+    benchmarkFeedTreeDestroy(tree);
+    printf("  medications, %d random IDs:   per-row %10.0f rows/sec, batch %10.0f rows/sec (%.1fx)\n",
+           rows, rows / rowTime, rows / batchTime, rowTime / batchTime);
+    free(items);
+
+    SupplierFeedRow *feed = (SupplierFeedRow*)calloc(rows, sizeof(SupplierFeedRow));
+    SupplierFeedRow *sortedFeed = (SupplierFeedRow*)malloc(sizeof(SupplierFeedRow) * rows);
+    for (int i = 0; i < rows; i++) {
+        feed[i].medicationID = 2 * (benchRandom(&state) % count + 1);
+        feed[i].line = i + 1;
+        feed[i].supplier.Supplier_ID = benchRandom(&state) % 5000 + 1;
+        feed[i].supplier.Quantity_of_stock_bysupplier = benchRandom(&state) % 100;
+        strcpy(feed[i].supplier.Supplier_Name, "Feed");
+        strcpy(feed[i].supplier.Contact, "9999999999");
+    }
+
+    const char *names[] = { "no WAL", "group", "fsync" };
+    for (int m = 0; m < 3; m++) {
+        int n = (m == 2) ? syncedRows : rows;
+        double times[2];
+        for (int batched = 0; batched < 2; batched++) {
+            tree = benchmarkFeedTree(count, 64, &state);
+            if (m > 0) {
+                unlink(path);
+                activeWal = walOpen(path, (m == 1) ? WAL_SYNC_GROUP : WAL_SYNC_EACH, NULL, NULL, 0);
+                if (!activeWal) return;
+                activeWal->checkpointBytes = LONG_MAX;
             }
+
+            start = nowSeconds();
+            if (batched) {
+                long unknown;
+                memcpy(sortedFeed, feed, sizeof(SupplierFeedRow) * rows);
+                qsort(sortedFeed, rows, sizeof(SupplierFeedRow), compareSupplierFeedRows);
+                applySupplierFeed(tree, sortedFeed, rows, &unknown);
+                n = rows;
+            } else {
+                for (int i = 0; i < n; i++) benchmarkApplyFeedRow(tree, &feed[i]);
+            }
+            walFlush(activeWal);
+            times[batched] = (nowSeconds() - start) / n;
+
+            walClose(activeWal);
+            activeWal = NULL;
+            benchmarkFeedTreeDestroy(tree);
+            n = (m == 2) ? syncedRows : rows;
         }
-        current = current->next;
+        printf("  supplier feed, %-6s (%d rows): per-row %10.0f rows/sec, batch %10.0f rows/sec (%.1fx)\n",
+               names[m], rows, 1 / times[0], 1 / times[1], times[0] / times[1]);
     }
+    unlink(path);
+
+    free(feed);
+    free(sortedFeed);
 }
 
-void searchPharmacyUsingName(MedicationBPlusTree* pharmacy) {
-    if (!pharmacy || !pharmacy->root) {
-        printf("The medication B+ tree is empty.\n");
-        return;
+//==============================================================================
+// Workload generators (--generate FILE, --generate-pos FILE): synthetic data
+// in the medication.txt layout read by ReadFileAndStoreData, and point-of-sale
+// baskets in the --pos layout, for load-testing startup, search and sales at
+// millions of records. Output depends only on the options and the seed.
+
+typedef struct GeneratorOptions {
+    long medications;                          // Records, IDs 1..medications
+    int suppliersPerMedication;                // Each medication has 1..this many
+    long supplierPool;                         // Distinct suppliers; fewer means more sharing
+    int expiryDays;                            // Expiry dates fall in [start, start + expiryDays)
+    int expiryStartDay;                        // Day number (daysFromCivil) of the first date
+    long vocabulary;                           // Distinct name stems
+    long baskets;                              // POS lines
+    int basketSize;                            // Each basket holds 1..this many items
+    unsigned long seed;
+} GeneratorOptions;
+
+static const char *generatorSyllables[] = {
+    "ac", "al", "am", "ar", "ba", "ce", "cla", "di", "do", "fe", "ga", "le",
+    "lo", "me", "mi", "na", "ne", "ox", "pa", "pro", "ri", "so", "ta", "ve"
+};
+static const char *generatorSuffixes[] = { "ol", "ine", "cin", "pril", "statin", "zole", "mab", "ide" };
+static const int generatorStrengths[] = { 5, 10, 20, 25, 50, 100, 250, 500 };
+static const char *generatorSupplierNames[] = {
+    "Apex", "Medline", "Sunrise", "Carewell", "Nova", "Zenith", "Lifeline", "Trident",
+    "Healix", "Orbit", "Vital", "Summit", "Pioneer", "Meridian", "Cedar", "Harbor"
+};
+
+#define GENERATOR_SYLLABLES ((unsigned long)(sizeof(generatorSyllables) / sizeof(generatorSyllables[0])))
+#define GENERATOR_SUFFIXES (sizeof(generatorSuffixes) / sizeof(generatorSuffixes[0]))
+#define GENERATOR_STRENGTHS (sizeof(generatorStrengths) / sizeof(generatorStrengths[0]))
+#define GENERATOR_SUPPLIER_NAMES (sizeof(generatorSupplierNames) / sizeof(generatorSupplierNames[0]))
+
+void defaultGeneratorOptions(GeneratorOptions *options) {
+    time_t now = time(NULL);
+    struct tm today;
+    localtime_r(&now, &today);
+    options->medications = 1000000;
+    options->suppliersPerMedication = 3;
+    options->supplierPool = 0;                 // Chosen from medications when left at 0
+    options->expiryDays = 1095;
+    options->expiryStartDay = daysFromCivil(today.tm_mday, today.tm_mon + 1, today.tm_year + 1900) - 90;
+    options->vocabulary = 5000;
+    options->baskets = 1000000;
+    options->basketSize = 4;
+    options->seed = 88172645463325252UL;
+}
+
+// Stem number to a name such as "Proacine": its digits in mixed radix pick two
+// syllables, a suffix and, for large vocabularies, further syllables.
+static void generatorStem(unsigned long stem, char *out, size_t size) {
+    int length = snprintf(out, size, "%s%s", generatorSyllables[stem % GENERATOR_SYLLABLES],
+                          generatorSyllables[stem / GENERATOR_SYLLABLES % GENERATOR_SYLLABLES]);
+    stem /= GENERATOR_SYLLABLES * GENERATOR_SYLLABLES;
+    const char *suffix = generatorSuffixes[stem % GENERATOR_SUFFIXES];
+    for (stem /= GENERATOR_SUFFIXES; stem && length < (int)size; stem /= GENERATOR_SYLLABLES) {
+        length += snprintf(out + length, size - length, "%s", generatorSyllables[stem % GENERATOR_SYLLABLES]);
+    }
+    if (length < (int)size) snprintf(out + length, size - length, "%s", suffix);
+    out[0] = toupper((unsigned char)out[0]);
+}
+
+// Supplier names and contacts are fixed per ID, as the unique-supplier tree expects.
+static void generatorSupplier(unsigned long id, char *name, size_t nameSize, char *contact, size_t contactSize) {
+    snprintf(name, nameSize, "%s_%lu", generatorSupplierNames[id % GENERATOR_SUPPLIER_NAMES], id);
+    snprintf(contact, contactSize, "%lu", 6000000000UL + (id * 2654435761UL) % 4000000000UL);
+}
+
+// Writes options->medications records. Name stems and suppliers are drawn with a
+// Zipf-like skew, so a few of each are very common, as in a real catalog; the
+// stock is the sum of the supplier quantities.
+bool generateMedicationFile(const char *filename, const GeneratorOptions *options) {
+    long pool = options->supplierPool > 0 ? options->supplierPool : options->medications / 20 + 1;
+    if (options->medications < 1 || options->suppliersPerMedication < 1 || options->expiryDays < 1 || options->vocabulary < 1) {
+        printf("Error: the generator needs at least one medication, supplier, expiry day and name\n");
+        return false;
     }
-    char name[NAME_SIZE];
-    printf("Enter the name of the medication to search: \n");
-    scanf("%s", name);
+    FILE *file = fopen(filename, "w");
+    if (!file) {
+        printf("Error: unable to open %s for writing\n", filename);
+        return false;
+    }
+    setvbuf(file, NULL, _IOFBF, 1 << 20);
+
+    unsigned long state = options->seed | 1;
+    unsigned long *picked = (unsigned long*)malloc(sizeof(unsigned long) * options->suppliersPerMedication);
+    unsigned int *quantities = (unsigned int*)malloc(sizeof(unsigned int) * options->suppliersPerMedication);
+    double start = nowSeconds();
+    long supplierRows = 0;
+    for (long id = 1; id <= options->medications; id++) {
+        char stem[NAME_SIZE / 2];
+        generatorStem(benchZipfRank(&state, options->vocabulary), stem, sizeof(stem));
+        unsigned int price = 1 + benchRandom(&state) % 500;
+        int day, month, year;
+        civilFromDays(options->expiryStartDay + (int)(benchRandom(&state) % options->expiryDays), &day, &month, &year);
+
+        // Distinct suppliers for this medication; a small pool caps the count
+        int suppliers = 1 + benchRandom(&state) % options->suppliersPerMedication;
+        if (suppliers > pool) suppliers = (int)pool;
+        unsigned int stock = 0;
+        for (int j = 0; j < suppliers; j++) {
+            // Repeats fall back to a uniform pick, which always finds a free supplier
+            bool fresh = false;
+            for (int attempt = 0; !fresh; attempt++) {
+                picked[j] = (attempt < 4 ? benchZipfRank(&state, pool) : benchRandom(&state) % pool) + 1;
+                fresh = true;
+                for (int k = 0; k < j; k++) fresh = fresh && picked[k] != picked[j];
+            }
+            quantities[j] = benchRandom(&state) % 200;
+            stock += quantities[j];
+        }
 
-    printf("\nSearching for medication with name: %s\n", name);
+        fprintf(file, "%ld\n%s %dmg\n%u\n%u\nB%06lX\n%d\n%d\n%d\n%d\n", id, stem,
+                generatorStrengths[benchRandom(&state) % GENERATOR_STRENGTHS], stock, price,
+                benchRandom(&state) % 0x1000000, day, month, year, suppliers);
+        for (int j = 0; j < suppliers; j++) {
+            char name[NAME_SIZE], contact[CONTACT_SIZE];
+            generatorSupplier(picked[j], name, sizeof(name), contact, sizeof(contact));
+            fprintf(file, "%lu\n%s\n%u\n%s\n", picked[j], name, quantities[j], contact);
+        }
+        fprintf(file, "%lu\n\n", 10 + benchRandom(&state) % 50);
+        supplierRows += suppliers;
+    }
+    free(picked);
+    free(quantities);
+
+    bool ok = !ferror(file);
+    ok = (fclose(file) == 0) && ok;
+    double elapsed = nowSeconds() - start;
+    if (!ok) {
+        printf("Error: writing %s failed\n", filename);
+        return false;
+    }
+    printf("Wrote %ld medications with %ld supplier entries from %ld suppliers to %s in %.2f s (%.0f records/sec)\n",
+           options->medications, supplierRows, pool, filename, elapsed, elapsed > 0 ? options->medications / elapsed : 0.0);
+    return true;
+}
 
-    MedicationLeafNode* current = pharmacy->leftmost_leaf;
-    bool found = false;
+static unsigned long generatorGcd(unsigned long a, unsigned long b) {
+    while (b) {
+        unsigned long r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
 
-    while (current != NULL) {
-        for (int i = 0; i < current->cursize; i++) {
-            if (strcmp(current->values[i].Medicine_Name, name) == 0) { // Case-insensitive comparison
-                printMedicationDetails(&current->values[i]);
-                found = true;
+// Writes options->baskets lines of "ID QTY ..." over IDs 1..idRange. Popular
+// medications follow a Zipf-like skew, scattered over the ID range by a
+// multiplicative permutation; no ID repeats within a basket.
+bool generatePosFile(const char *filename, const GeneratorOptions *options, unsigned long idRange) {
+    if (options->baskets < 1 || options->basketSize < 1 || idRange < 1) {
+        printf("Error: the generator needs at least one basket, item and ID\n");
+        return false;
+    }
+    FILE *file = fopen(filename, "w");
+    if (!file) {
+        printf("Error: unable to open %s for writing\n", filename);
+        return false;
+    }
+    setvbuf(file, NULL, _IOFBF, 1 << 20);
+
+    unsigned long scatter = 2654435761UL % idRange;
+    while (idRange > 1 && generatorGcd(scatter, idRange) != 1) scatter++;
+    unsigned long state = (options->seed ^ 0x9e3779b97f4a7c15UL) | 1;
+    unsigned long *basket = (unsigned long*)malloc(sizeof(unsigned long) * options->basketSize);
+    double start = nowSeconds();
+    long items = 0;
+    for (long b = 0; b < options->baskets; b++) {
+        int size = 1 + benchRandom(&state) % options->basketSize;
+        if ((unsigned long)size > idRange) size = (int)idRange;
+        for (int j = 0; j < size; j++) {
+            bool fresh = false;
+            for (int attempt = 0; !fresh; attempt++) {
+                basket[j] = attempt < 4 ? (benchZipfRank(&state, idRange) * scatter) % idRange + 1 : benchRandom(&state) % idRange + 1;
+                fresh = true;
+                for (int k = 0; k < j; k++) fresh = fresh && basket[k] != basket[j];
             }
+            unsigned long pick = benchRandom(&state) % 10;
+            fprintf(file, j ? " %lu %d" : "%lu %d", basket[j], pick < 7 ? 1 : pick < 9 ? 2 : 3);
         }
-        current = current->next;
+        fputc('\n', file);
+        items += size;
     }
+    free(basket);
 
-    if (!found) {
-        printf("No medication found with the name: %s\n", name);
+    bool ok = !ferror(file);
+    ok = (fclose(file) == 0) && ok;
+    double elapsed = nowSeconds() - start;
+    if (!ok) {
+        printf("Error: writing %s failed\n", filename);
+        return false;
     }
+    printf("Wrote %ld baskets (%ld items) to %s in %.2f s (%.0f baskets/sec)\n",
+           options->baskets, items, filename, elapsed, elapsed > 0 ? options->baskets / elapsed : 0.0);
+    return true;
 }
 
-void searchMedicationsUsingSupplier(MedicationBPlusTree* pharmacy, unsigned long supplierID) {
-    if (!pharmacy || !pharmacy->root) {
-        printf("The medication B+ tree is empty.\n");
-        return;
+//==============================================================================
+// Benchmark suite: this file built with
+//
+//     gcc -O2 -DPHARMACY_BENCHMARK_SUITE Pharmacy.c -o pharmacy_bench -pthread
+//
+// has a main that runs insert, point lookup, range scan and delete passes over
+// each tree for every order, key distribution and size asked for, and writes
+// one CSV row per pass. Splits and merges are read off the node pools: a split
+// adds one node, a merge frees one, and a root split or collapse also changes
+// the height, so splits or merges = change in nodes - change in height.
+
+#define BENCH_SCAN_LENGTH 100
+#define BENCH_MAX_LIST 32
+
+typedef enum BenchDistribution {
+    BENCH_SEQUENTIAL,                          // Ascending keys
+    BENCH_RANDOM,                              // Uniform over the keys
+    BENCH_ZIPFIAN                              // Skewed towards a few hot keys
+} BenchDistribution;
+
+static const char *benchDistributionNames[] = { "sequential", "random", "zipfian" };
+
+// One tree behind a common interface, keyed by small integers.
+typedef struct BenchTree {
+    const char *name;
+    void* (*create)(int order);
+    void (*destroy)(void *tree);
+    void (*insert)(void *tree, unsigned long key);
+    bool (*lookup)(void *tree, unsigned long key);
+    long (*scan)(void *tree, unsigned long key, int count);   // Entries read from key on, at most count
+    void (*remove)(void *tree, unsigned long key);
+    long (*nodes)(void *tree, int *height);                    // Live nodes
+} BenchTree;
+
+// Height of any of the trees, which all link children the same way.
+#define BENCH_TREE_HEIGHT(root, height) do {                                             \
+        (height) = 0;                                                                    \
+        for (__typeof__(root) node = (root); node;                                       \
+             node = node->isLeaf ? NULL : node->internal.children[0]) (height)++;        \
+    } while (0)
+
+static void* benchCreateMedications(int order) {
+    return createMedicationBPlusTree(order);
+}
+
+static void benchDestroyMedications(void *tree) {
+    destroyMedicationBPlusTree((MedicationBPlusTree*)tree);
+}
+
+static void benchInsertMedication(void *tree, unsigned long key) {
+    MedicationData data;
+    memset(&data, 0, sizeof(data));
+    data.Medication_ID = key;
+    insertMedication((MedicationBPlusTree*)tree, data);
+}
+
+static bool benchLookupMedication(void *tree, unsigned long key) {
+    return findMedication((MedicationBPlusTree*)tree, key) != NULL;
+}
+
+static long benchScanMedications(void *tree, unsigned long key, int count) {
+    MedicationNode *node = findLeafNode((MedicationBPlusTree*)tree, key);
+    if (!node) return 0;
+    long read = 0;
+    int i = lowerBoundKey(node->leaf.keys, node->leaf.cursize, key);
+    for (MedicationLeafNode *leaf = &(node->leaf); leaf && read < count; leaf = leaf->next, i = 0) {
+        for (; i < leaf->cursize && read < count; i++) read += leaf->values[i]->Medication_ID == leaf->keys[i];
     }
+    return read;
+}
 
-    printf("\nSearching for medications supplied by Supplier ID %lu...\n", supplierID);
+static void benchRemoveMedication(void *tree, unsigned long key) {
+    deleteMedicationByID((MedicationBPlusTree*)tree, key);
+}
 
-    MedicationLeafNode* current = pharmacy->leftmost_leaf;
+static long benchMedicationNodes(void *tree, int *height) {
+    MedicationBPlusTree *medications = (MedicationBPlusTree*)tree;
+    BENCH_TREE_HEIGHT(medications->root, *height);
+    return medications->leafNodes.liveSlots + medications->internalNodes.liveSlots;
+}
 
-    while (current != NULL) {
-        for (int i = 0; i < current->cursize; i++) {
-            if (current->values[i].Suppliers) {
-                SupplierLeafNode* supplierLeaf = current->values[i].Suppliers->leftmost_leaf;
-                while (supplierLeaf != NULL) {
-                    for (int j = 0; j < supplierLeaf->cursize; j++) {
-                        if (supplierLeaf->keys[j] == supplierID) {
-                            printMedicationDetails(&current->values[i]);
-                            break;
-                        }
-                    }
-                    supplierLeaf = supplierLeaf->next;
+// Supplier trees need a medication tree to own their pools.
+typedef struct BenchSupplierTree {
+    MedicationBPlusTree *owner;
+    SupplierBPlusTree *suppliers;
+} BenchSupplierTree;
+
+static void* benchCreateSuppliers(int order) {
+    BenchSupplierTree *tree = (BenchSupplierTree*)malloc(sizeof(BenchSupplierTree));
+    tree->owner = createMedicationBPlusTree(order);
+    tree->suppliers = createSupplierBPlusTree(tree->owner);
+    return tree;
+}
+
+static void benchDestroySuppliers(void *tree) {
+    destroyMedicationBPlusTree(((BenchSupplierTree*)tree)->owner);
+    free(tree);
+}
+
+static void benchInsertSupplier(void *tree, unsigned long key) {
+    SupplierData data;
+    memset(&data, 0, sizeof(data));
+    data.Supplier_ID = key;
+    insertSupplier(((BenchSupplierTree*)tree)->suppliers, data);
+}
+
+static bool benchLookupSupplier(void *tree, unsigned long key) {
+    return !checkSuppID(key, ((BenchSupplierTree*)tree)->suppliers);
+}
+
+static long benchScanSuppliers(void *tree, unsigned long key, int count) {
+    SupplierNode *node = findSupplierLeafNode(((BenchSupplierTree*)tree)->suppliers, key);
+    if (!node) return 0;
+    long read = 0;
+    int i = lowerBoundKey(node->leaf.keys, node->leaf.cursize, key);
+    for (SupplierLeafNode *leaf = &(node->leaf); leaf && read < count; leaf = leaf->next, i = 0) {
+        for (; i < leaf->cursize && read < count; i++) read += leaf->values[i].Supplier_ID == leaf->keys[i];
+    }
+    return read;
+}
+
+static void benchRemoveSupplier(void *tree, unsigned long key) {
+    deleteSupplierByID(((BenchSupplierTree*)tree)->suppliers, key);
+}
+
+static long benchSupplierNodes(void *tree, int *height) {
+    BenchSupplierTree *suppliers = (BenchSupplierTree*)tree;
+    BENCH_TREE_HEIGHT(suppliers->suppliers->root, *height);
+    return suppliers->owner->supplierLeafNodes.liveSlots + suppliers->owner->supplierInternalNodes.liveSlots;
+}
+
+static void* benchCreateUniqueSuppliers(int order) {
+    return createUniqueSupplierBPlusTree(order);
+}
+
+static void benchDestroyUniqueSuppliers(void *tree) {
+    destroyUniqueSupplierBPlusTree((UniqueSupplierBPlusTree*)tree);
+}
+
+static void benchInsertUniqueSupplier(void *tree, unsigned long key) {
+    insertUniqueSupplier((UniqueSupplierBPlusTree*)tree, key, "Benchmark", 1, key % 1000);
+}
+
+static bool benchLookupUniqueSupplier(void *tree, unsigned long key) {
+    return findUniqueSupplier((UniqueSupplierBPlusTree*)tree, key) != NULL;
+}
+
+static long benchScanUniqueSuppliers(void *tree, unsigned long key, int count) {
+    UniqueSupplierNode *node = findUniqueSupplierLeafNode((UniqueSupplierBPlusTree*)tree, key);
+    if (!node) return 0;
+    long read = 0;
+    int i = lowerBoundKey(node->leaf.keys, node->leaf.cursize, key);
+    for (UniqueSupplierLeafNode *leaf = &(node->leaf); leaf && read < count; leaf = leaf->next, i = 0) {
+        for (; i < leaf->cursize && read < count; i++) read += leaf->values[i].Supplier_ID == leaf->keys[i];
+    }
+    return read;
+}
+
+static void benchRemoveUniqueSupplier(void *tree, unsigned long key) {
+    deleteUniqueSupplier((UniqueSupplierBPlusTree*)tree, key);
+}
+
+static long benchUniqueSupplierNodes(void *tree, int *height) {
+    UniqueSupplierBPlusTree *suppliers = (UniqueSupplierBPlusTree*)tree;
+    BENCH_TREE_HEIGHT(suppliers->root, *height);
+    return suppliers->leafNodes.liveSlots + suppliers->internalNodes.liveSlots;
+}
+
+static void* benchCreateExpirations(int order) {
+    return createExpirationBPlusTree(order);
+}
+
+static void benchDestroyExpirations(void *tree) {
+    destroyExpirationBPlusTree((ExpirationBPlusTree*)tree);
+}
+
+static void benchInsertExpiration(void *tree, unsigned long key) {
+    insertIntoExpirationTree((ExpirationBPlusTree*)tree, key, key, "Benchmark");
+}
+
+static bool benchLookupExpiration(void *tree, unsigned long key) {
+    ExpirationNode *node = findLeafNodeForExpiry((ExpirationBPlusTree*)tree, key);
+    if (!node) return false;
+    int i = lowerBoundExpiryKey(node->leaf.keys, node->leaf.cursize, key);
+    return i < node->leaf.cursize && node->leaf.keys[i] == key;
+}
+
+static long benchScanExpirations(void *tree, unsigned long key, int count) {
+    ExpirationNode *node = findLeafNodeForExpiry((ExpirationBPlusTree*)tree, key);
+    if (!node) return 0;
+    long read = 0;
+    int i = lowerBoundExpiryKey(node->leaf.keys, node->leaf.cursize, key);
+    for (ExpirationLeafNode *leaf = &(node->leaf); leaf && read < count; leaf = leaf->next, i = 0) {
+        for (; i < leaf->cursize && read < count; i++) read += leaf->values[i].medicationID == leaf->keys[i];
+    }
+    return read;
+}
+
+static void benchRemoveExpiration(void *tree, unsigned long key) {
+    deleteFromExpirationTree((ExpirationBPlusTree*)tree, key);
+}
+
+static long benchExpirationNodes(void *tree, int *height) {
+    ExpirationBPlusTree *expirations = (ExpirationBPlusTree*)tree;
+    BENCH_TREE_HEIGHT(expirations->root, *height);
+    return expirations->leafNodes.liveSlots + expirations->internalNodes.liveSlots;
+}
+
+const BenchTree benchTrees[] = {
+    { "medication", benchCreateMedications, benchDestroyMedications, benchInsertMedication,
+      benchLookupMedication, benchScanMedications, benchRemoveMedication, benchMedicationNodes },
+    { "supplier", benchCreateSuppliers, benchDestroySuppliers, benchInsertSupplier,
+      benchLookupSupplier, benchScanSuppliers, benchRemoveSupplier, benchSupplierNodes },
+    { "unique_supplier", benchCreateUniqueSuppliers, benchDestroyUniqueSuppliers, benchInsertUniqueSupplier,
+      benchLookupUniqueSupplier, benchScanUniqueSuppliers, benchRemoveUniqueSupplier, benchUniqueSupplierNodes },
+    { "expiration", benchCreateExpirations, benchDestroyExpirations, benchInsertExpiration,
+      benchLookupExpiration, benchScanExpirations, benchRemoveExpiration, benchExpirationNodes },
+};
+#define BENCH_TREE_COUNT ((int)(sizeof(benchTrees) / sizeof(benchTrees[0])))
+
+// The key for the i-th of count probes over keys. Zipfian ranks go through a
+// shuffled copy of the keys, so the hot ones are spread across the tree.
+static unsigned long benchProbeKey(BenchDistribution distribution, const unsigned long *shuffled, long n,
+                                   long i, unsigned long *state) {
+    switch (distribution) {
+        case BENCH_SEQUENTIAL: return (unsigned long)(i % n) + 1;
+        case BENCH_RANDOM: return benchRandom(state) % n + 1;
+        default: return shuffled[benchZipfRank(state, n)];
+    }
+}
+
+static void printBenchRow(FILE *out, const char *tree, int order, BenchDistribution distribution, long records,
+                          const char *operation, long count, double seconds, long splits, long merges, int height) {
+    fprintf(out, "%s,%d,%s,%ld,%s,%ld,%.6f,%.0f,%ld,%ld,%d\n", tree, order, benchDistributionNames[distribution],
+            records, operation, count, seconds, seconds > 0 ? count / seconds : 0.0, splits, merges, height);
+    fflush(out);
+}
+
+// One pass: n keys (1..n) inserted, probed, scanned and deleted again.
+// Inserts and deletes use each key once, ascending for sequential runs and
+// shuffled otherwise; lookups and scan starts follow the distribution.
+static void runBenchPass(FILE *out, const BenchTree *bench, int order, BenchDistribution distribution, long n,
+                         long lookups, long scans) {
+    unsigned long *keys = (unsigned long*)malloc(sizeof(unsigned long) * n);
+    unsigned long *shuffled = (unsigned long*)malloc(sizeof(unsigned long) * n);
+    unsigned long state = 2463534242UL + (unsigned long)n;
+    for (long i = 0; i < n; i++) shuffled[i] = i + 1;
+    for (long i = n - 1; i > 0; i--) {
+        long j = benchRandom(&state) % (i + 1);
+        unsigned long tmp = shuffled[i]; shuffled[i] = shuffled[j]; shuffled[j] = tmp;
+    }
+    for (long i = 0; i < n; i++) keys[i] = (distribution == BENCH_SEQUENTIAL) ? (unsigned long)i + 1 : shuffled[i];
+
+    void *tree = bench->create(order);
+    int height = 0;
+    double start = nowSeconds();
+    for (long i = 0; i < n; i++) bench->insert(tree, keys[i]);
+    double elapsed = nowSeconds() - start;
+    long nodes = bench->nodes(tree, &height);
+    printBenchRow(out, bench->name, order, distribution, n, "insert", n, elapsed, nodes - height, 0, height);
+
+    long found = 0;
+    start = nowSeconds();
+    for (long i = 0; i < lookups; i++) found += bench->lookup(tree, benchProbeKey(distribution, shuffled, n, i, &state));
+    elapsed = nowSeconds() - start;
+    printBenchRow(out, bench->name, order, distribution, n, "lookup", lookups, elapsed, 0, 0, height);
+
+    long read = 0;
+    start = nowSeconds();
+    for (long i = 0; i < scans; i++) {
+        read += bench->scan(tree, benchProbeKey(distribution, shuffled, n, i * BENCH_SCAN_LENGTH, &state), BENCH_SCAN_LENGTH);
+    }
+    elapsed = nowSeconds() - start;
+    printBenchRow(out, bench->name, order, distribution, n, "range_scan", scans, elapsed, 0, 0, height);
+
+    start = nowSeconds();
+    for (long i = 0; i < n; i++) bench->remove(tree, keys[i]);
+    elapsed = nowSeconds() - start;
+    int heightAfter;
+    long nodesAfter = bench->nodes(tree, &heightAfter);
+    printBenchRow(out, bench->name, order, distribution, n, "delete", n, elapsed, 0,
+                  (nodes - nodesAfter) - (height - heightAfter), height);
+
+    if (found != lookups || (n > 0 && read == 0)) fprintf(stderr, "%s: %ld of %ld lookups hit\n", bench->name, found, lookups);
+    bench->destroy(tree);
+    free(keys);
+    free(shuffled);
+}
+
+// Splits a comma-separated list of positive numbers.
+static int parseBenchNumbers(const char *text, long *values, int max) {
+    int count = 0;
+    while (*text && count < max) {
+        char *end;
+        long value = strtol(text, &end, 10);
+        if (end == text || value <= 0 || (*end != ',' && *end != '\0')) return -1;
+        values[count++] = value;
+        text = (*end == ',') ? end + 1 : end;
+    }
+    return *text ? -1 : count;
+}
+
+// Matches each comma-separated name against names, setting chosen[i] for a match.
+static bool parseBenchNames(const char *text, const char *const *names, int nameCount, bool *chosen) {
+    for (int i = 0; i < nameCount; i++) chosen[i] = false;
+    while (*text) {
+        size_t length = strcspn(text, ",");
+        int match = -1;
+        for (int i = 0; i < nameCount; i++) {
+            if (strlen(names[i]) == length && strncmp(names[i], text, length) == 0) match = i;
+        }
+        if (match < 0) return false;
+        chosen[match] = true;
+        text += length;
+        if (*text == ',') text++;
+    }
+    return true;
+}
+
+int runBenchmarkSuite(int argc, char *argv[]) {
+    long orders[BENCH_MAX_LIST] = { 4, 16, 64, 256 };
+    long sizes[BENCH_MAX_LIST] = { 10000, 100000, 1000000 };
+    int orderCount = 4, sizeCount = 3;
+    bool trees[BENCH_TREE_COUNT], distributions[3];
+    const char *treeNames[BENCH_TREE_COUNT];
+    for (int i = 0; i < BENCH_TREE_COUNT; i++) {
+        treeNames[i] = benchTrees[i].name;
+        trees[i] = true;
+    }
+    for (int i = 0; i < 3; i++) distributions[i] = true;
+    long lookups = 1000000, scans = 10000;
+    FILE *out = stdout;
+
+    for (int i = 1; i < argc; i++) {
+        bool ok = i + 1 < argc;
+        if (ok && strcmp(argv[i], "--trees") == 0) ok = parseBenchNames(argv[++i], treeNames, BENCH_TREE_COUNT, trees);
+        else if (ok && strcmp(argv[i], "--distributions") == 0) ok = parseBenchNames(argv[++i], benchDistributionNames, 3, distributions);
+        else if (ok && strcmp(argv[i], "--orders") == 0) ok = (orderCount = parseBenchNumbers(argv[++i], orders, BENCH_MAX_LIST)) > 0;
+        else if (ok && strcmp(argv[i], "--sizes") == 0) ok = (sizeCount = parseBenchNumbers(argv[++i], sizes, BENCH_MAX_LIST)) > 0;
+        else if (ok && strcmp(argv[i], "--lookups") == 0) ok = parseBenchNumbers(argv[++i], &lookups, 1) == 1;
+        else if (ok && strcmp(argv[i], "--scans") == 0) ok = parseBenchNumbers(argv[++i], &scans, 1) == 1;
+        else if (ok && strcmp(argv[i], "--output") == 0) ok = (out = fopen(argv[++i], "w")) != NULL;
+        else ok = false;
+        if (!ok) {
+            fprintf(stderr, "Usage: %s [--trees medication,supplier,unique_supplier,expiration] [--orders 4,16,64,256]\n"
+                            "       [--distributions sequential,random,zipfian] [--sizes 10000,100000,1000000]\n"
+                            "       [--lookups N] [--scans N] [--output FILE]\n", argv[0]);
+            return 1;
+        }
+    }
+    for (int i = 0; i < orderCount; i++) {
+        if (orders[i] < 3) {
+            fprintf(stderr, "The order must be at least 3\n");
+            return 1;
+        }
+    }
+
+    // Medication deletes also clear their expiration entries
+    expirationTree = createExpirationBPlusTree(64);
+    uniqueSupplierTree = createUniqueSupplierBPlusTree(64);
+
+    fprintf(out, "tree,order,distribution,records,operation,count,seconds,ops_per_sec,splits,merges,height\n");
+    for (int t = 0; t < BENCH_TREE_COUNT; t++) {
+        if (!trees[t]) continue;
+        for (int s = 0; s < sizeCount; s++) {
+            for (int o = 0; o < orderCount; o++) {
+                for (int d = 0; d < 3; d++) {
+                    if (distributions[d]) runBenchPass(out, &benchTrees[t], (int)orders[o], (BenchDistribution)d, sizes[s], lookups, scans);
                 }
             }
         }
-        current = current->next;
     }
+
+    destroyExpirationBPlusTree(expirationTree);
+    destroyUniqueSupplierBPlusTree(uniqueSupplierTree);
+    if (out != stdout) fclose(out);
+    return 0;
 }
 
-void printUniqueSupplierBPlusTree(UniqueSupplierBPlusTree* tree) {
-    if (!tree || !tree->root) {
-        printf("The unique supplier B+ tree is empty.\n");
-        return;
+#ifdef PHARMACY_BENCHMARK_SUITE
+int main(int argc, char *argv[]){
+    return runBenchmarkSuite(argc, argv);
+}
+#else
+int main(int argc, char *argv[]){
+
+    bool runBenchmarks = false;
+    const char *snapshotPath = NULL;
+    const char *walPath = NULL;
+    WalDurability durability = WAL_SYNC_EACH;
+    long checkpointBytes = WAL_DEFAULT_CHECKPOINT_BYTES;
+    const char *posPath = NULL;
+    const char *feedPath = NULL;
+    const char *batchPath = NULL;
+    const char *servePath = NULL;
+    const char *loadPath = NULL;
+    int loadConnections = 8;
+    long loadRequests = 200000;
+    long loadIdRange = 0;
+    const char *generatePath = NULL;
+    const char *generatePosPath = NULL;
+    GeneratorOptions generator;
+    defaultGeneratorOptions(&generator);
+    int order = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--bench") == 0) {
+            runBenchmarks = true;
+        } else if (strcmp(argv[i], "--fill-factor") == 0 && i + 1 < argc) {
+            bulkLoadFillFactor = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--snapshot") == 0 && i + 1 < argc) {
+            snapshotPath = argv[++i];
+        } else if (strcmp(argv[i], "--wal") == 0 && i + 1 < argc) {
+            walPath = argv[++i];
+        } else if (strcmp(argv[i], "--durability") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "fsync") == 0) durability = WAL_SYNC_EACH;
+            else if (strcmp(argv[i], "group") == 0) durability = WAL_SYNC_GROUP;
+            else if (strcmp(argv[i], "none") == 0) durability = WAL_SYNC_NONE;
+            else {
+                printf("Unknown durability mode %s (expected fsync, group or none)\n", argv[i]);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--checkpoint-bytes") == 0 && i + 1 < argc) {
+            checkpointBytes = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--pos") == 0 && i + 1 < argc) {
+            posPath = argv[++i];
+        } else if (strcmp(argv[i], "--supplier-feed") == 0 && i + 1 < argc) {
+            feedPath = argv[++i];
+        } else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batchPath = argv[++i];
+        } else if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc) {
+            servePath = argv[++i];
+        } else if (strcmp(argv[i], "--loadgen") == 0 && i + 1 < argc) {
+            loadPath = argv[++i];
+        } else if (strcmp(argv[i], "--connections") == 0 && i + 1 < argc) {
+            loadConnections = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--requests") == 0 && i + 1 < argc) {
+            loadRequests = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--id-range") == 0 && i + 1 < argc) {
+            loadIdRange = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--generate") == 0 && i + 1 < argc) {
+            generatePath = argv[++i];
+        } else if (strcmp(argv[i], "--generate-pos") == 0 && i + 1 < argc) {
+            generatePosPath = argv[++i];
+        } else if (strcmp(argv[i], "--medications") == 0 && i + 1 < argc) {
+            generator.medications = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--suppliers-per") == 0 && i + 1 < argc) {
+            generator.suppliersPerMedication = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--supplier-pool") == 0 && i + 1 < argc) {
+            generator.supplierPool = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--expiry-days") == 0 && i + 1 < argc) {
+            generator.expiryDays = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--expiry-start") == 0 && i + 1 < argc) {
+            int day, month, year;
+            if (sscanf(argv[++i], "%d-%d-%d", &year, &month, &day) != 3 || day < 1 || day > daysInMonth(month, year)) {
+                printf("--expiry-start expects a date as YYYY-MM-DD\n");
+                return -1;
+            }
+            generator.expiryStartDay = daysFromCivil(day, month, year);
+        } else if (strcmp(argv[i], "--vocabulary") == 0 && i + 1 < argc) {
+            generator.vocabulary = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--baskets") == 0 && i + 1 < argc) {
+            generator.baskets = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--basket-size") == 0 && i + 1 < argc) {
+            generator.basketSize = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            generator.seed = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            workerThreadCount = atoi(argv[++i]);
+            if (workerThreadCount < 1) {
+                printf("--threads must be at least 1\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--order") == 0 && i + 1 < argc) {
+            order = atoi(argv[++i]);
+            if (order < 3) {
+                printf("The order must be at least 3\n");
+                return -1;
+            }
+        } else {
+            printf("Usage: %s [--bench] [--fill-factor F] [--snapshot FILE] [--wal FILE] [--durability fsync|group|none] [--checkpoint-bytes N] [--supplier-feed FILE] [--pos FILE] [--order N] [--threads N] [--batch FILE|-] [--serve unix:PATH|tcp:PORT]\n"
+                   "       %s --loadgen unix:PATH|tcp:PORT [--connections N] [--requests N] [--id-range N]\n"
+                   "       %s [--generate FILE] [--generate-pos FILE] [--medications N] [--suppliers-per N] [--supplier-pool N]\n"
+                   "          [--expiry-days N] [--expiry-start YYYY-MM-DD] [--vocabulary N] [--baskets N] [--basket-size N] [--id-range N] [--seed N]\n",
+                   argv[0], argv[0], argv[0]);
+            return -1;
+        }
     }
 
-    UniqueSupplierLeafNode* current = tree->leftmost_leaf;
+    // Checkpoints write the snapshot, so the log needs one to compact into
+    if (walPath && !snapshotPath) {
+        printf("--wal requires --snapshot\n");
+        return -1;
+    }
 
-    printf("\n======================================================\n");
-    printf("           UNIQUE SUPPLIER B+ TREE (Order: %d)        \n", tree->order);
-    printf("======================================================\n");
+    // SIGUSR1 prints the statistics; set up before any other thread starts
+    startStatsSignalThread();
 
-    while (current != NULL) {
-        for (int i = 0; i < current->cursize; i++) {
-            printf("Supplier ID: %lu\n   -> Name: %s\n   ->Turnover: %lu\n   ->Number of Unique Medicines: %d\n",
-                current->keys[i],
-                current->values[i].Supplier_Name,
-                current->values[i].turnoverProduced,
-                current->values[i].noOfUniqueMedicines);
-        }
-        current = current->next;
+    if (runBenchmarks) {
+        benchmarkLookups(500000, 2000000);
+        benchmarkConcurrentLookups(500000, 2000000);
+        benchmarkInsertDelete(1000000, 256);
+        benchmarkDeleteChurn(1000000, 4, 16);
+        benchmarkBulkLoad(5000000, 256);
+        benchmarkParallelScans(2000000, 64);
+        benchmarkNameLookups(200000, 1000000);
+        benchmarkSupplierLookups(200000, 10000, 1000000);
+        benchmarkTopSuppliers(100000, 1000000, 1000000);
+        benchmarkWal(2000, 200000);
+        benchmarkBatchInserts(200000, 100000, 2000);
+        return 0;
     }
 
-    printf("======================================================\n");
-}   
+    if (loadPath) {
+        return runLoadGenerator(loadPath, loadConnections, loadRequests, loadIdRange ? loadIdRange : 200000) ? 0 : -1;
+    }
+
+    if (generatePath || generatePosPath) {
+        if (generatePath && !generateMedicationFile(generatePath, &generator)) return -1;
+        if (generatePosPath && !generatePosFile(generatePosPath, &generator, loadIdRange ? loadIdRange : generator.medications)) return -1;
+        return 0;
+    }
 
-int main(){
+    // Batch responses keep stdout to themselves; everything else printed goes to stderr
+    FILE *batchOutput = NULL;
+    if (batchPath) {
+        batchOutput = fdopen(dup(STDOUT_FILENO), "w");
+        if (!batchOutput) return -1;
+        fflush(stdout);
+        dup2(STDERR_FILENO, STDOUT_FILENO);
+        if (order == 0) order = BATCH_DEFAULT_ORDER;
+    }
+    if (servePath && order == 0) order = BATCH_DEFAULT_ORDER;
 
-    int order;
-    printf("\nEnter the order of the B+ tree: ");
-    scanf("%d", &order);
+    if (order == 0) {
+        printf("\nEnter the order of the B+ tree: ");
+        scanf("%d", &order);
+    }
+    // Deletes rebalance down to (order - 1) / 2 keys per node, which needs at least one
+    while (order < 3) {
+        printf("The order must be at least 3: ");
+        if (scanf("%d", &order) != 1) return -1;
+    }
 
     MedicationBPlusTree* pharmacy = createMedicationBPlusTree(order);
     expirationTree = createExpirationBPlusTree(order);
@@ -3322,23 +10355,70 @@ int main(){
         return -1;
     }
 
-    ReadFileAndStoreData("medication.txt", pharmacy);
+    // A valid snapshot replaces the text load; otherwise one is written for next time
+    bool snapshotMapped = false;
+    unsigned long snapshotLsn = 0;
+    if (snapshotPath && (activeSnapshot = openSnapshot(snapshotPath)) != NULL) {
+        printf("Mapped snapshot %s (%lu medications).\n", snapshotPath, activeSnapshot->header->medicationCount);
+        snapshotMapped = true;
+        snapshotLsn = activeSnapshot->header->lastLsn;
+    } else {
+        ReadFileAndStoreData("medication.txt", pharmacy);
+    }
+
+    // Changes logged since the snapshot are replayed before anything else runs
+    if (walPath) {
+        Wal *wal = walOpen(walPath, durability, pharmacy, snapshotPath, snapshotLsn);
+        if (!wal) return -1;
+        wal->checkpointBytes = checkpointBytes;
+        activeWal = wal;
+    }
+    if (snapshotPath && !snapshotMapped) {
+        saveSnapshot(snapshotPath, pharmacy, activeWal ? activeWal->nextLsn - 1 : 0);
+    }
+    if (feedPath) {
+        materializeSnapshot(pharmacy);
+        importSupplierFeed(pharmacy, feedPath);
+    }
+    if (posPath) {
+        materializeSnapshot(pharmacy);
+        replayPosFile(pharmacy, posPath);
+    }
 
-    printf(" \nWelcome to the India's Top Medical Store. \n\n");
     int flag = 1;
+    if (batchPath) {
+        // Commands come from the batch stream instead of the menu
+        runBatch(pharmacy, batchPath, batchOutput, snapshotPath);
+        fclose(batchOutput);
+        flag = 0;
+    } else if (servePath) {
+        // Requests come from the socket until the server is signalled to stop
+        runServer(pharmacy, servePath, snapshotPath);
+        flag = 0;
+    } else {
+        printf(" \nWelcome to the India's Top Medical Store. \n\n");
+        printf("-------------------------------------------------------\n");
+    }
 
-    printf("-------------------------------------------------------\n");
     while(flag){
         printf("\n1. Add New Medication\n2. Update Medication Details\n3. Delete Medication\n4. Search Medication");
         printf("\n5. Stock Alerts\n6. Check Expiration Dates\n7. Sort Medication By Expiration Dates");
-        printf("\n8. Sales Tracking\n9. Supplier Management\n10. Find All-rounder Suppliers\n11. Find Suppliers with Largest Turn-over\n12. Print the Whole Data\n13.Print Unique Suppliers\n14. Print Tree Structure\n0. Exit\n");
+        printf("\n8. Sales Tracking\n9. Supplier Management\n10. Find All-rounder Suppliers\n11. Find Suppliers with Largest Turn-over\n12. Print the Whole Data\n13.Print Unique Suppliers\n14. Print Tree Structure\n16. Tree Shape Report\n17. Instrumentation Stats\n0. Exit\n");
+
+        // Group commit: nothing logged stays unsynced while we wait for input
+        walFlush(activeWal);
 
         int ch;
         printf("\nEnter the Operation You want to monitor : ");
         scanf("%d",&ch);
 
         while (getchar() != '\n'); // Clear the input buffer
-        
+
+        // Only ID searches can be answered from a mapped snapshot
+        if (ch != 0 && ch != 4 && ch != 17) {
+            materializeSnapshot(pharmacy);
+        }
+
 
         switch(ch){
             case 0: 
@@ -3348,7 +10428,7 @@ int main(){
                 break;
             case 1:
                 {
-                    MedicationData data = createMedicationData(order , pharmacy);
+                    MedicationData data = createMedicationData(pharmacy);
                     insertMedication(pharmacy, data);
                     printf("Medication added successfully.\n");
                     break;
@@ -3358,16 +10438,9 @@ int main(){
                 printf("Enter the Medication ID to update: ");
                 scanf("%lu", &id);
             
-                MedicationNode* leaf2 = findLeafNode(pharmacy, id);
-                MedicationLeafNode* leaf = &(leaf2->leaf);
-
-                if (leaf) {
-                    for (int i = 0; i < leaf->cursize; i++) {
-                        if (leaf->keys[i] == id) {
-                            updateDetails(&(leaf->values[i]));
-                            break;
-                        }
-                    }
+                MedicationData* medication = findMedication(pharmacy, id);
+                if (medication) {
+                    updateDetails(pharmacy, medication);
                 } else {
                     printf("Medication ID %lu not found.\n", id);
                 }
@@ -3393,8 +10466,10 @@ int main(){
                     scanf("%lu", &id);
                     searchMedicationByID(pharmacy, id);
                 } else if (searchChoice == 2) {
+                    materializeSnapshot(pharmacy);
                     searchPharmacyUsingName(pharmacy);
                 } else if(searchChoice == 3){
+                    materializeSnapshot(pharmacy);
                     unsigned long id;
                     printf("Enter the Supplier ID to search: \n");
                     scanf("%lu", &id);
@@ -3434,19 +10509,15 @@ int main(){
                     month = tempmonth; // Update month
                 }
 
-                if ((year % 4 == 0 && year % 100 != 0) || (year % 400 == 0)) {
-                    days_in_month[1] = 29; // February has 29 days in a leap year
-                }
-
                 // Ensure the day is valid for the given month and year
                 day = tempday;
-                while (day < 1 || day > days_in_month[month - 1]) {
+                while (day < 1 || day > daysInMonth(month, year)) {
                     printf("Enter a valid Day: ");
                     scanf("%d", &tempday);
                     day = tempday; // Update day
                 }
 
-                checkExpirationDates(day, month, year, pharmacy);
+                checkExpirationDates(day, month, year, EXPIRY_ALERT_DAYS, pharmacy);
                 printf("----------------------------------------------------------------------------------------------------------------------------\n");
                 break;
             }
@@ -3465,43 +10536,21 @@ int main(){
                 printf("Enter the Medication ID to update: ");
                 scanf("%lu", &id);
 
-                MedicationNode* leaf2 = findLeafNode(pharmacy, id);
-                MedicationLeafNode* leaf = &(leaf2->leaf);
-                if (leaf) {
-                    for (int i = 0; i < leaf->cursize; i++) {
-                        if (leaf->keys[i] == id) {
-                            supplierManagement(&(leaf->values[i]));
-                            break;
-                        }
-                    }
+                MedicationData* medication = findMedication(pharmacy, id);
+                if (medication) {
+                    supplierManagement(pharmacy, medication);
                 } else {
                     printf("Medication ID %lu not found.\n", id);
                 }
                 break;
             case 10:
                 printf("\nFinding All-rounder Suppliers...\n");
-                {
-                    int size;
-                    HeapNode* heap = populateHeapFromTree(uniqueSupplierTree, &size);
-                    if (heap) {
-                        buildMaxHeap(heap, size, false); // Sort by noOfUniqueMedicines
-                        extractTop10(heap, size, false);
-                        free(heap); // Free the heap after use
-                    }
-                }
+                printTopSuppliers(uniqueSupplierTree, false, 10);
             break;
         
             case 11:
                 printf("\nFinding Suppliers with Largest Turn-over...\n");
-                {
-                    int size;
-                    HeapNode* heap = populateHeapFromTree(uniqueSupplierTree, &size);
-                    if (heap) {
-                        buildMaxHeap(heap, size, true); 
-                        extractTop10(heap, size, true);
-                        free(heap); // Free the heap after use
-                    }
-                }
+                printTopSuppliers(uniqueSupplierTree, true, 10);
                 break;         
             case 12:
                 printf("\nPrinting the entire pharmacy database...\n");
@@ -3519,6 +10568,17 @@ int main(){
             case 15:
                 SaveDataToFile("updated_medication.txt", pharmacy);
                 printf("Data saved successfully to updated_medication.txt.\n");
+                if (activeWal) {
+                    if (walCheckpoint(activeWal)) printf("Checkpoint to %s started.\n", snapshotPath);
+                } else if (snapshotPath && saveSnapshot(snapshotPath, pharmacy, 0)) {
+                    printf("Snapshot saved to %s.\n", snapshotPath);
+                }
+                break;
+            case 16:
+                printTreeShapeReport(pharmacy);
+                break;
+            case 17:
+                printStats(stdout);
                 break;
             default:
                 printf("Invalid choice. Please try again.\n");
@@ -3528,5 +10588,12 @@ int main(){
         }
     }
 
+    walClose(activeWal);
+    closeSnapshot(activeSnapshot);
+    stopWorkerPool(workerPool);
+    destroyMedicationBPlusTree(pharmacy);
+    destroyExpirationBPlusTree(expirationTree);
+    destroyUniqueSupplierBPlusTree(uniqueSupplierTree);
     return 0;
 }
+#endif
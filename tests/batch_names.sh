@@ -0,0 +1,74 @@
+#!/bin/sh
+# Batch commands on medication names that contain spaces.
+# Run from the repository root: sh tests/batch_names.sh
+set -e
+
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+${CC:-cc} -O2 -pthread -o "$dir/pharmacy" Pharmacy.c
+
+cat > "$dir/medication.txt" <<'EOF'
+1
+Oxacol 20mg
+92
+266
+B1
+12 5 2028
+1
+3 Carewell 92 555-0100
+20
+
+2
+Oxacol 200mg
+40
+310
+B2
+1 2 2029
+0
+10
+EOF
+
+cat > "$dir/commands.txt" <<'EOF'
+search name Oxacol 20mg
+search iname oxacol 20MG
+search prefix Oxacol 2
+search name "Oxacol 20mg"
+add 3 "Dinamab 5 mg" 7 12 2 B3 01 01 2030
+search name Dinamab 5 mg
+update 3 name Dinamab   10 mg
+search name Dinamab 10 mg
+search name Dinamab 5 mg
+add 4 "Say \"hi\" # 1" 1 1 1 B4 01 01 2030
+search name "Say \"hi\" # 1"
+add 5 "Unclosed 1 1 1 B5 01 01 2030
+EOF
+
+cat > "$dir/expected.txt" <<'EOF'
+med	1	Oxacol 20mg	92	266	20	B1	2028-05-12	0
+ok	1	1
+med	1	Oxacol 20mg	92	266	20	B1	2028-05-12	0
+ok	2	1
+med	2	Oxacol 200mg	40	310	10	B2	2029-02-01	0
+med	1	Oxacol 20mg	92	266	20	B1	2028-05-12	0
+ok	3	2
+med	1	Oxacol 20mg	92	266	20	B1	2028-05-12	0
+ok	4	1
+med	3	Dinamab 5 mg	7	12	2	B3	2030-01-01	0
+ok	5	1
+med	3	Dinamab 5 mg	7	12	2	B3	2030-01-01	0
+ok	6	1
+med	3	Dinamab 10 mg	7	12	2	B3	2030-01-01	0
+ok	7	1
+med	3	Dinamab 10 mg	7	12	2	B3	2030-01-01	0
+ok	8	1
+ok	9	0
+med	4	Say "hi" # 1	1	1	1	B4	2030-01-01	0
+ok	10	1
+med	4	Say "hi" # 1	1	1	1	B4	2030-01-01	0
+ok	11	1
+err	12	unterminated quote
+EOF
+
+(cd "$dir" && ./pharmacy --batch commands.txt 2>/dev/null) > "$dir/actual.txt"
+diff "$dir/expected.txt" "$dir/actual.txt"
+echo "batch_names: ok"